@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
+
+#include "rclcpp/time.hpp"
+
+namespace Ogre
+{
+class Entity;
+}  // namespace Ogre
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class AgeFadeMaterial
+ * \brief Material of vertex colored objects fading out with the age of their vertices.
+ *
+ * The stamp of each vertex, returned by toShaderTime(), is written as its first texture
+ * coordinate. The alpha is computed by the GPU from the current time, so that fading costs a
+ * single parameter update per frame, whatever the number of vertices.
+ *
+ * The SOLID_COLOR variant instead fades entities of a mesh drawn with the color set by setColor(),
+ * each with the stamp set by setStamp().
+ */
+class AgeFadeMaterial
+{
+public:
+    enum Kind
+    {
+        VERTEX_COLORS,
+        SOLID_COLOR
+    };
+
+    explicit AgeFadeMaterial(Kind kind = VERTEX_COLORS);
+
+    ~AgeFadeMaterial();
+
+    AgeFadeMaterial(const AgeFadeMaterial &) = delete;
+    AgeFadeMaterial & operator=(const AgeFadeMaterial &) = delete;
+
+    const std::string & getName() const {return material_->getName();}
+
+    const Ogre::MaterialPtr & getMaterial() const {return material_;}
+
+    /** @brief Set the color of the SOLID_COLOR variant. */
+    void setColor(const Ogre::ColourValue & color);
+
+    /** @brief Set the stamp, in the time base of the shader, of an entity of the SOLID_COLOR variant. */
+    static void setStamp(Ogre::Entity & entity, float stamp);
+
+    /** @brief Set the age, in s, at which the vertices become fully transparent. */
+    void setFadeDuration(float seconds);
+
+    /** @brief Set the current time. To be called once per frame. */
+    void setNow(const rclcpp::Time & now);
+
+    /**
+     * @brief Convert a time into the time base of the shader.
+     *
+     * Times are offset by the first converted time, to remain accurate in single precision.
+     */
+    float toShaderTime(const rclcpp::Time & time);
+
+private:
+    Ogre::MaterialPtr material_;
+
+    bool has_epoch_ = false;
+    int64_t epoch_nanoseconds_ = 0;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class CdrReader
+ * \brief Streaming reader of a message serialized in CDR, as published by the ROS 2 middlewares.
+ *
+ * The values are read in the order of the fields of the message, aligned to their size from the
+ * end of the encapsulation header (the 8-byte values to 4 bytes in XCDR2), without building the
+ * message: strings are returned as views of the buffer. A read past the end, or a sequence longer
+ * than the bytes left, makes the reader fail, and every later read fail too. So does an
+ * encapsulation other than plain CDR or XCDR2, such as the parameter lists or the delimited XCDR2.
+ */
+class CdrReader
+{
+public:
+    /** @brief Read the encapsulation header of the serialized message of size bytes. */
+    CdrReader(const uint8_t * data, size_t size);
+
+    bool ok() const {return ok_;}
+
+    bool read(int32_t & value);
+    bool read(uint32_t & value);
+    bool read(double & value);
+
+    /** @brief Read a string, as a view of the buffer without its terminating null character. */
+    bool read(std::string_view & value);
+
+    bool skipString();
+
+    /**
+     * @brief Read the length of a sequence whose elements take at least min_element_size bytes.
+     * @return false if the bytes left cannot hold the sequence.
+     */
+    bool readSequenceLength(uint32_t & length, size_t min_element_size);
+
+private:
+    template<typename T>
+    bool readValue(T & value);
+
+    bool align(size_t size);
+
+    const uint8_t * data_;
+    size_t size_;
+    // Offset of the next value, from the start of the buffer.
+    size_t offset_ = 0;
+    bool swap_ = false;
+    size_t max_alignment_ = 8;
+    bool ok_ = true;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <limits>
+
+#include <OgreColourValue.h>
+
+namespace rviz_legged_plugins::common
+{
+
+enum class Colormap : int
+{
+    VIRIDIS,
+    JET
+};
+
+/** @brief Color of a colormap at t, clamped to [0, 1]. The alpha of the color is 1. */
+Ogre::ColourValue sampleColormap(Colormap colormap, float t);
+
+/**
+ * \struct ScalarRange
+ * \brief Range of the scalars mapped to a colormap, either fixed or grown over a batch of values.
+ */
+struct ScalarRange
+{
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+
+    void include(float value);
+
+    /** @brief Position of value in the range, in [0, 1]. Empty or flat ranges map to 0. */
+    float normalize(float value) const;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+namespace Ogre
+{
+class SceneManager;
+}  // namespace Ogre
+
+namespace rviz_legged_plugins::common
+{
+/** Sides of the coarse cone mesh. */
+constexpr unsigned int kCoarseConeSides = 8;
+
+/**
+ * @brief Name of a cone mesh of kCoarseConeSides sides, created on the first call.
+ *
+ * The cone has the extent of the cone shape of rviz_rendering, as placed by computeConeGeometry():
+ * a height of 1 along y, the apex at y = 0.5 and a base of diameter 1 at y = -0.5.
+ */
+const std::string & coarseConeMesh(Ogre::SceneManager * scene_manager);
+
+}  // namespace rviz_legged_plugins::common
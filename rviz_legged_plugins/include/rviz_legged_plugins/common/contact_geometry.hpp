@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <OgreMatrix4.h>
+#include <OgreQuaternion.h>
+#include <OgreVector3.h>
+
+#include "geometry_msgs/msg/wrench.hpp"
+#include "nav_msgs/msg/path.hpp"
+
+/*
+ * Geometry computations shared by the displays and by the tools that replay the display pipeline
+ * without a render window. None of these functions touches the scene graph.
+ */
+
+namespace rviz_legged_plugins::common
+{
+
+/**
+ * \struct WrenchSample
+ * \brief Force and torque of a contact wrench, ready to be displayed.
+ */
+struct WrenchSample
+{
+    Ogre::Vector3 force = Ogre::Vector3::ZERO;
+    Ogre::Vector3 torque = Ogre::Vector3::ZERO;
+};
+
+/**
+ * @brief Convert a wrench message into a sample.
+ *
+ * When accept_nan is true, NaN components are replaced by zeros.
+ * @return false if the resulting sample contains invalid floating point values.
+ */
+bool wrenchToSample(const geometry_msgs::msg::Wrench & wrench, bool accept_nan, WrenchSample & sample);
+
+/**
+ * @brief Convert the i-th wrench of flat force and torque arrays into a sample.
+ *
+ * torques may be empty, in which case the torque is zero.
+ * @return false if the resulting sample contains invalid floating point values.
+ */
+bool packedWrenchToSample(
+    const std::vector<float> & forces, const std::vector<float> & torques, size_t i,
+    bool accept_nan, WrenchSample & sample);
+
+/**
+ * @brief Convert a wrench stored as force (x, y, z) followed by torque (x, y, z) into a sample.
+ * @return false if the resulting sample contains invalid floating point values.
+ */
+bool wrenchToSample(const Eigen::Matrix<double, 6, 1> & wrench, bool accept_nan, WrenchSample & sample);
+
+/**
+ * \struct ConeGeometry
+ * \brief Placement of the cone shape representing a friction cone.
+ */
+struct ConeGeometry
+{
+    /** Offset of the shape center from the contact point, in the fixed frame. */
+    Ogre::Vector3 offset = Ogre::Vector3::ZERO;
+    Ogre::Quaternion orientation = Ogre::Quaternion::IDENTITY;
+    Ogre::Vector3 scale = Ogre::Vector3::ZERO;
+};
+
+/** @brief Compute the placement of a friction cone of the given height. */
+ConeGeometry computeConeGeometry(
+    const Ogre::Vector3 & normal_direction, double friction_coefficient, float height);
+
+/**
+ * \struct TerrainPlane
+ * \brief Plane approximating the terrain, described by a point and its unit normal.
+ */
+struct TerrainPlane
+{
+    Ogre::Vector3 point = Ogre::Vector3::ZERO;
+    Ogre::Vector3 normal = Ogre::Vector3::UNIT_Z;
+
+    /** @brief Build the plane z = a x + b y + c, as published by the state estimator. */
+    static TerrainPlane fromCoefficients(double a, double b, double c);
+
+    /** @brief Return the plane expressed in another frame. */
+    TerrainPlane transformed(const Ogre::Vector3 & position, const Ogre::Quaternion & orientation) const;
+
+    /** @brief Orthogonal projection of a point on the plane. */
+    Ogre::Vector3 project(const Ogre::Vector3 & point) const;
+};
+
+/**
+ * @brief Compute the zero moment point of a set of contact wrenches on a plane.
+ *
+ * The forces are the ground reaction forces acting on the robot, applied at the contact positions
+ * and expressed in the same frame. The ZMP lies on the plane through reference with the given
+ * normal, reference being usually the projection of the CoM on the terrain.
+ * @return false if the resultant force has no component along the normal (no contact).
+ */
+bool computeZmp(
+    const std::vector<Ogre::Vector3> & positions, const std::vector<WrenchSample> & wrenches,
+    const Ogre::Vector3 & reference, const Ogre::Vector3 & normal, Ogre::Vector3 & zmp);
+
+/** @brief Transform the positions of a path into the fixed frame. */
+void transformPathPositions(
+    const nav_msgs::msg::Path & path, const Ogre::Matrix4 & transform,
+    std::vector<Ogre::Vector3> & positions);
+
+/** @brief Transform the positions of a path stored as the first three rows of a 7 x n matrix. */
+void transformPathPositions(
+    const Eigen::Matrix<double, 7, Eigen::Dynamic> & path, const Ogre::Matrix4 & transform,
+    std::vector<Ogre::Vector3> & positions);
+
+/** @brief Rotate the orientations of a path into the fixed frame. */
+void transformPathOrientations(
+    const nav_msgs::msg::Path & path, const Ogre::Quaternion & rotation,
+    std::vector<Ogre::Quaternion> & orientations);
+
+/** @brief Rotate the orientations of a path stored as the last four rows (x, y, z, w) of a 7 x n matrix. */
+void transformPathOrientations(
+    const Eigen::Matrix<double, 7, Eigen::Dynamic> & path, const Ogre::Quaternion & rotation,
+    std::vector<Ogre::Quaternion> & orientations);
+
+}  // namespace rviz_legged_plugins::common
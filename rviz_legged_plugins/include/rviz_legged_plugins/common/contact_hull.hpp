@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <OgreVector3.h>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class ContactHull
+ * \brief Convex hull of the active contacts, projected on the xy plane of the fixed frame.
+ *
+ * The hull is maintained incrementally: a touchdown, or a contact moving outside the hull, inserts
+ * the contact by replacing the chain of edges visible from it, while contacts inside the hull cost
+ * nothing. Only the lift off or the motion of a hull vertex triggers a full recomputation, which
+ * is done at most once per update.
+ */
+class ContactHull
+{
+public:
+    /**
+     * @brief Set the active contacts, identified by their id (e.g. the frame of the foot).
+     * @return true if the vertices of the hull changed.
+     */
+    bool setContacts(const std::vector<std::string> & ids, const std::vector<Ogre::Vector3> & positions);
+
+    /** @brief Remove all the contacts. */
+    void clear();
+
+    /** @brief Displacement below which a contact is considered still. */
+    void setTolerance(float tolerance) {tolerance_ = tolerance;}
+
+    /** @brief Vertices of the hull, counterclockwise, with their original height. */
+    const std::vector<Ogre::Vector3> & vertices() const {return vertices_;}
+
+private:
+    struct Contact
+    {
+        std::string id;
+        Ogre::Vector3 position;
+        bool on_hull = false;
+        bool active = false;
+    };
+
+    // Insert a contact in a hull of at least three vertices. Return true if the hull changed.
+    bool insert(size_t index);
+    void rebuild();
+    void updateVertices();
+
+    std::vector<Contact> contacts_;
+
+    // Indices in contacts_ of the vertices of the hull, counterclockwise.
+    std::vector<size_t> hull_;
+    std::vector<Ogre::Vector3> vertices_;
+
+    // Scratch buffers reused across updates.
+    std::vector<size_t> pending_;
+    std::vector<size_t> order_;
+    std::vector<size_t> next_hull_;
+
+    float tolerance_ = 1e-3f;
+};
+
+}  // namespace rviz_legged_plugins::common
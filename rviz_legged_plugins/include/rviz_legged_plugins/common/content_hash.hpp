@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "builtin_interfaces/msg/time.hpp"
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class ContentHash
+ * \brief 64-bit FNV-1a hash of the payload of a message, used to detect unchanged messages.
+ *
+ * Values are hashed by their bytes; the sizes of strings and arrays are hashed too, so that
+ * different splits of the same bytes do not collide.
+ */
+class ContentHash
+{
+public:
+    void add(const void * data, size_t size);
+
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void add(T value)
+    {
+        add(&value, sizeof(value));
+    }
+
+    void add(const std::string & value)
+    {
+        add(value.size());
+        add(value.data(), value.size());
+    }
+
+    void add(const builtin_interfaces::msg::Time & stamp)
+    {
+        add(stamp.sec);
+        add(stamp.nanosec);
+    }
+
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void add(const std::vector<T> & values)
+    {
+        add(values.size());
+        add(values.data(), values.size() * sizeof(T));
+    }
+
+    void add(const std::vector<std::string> & values)
+    {
+        add(values.size());
+        for (const auto & value : values) {
+            add(value);
+        }
+    }
+
+    uint64_t value() const {return value_;}
+
+private:
+    uint64_t value_ = 14695981039346656037ULL;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class FrameBudget
+ * \brief Process-wide governor trading the quality of the legged displays for their frame time.
+ *
+ * The displays with a frame budget register it, and the FrameMonitor reports the render time of
+ * every frame. While the smoothed render time stays above the smallest budget, the governor raises
+ * the level one step at a time; once the render time is well below the budget again, it lowers the
+ * level one step at a time. Each level keeps the reductions of the previous ones. The displays check
+ * revision() once per frame and apply the reductions of the new level. The governor must be used
+ * from the render thread.
+ */
+class FrameBudget
+{
+public:
+    /** Reductions of the quality, in the order they are applied. */
+    enum Level
+    {
+        FULL_QUALITY,
+        REDUCED_HISTORY,
+        REDUCED_POSE_MARKERS,
+        REDUCED_CONE_DETAIL,
+        REDUCED_UPDATE_RATE,
+    };
+
+    static constexpr int kMaxLevel = REDUCED_UPDATE_RATE;
+
+    /** Minimum time, in s, between two messages processed by a display at REDUCED_UPDATE_RATE. */
+    static constexpr float kReducedUpdatePeriod = 0.1f;
+
+    static FrameBudget & instance();
+
+    FrameBudget(const FrameBudget &) = delete;
+    FrameBudget & operator=(const FrameBudget &) = delete;
+
+    /** @brief Set the frame budget, in s, of a display; 0 removes it. */
+    void setBudget(const void * client, float budget);
+
+    /** @brief Report the render time of a frame, and the time since the previous one, in s. */
+    void addFrame(float render_time, float interval);
+
+    Level level() const {return level_;}
+
+    /** @brief Incremented by every change of the level. */
+    uint64_t revision() const {return revision_;}
+
+    /** @brief Smoothed render time, in s. */
+    float frameTime() const {return frame_time_;}
+
+    /** @brief Smallest budget of the displays, in s, 0 without any. */
+    float budget() const {return budget_;}
+
+    static const char * levelName(Level level);
+
+private:
+    FrameBudget() = default;
+
+    void setLevel(Level level);
+
+    std::unordered_map<const void *, float> budgets_;
+    float budget_ = 0.0f;
+
+    float frame_time_ = 0.0f;
+    // Wall time spent above the budget, or below the restore threshold, since the last change.
+    float time_over_budget_ = 0.0f;
+    float time_under_budget_ = 0.0f;
+
+    Level level_ = FULL_QUALITY;
+    uint64_t revision_ = 0;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include <OgreFrameListener.h>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class FrameMonitor
+ * \brief Frame listener of the Ogre root shared by the legged displays.
+ *
+ * It marks every frame rendered by Ogre in the trace once, whatever the number of displays, and
+ * reports its render time to the FrameBudget governor: the time from the start of the frame to its
+ * rendering being queued, i.e. the culling and the draw calls of the scene, without the wait for the
+ * buffer swap nor the update period of RViz. The displays hold it from their initialization: it is
+ * added to the root with the first holder and removed with the last one, before the root is
+ * destroyed.
+ */
+class FrameMonitor : public Ogre::FrameListener
+{
+public:
+    /** @brief The monitor, added to the root if no display holds it yet. */
+    static std::shared_ptr<FrameMonitor> acquire();
+
+    ~FrameMonitor() override;
+
+    FrameMonitor(const FrameMonitor &) = delete;
+    FrameMonitor & operator=(const FrameMonitor &) = delete;
+
+    bool frameStarted(const Ogre::FrameEvent & event) override;
+
+    bool frameRenderingQueued(const Ogre::FrameEvent & event) override;
+
+private:
+    FrameMonitor();
+
+    std::chrono::steady_clock::time_point frame_start_;
+    bool frame_started_ = false;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class MaterialCache
+ * \brief Process-wide cache of the materials of the legged displays, keyed by their render state.
+ *
+ * Displays with the same style share the same material, hence the same GPU state: a material is
+ * created on the first request for its state and destroyed when the last handle to it is
+ * released. The meshes of the shapes (cones, arrows) are already shared by the Ogre MeshManager;
+ * only their materials, cloned for every shape by default, need to be cached.
+ * The cache must be used from the render thread.
+ */
+class MaterialCache
+{
+public:
+    /** Shared ownership of a cached material. */
+    using Handle = std::shared_ptr<const Ogre::MaterialPtr>;
+
+    static MaterialCache & instance();
+
+    MaterialCache(const MaterialCache &) = delete;
+    MaterialCache & operator=(const MaterialCache &) = delete;
+
+    /**
+     * @brief Unlit material whose color comes from the vertices, for ManualObjects and lines.
+     * @param transparent enables alpha blending and disables depth writes.
+     * @param two_sided disables back-face culling.
+     */
+    Handle vertexColorMaterial(bool transparent, bool two_sided = false);
+
+    /** @brief Material of uniform color, lit as the rviz_rendering shapes are. */
+    Handle solidColorMaterial(const Ogre::ColourValue & color);
+
+    /**
+     * @brief Change the color of a solid color material in constant time.
+     *
+     * When the caller holds the only handle to the material, the material is modified in place and
+     * the objects bound to it are restyled at once. Otherwise, handle is replaced by the shared
+     * material of the new color and the caller must bind its objects to it.
+     * @return true if the material was modified in place.
+     */
+    bool restyleSolidColor(Handle & handle, const Ogre::ColourValue & color);
+
+    /** @brief Whether an alpha requires blending, with the threshold of rviz_rendering. */
+    static bool isTransparent(float alpha) {return alpha < 0.9998f;}
+
+    /** @brief Number of materials currently alive. */
+    size_t size() const {return materials_.size();}
+
+private:
+    MaterialCache() = default;
+
+    template<typename Setup>
+    Handle acquire(const std::string & key, Setup setup);
+
+    void release(const std::string & key);
+
+    std::unordered_map<std::string, std::weak_ptr<const Ogre::MaterialPtr>> materials_;
+};
+
+}  // namespace rviz_legged_plugins::common
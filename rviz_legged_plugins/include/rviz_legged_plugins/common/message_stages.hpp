@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rviz_legged_msgs/msg/friction_cones.hpp"
+#include "rviz_legged_msgs/msg/friction_cones_packed.hpp"
+#include "rviz_legged_msgs/msg/paths.hpp"
+#include "rviz_legged_msgs/msg/wrenches_packed.hpp"
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+
+/*
+ * Validation and conversion of the messages of the displays, before their frames are looked up.
+ * Shared by the displays and by legged_bag_replay, which times them without a render window.
+ */
+
+namespace rviz_legged_plugins::common
+{
+
+/** Reason a message is rejected. */
+enum class MessageError
+{
+    NONE,
+    // The arrays of a packed message do not match its number of contacts.
+    LAYOUT,
+    // A frame index of a packed message is out of its frame_ids table.
+    FRAME_INDEX,
+    // The message contains NaN or infinite values.
+    INVALID_FLOATS
+};
+
+/** @brief Status text of a rejected message. */
+const char * describe(MessageError error);
+
+/**
+ * @brief Convert the wrenches of a message into samples, in the frames of their headers.
+ *
+ * When accept_nan is true, NaN components are replaced by zeros.
+ */
+MessageError readWrenches(
+    const rviz_legged_msgs::msg::WrenchesStamped & msg, bool accept_nan,
+    std::vector<WrenchSample> & samples);
+
+/** @brief Check the layout of a packed message and convert its wrenches into samples. */
+MessageError readPackedWrenches(
+    const rviz_legged_msgs::msg::WrenchesPacked & msg, bool accept_nan,
+    std::vector<WrenchSample> & samples);
+
+/** @brief Check the normals and friction coefficients of the cones of a message. */
+MessageError validateCones(const rviz_legged_msgs::msg::FrictionCones & msg);
+MessageError validatePackedCones(const rviz_legged_msgs::msg::FrictionConesPacked & msg);
+
+/** @brief Read the normals and friction coefficients of the cones of a validated message. */
+void readCones(
+    const rviz_legged_msgs::msg::FrictionCones & msg, std::vector<Ogre::Vector3> & normals,
+    std::vector<float> & friction_coefficients);
+void readPackedCones(
+    const rviz_legged_msgs::msg::FrictionConesPacked & msg, std::vector<Ogre::Vector3> & normals,
+    std::vector<float> & friction_coefficients);
+
+/** @brief Check the poses of the paths of a message. */
+MessageError validatePaths(const rviz_legged_msgs::msg::Paths & msg);
+
+}  // namespace rviz_legged_plugins::common
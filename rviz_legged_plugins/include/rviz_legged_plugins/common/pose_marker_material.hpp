@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
+#include <OgreQuaternion.h>
+#include <OgreVector3.h>
+
+namespace Ogre
+{
+class ManualObject;
+}
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class PoseMarkerMaterial
+ * \brief Material of pose arrows and axes drawn as meshes, sized and colored by its parameters.
+ *
+ * The vertices written by addArrow() and addAxes() hold the pose and the directions and weights
+ * of their offset from it. The vertex shader applies the sizes of the markers, hence resizing or
+ * recoloring any number of markers is a parameter update.
+ */
+class PoseMarkerMaterial
+{
+public:
+    /** Vertices of the triangle list of an arrow: a capped shaft and a cone. */
+    static const size_t kArrowVertexCount;
+    /** Vertices of the triangle list of the axes: three capped cylinders. */
+    static const size_t kAxesVertexCount;
+
+    PoseMarkerMaterial();
+
+    ~PoseMarkerMaterial();
+
+    PoseMarkerMaterial(const PoseMarkerMaterial &) = delete;
+    PoseMarkerMaterial & operator=(const PoseMarkerMaterial &) = delete;
+
+    const std::string & getName() const {return material_->getName();}
+
+    void setArrowGeometry(float shaft_length, float shaft_diameter, float head_length, float head_diameter);
+
+    void setAxesGeometry(float length, float radius);
+
+    void setArrowColor(const Ogre::ColourValue & color);
+
+    /** @brief Largest distance of a vertex of an arrow or of the axes from its pose. */
+    float extent() const;
+
+    /** @brief Append an arrow along the x axis of a pose to the current section of a triangle list. */
+    static void addArrow(
+        Ogre::ManualObject & manual_object, const Ogre::Vector3 & position,
+        const Ogre::Quaternion & orientation);
+
+    /** @brief Append the red, green and blue axes of a pose to the current section of a triangle list. */
+    static void addAxes(
+        Ogre::ManualObject & manual_object, const Ogre::Vector3 & position,
+        const Ogre::Quaternion & orientation);
+
+private:
+    void setSizes();
+
+    Ogre::MaterialPtr material_;
+    // Lengths and radii of the shaft and head of the arrows, and of the axes.
+    Ogre::Vector3 lengths_{1.0f, 0.3f, 1.0f};
+    Ogre::Vector3 radii_{0.05f, 0.1f, 0.1f};
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include <OgreMaterial.h>
+
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class TerrainShadowMaterial
+ * \brief Material of vertex colored lines, drawn again as their shadow on the terrain plane.
+ *
+ * The second pass projects every vertex on the plane in the vertex shader, hence the shadow of a
+ * line costs no work on the CPU and no other buffer: moving the terrain is a parameter update.
+ * Like the vertex color materials of the MaterialCache, it comes in an opaque and a transparent
+ * variant, selected by the alpha of the lines.
+ */
+class TerrainShadowMaterial
+{
+public:
+    TerrainShadowMaterial();
+
+    ~TerrainShadowMaterial();
+
+    TerrainShadowMaterial(const TerrainShadowMaterial &) = delete;
+    TerrainShadowMaterial & operator=(const TerrainShadowMaterial &) = delete;
+
+    const std::string & getName(bool transparent) const
+    {
+        return (transparent ? transparent_material_ : opaque_material_)->getName();
+    }
+
+    /** @brief Set the plane the lines are projected on, in world coordinates. */
+    void setPlane(const TerrainPlane & plane);
+
+    /** @brief Set the factor of the alpha of the lines giving the alpha of their shadow. */
+    void setShadowAlpha(float alpha);
+
+private:
+    Ogre::MaterialPtr opaque_material_;
+    Ogre::MaterialPtr transparent_material_;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rviz_legged_plugins::common
+{
+class TimelineStore;
+
+/**
+ * \class Timeline
+ * \brief Process-wide scrubbing state of the legged displays.
+ *
+ * The displays register their TimelineStore and, once per frame, check revision(): when it changed,
+ * they draw their records at the scrubbed instant, or their newest records when back to live. The
+ * timeline must be used from the render thread.
+ */
+class Timeline
+{
+public:
+    static Timeline & instance();
+
+    Timeline(const Timeline &) = delete;
+    Timeline & operator=(const Timeline &) = delete;
+
+    void registerStore(const TimelineStore * store);
+    void unregisterStore(const TimelineStore * store);
+
+    /**
+     * @brief Stamps of the oldest and newest records of all the stores.
+     * @return false if no store has a record.
+     */
+    bool recordedRange(int64_t & oldest_ns, int64_t & newest_ns) const;
+
+    /** @brief Bytes used in memory by all the stores. */
+    size_t memoryUsage() const;
+
+    /** @brief Bytes spilled to files by all the stores. */
+    size_t spilledBytes() const;
+
+    /** @brief Display the records at an instant; the live messages are still recorded. */
+    void scrubTo(int64_t stamp_ns);
+
+    /** @brief Display the live messages again. */
+    void goLive();
+
+    bool isScrubbing() const {return scrubbing_;}
+    int64_t scrubTime() const {return scrub_time_ns_;}
+
+    /** @brief Incremented by every change of the scrubbing state. */
+    uint64_t revision() const {return revision_;}
+
+private:
+    Timeline() = default;
+
+    std::vector<const TimelineStore *> stores_;
+    bool scrubbing_ = false;
+    int64_t scrub_time_ns_ = 0;
+    uint64_t revision_ = 0;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class TimelineSpill
+ * \brief Append-only files receiving the records dropped from the ring of a TimelineStore.
+ *
+ * The records are written with pwrite() and read back through read-only memory mappings, so that
+ * only the pages of the records that are drawn are resident. Two files share a base path:
+ * - "<base>.data": a 16-byte header (the magic "RVLGTML1", the uint32 number of columns and a
+ *   uint32 reserved for a version) followed by the float32 values of the records, column after
+ *   column;
+ * - "<base>.index": one Entry per record, in the order of the records.
+ * The files are scratch files, removed when the spill is closed.
+ */
+class TimelineSpill
+{
+public:
+    /** \struct Entry \brief On-disk index entry of a record. */
+    struct Entry
+    {
+        int64_t stamp_ns;
+        // Offset of the values of the record in the data file.
+        uint64_t offset;
+        uint64_t rows;
+    };
+
+    explicit TimelineSpill(size_t columns);
+    ~TimelineSpill();
+
+    TimelineSpill(const TimelineSpill &) = delete;
+    TimelineSpill & operator=(const TimelineSpill &) = delete;
+
+    /**
+     * @brief Create the files in directory, replacing any open ones.
+     * @return false with error set if they cannot be created.
+     */
+    bool open(const std::string & directory, std::string & error);
+
+    /** @brief Close and remove the files. */
+    void close();
+
+    bool isOpen() const {return data_fd_ >= 0;}
+
+    /** @brief Append a record, its values stored column after column. */
+    bool append(int64_t stamp_ns, const float * values, size_t rows);
+
+    /** @brief Drop all the records. */
+    void clear();
+
+    size_t size() const {return size_;}
+
+    /** @brief Entry of a record, from 0 for the oldest; zeroed if the index cannot be mapped. */
+    Entry entry(size_t index) const;
+
+    /**
+     * @brief Values of a record, paged in on access, or nullptr if they cannot be mapped.
+     *
+     * They are valid until the next call to values() or clear().
+     */
+    const float * values(const Entry & entry) const;
+
+    /** @brief Bytes written to the files. */
+    size_t fileBytes() const {return data_bytes_ + size_ * sizeof(Entry);}
+
+private:
+    /** Read-only mapping of the first bytes of a file, extended as the file grows. */
+    struct Mapping
+    {
+        void * address = nullptr;
+        size_t bytes = 0;
+    };
+
+    /** @brief Extend mapping to the first bytes bytes of the file fd. */
+    static const char * map(Mapping & mapping, int fd, size_t bytes);
+    static void unmap(Mapping & mapping);
+
+    size_t columns_;
+    std::string base_path_;
+    int data_fd_ = -1;
+    int index_fd_ = -1;
+    size_t data_bytes_ = 0;
+    size_t size_ = 0;
+
+    mutable Mapping data_mapping_;
+    mutable Mapping index_mapping_;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "rviz_legged_plugins/common/timeline_spill.hpp"
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class TimelineStore
+ * \brief Bounded, time-indexed ring of the messages of a display, for scrubbing back in time.
+ *
+ * A record holds what a display needs to draw one message again: a stamp shared by all its rows,
+ * and float columns of a fixed count. The values of a record are stored column after column in a
+ * single ring of floats, allocated once at the memory limit; the oldest records are dropped to make
+ * room for new ones. The stamps are kept in order, hence a seek by time is a binary search.
+ *
+ * With a spill, the dropped records are appended to a TimelineSpill instead, and stay available
+ * before the records of the ring: the history is bounded by the disk, the memory by the ring.
+ */
+class TimelineStore
+{
+public:
+    /** \struct Record \brief Read-only view of a record, valid until the next append or record. */
+    struct Record
+    {
+        int64_t stamp_ns;
+        size_t rows;
+        const float * values;
+
+        /** @brief The rows values of a column. */
+        const float * column(size_t index) const {return values + index * rows;}
+    };
+
+    explicit TimelineStore(size_t columns);
+
+    /** @brief Set the memory limit, in bytes, and drop all the records. 0 disables recording. */
+    void setMemoryLimit(size_t bytes);
+
+    /**
+     * @brief Spill the records dropped from the ring to files created in directory.
+     * @return false with error set if the files cannot be created.
+     */
+    bool openSpill(const std::string & directory, std::string & error);
+
+    /** @brief Drop the spilled records and remove their files. */
+    void closeSpill() {spill_.close();}
+
+    bool isSpilling() const {return spill_.isOpen();}
+
+    /**
+     * @brief Append a record of rows rows, and return its values to be filled, column after column.
+     *
+     * A stamp more than 1 s older than the newest record, e.g. after a bag looped, drops the
+     * previous records. A late message, stamped up to 1 s before the newest record, is not
+     * recorded.
+     * @return nullptr if recording is disabled, the record exceeds the memory limit or is late.
+     */
+    float * append(int64_t stamp_ns, size_t rows);
+
+    /** @brief Index of the newest record stamped at or before stamp_ns, if any. */
+    std::optional<size_t> seek(int64_t stamp_ns) const;
+
+    /**
+     * @brief Record by index, from 0 for the oldest to size() - 1 for the newest.
+     *
+     * The spilled records are paged in from their file; a record that cannot be has no rows.
+     */
+    Record record(size_t index) const;
+
+    size_t size() const {return spill_.size() + records_.size();}
+    bool empty() const {return size() == 0;}
+
+    int64_t oldestStamp() const;
+    int64_t newestStamp() const;
+
+    /** @brief Bytes allocated by the store in memory, at most the memory limit. */
+    size_t memoryUsage() const;
+
+    /** @brief Bytes of the spilled records. */
+    size_t spilledBytes() const {return spill_.fileBytes();}
+
+    size_t memoryLimit() const {return memory_limit_;}
+
+    void clear();
+
+private:
+    struct Entry
+    {
+        int64_t stamp_ns;
+        size_t offset;
+        size_t rows;
+        // Number of floats reserved in the ring, including the room of the entry itself.
+        size_t size;
+    };
+
+    /** @brief Drop the oldest record of the ring, spilling it if enabled. */
+    void dropOldest();
+
+    size_t columns_;
+    size_t memory_limit_ = 0;
+    std::vector<float> values_;
+    std::deque<Entry> records_;
+    TimelineSpill spill_;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <regex>
+#include <string>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * @brief Convert a topic glob into a regular expression.
+ *
+ * * matches any part of one name level and ? a single character, neither crossing a '/'.
+ */
+std::regex globToRegex(const std::string & glob);
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class TraceRecorder
+ * \brief Records spans of the display pipeline stages in the Chrome trace-event JSON format.
+ *
+ * The recorder is opt-in: it is enabled only when the RVIZ_LEGGED_TRACE_FILE environment variable
+ * contains the path of the output file. The file can be opened offline in Perfetto
+ * (ui.perfetto.dev) or in chrome://tracing.
+ */
+class TraceRecorder
+{
+public:
+    static TraceRecorder & instance();
+
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder &) = delete;
+    TraceRecorder & operator=(const TraceRecorder &) = delete;
+
+    bool isEnabled() const {return enabled_;}
+
+    /** @brief Steady clock time in microseconds, used as the trace time base. */
+    static int64_t nowMicroseconds();
+
+    /** @brief Add a span. name and category must be string literals. */
+    void addCompleteEvent(
+        const char * name, const char * category, int64_t start_us, int64_t duration_us);
+
+    /** @brief Add a zero-duration marker, e.g. the start of a render frame. */
+    void addInstantEvent(const char * name, const char * category);
+
+    /** @brief Add a sample of a counter track, e.g. the age of the processed message. */
+    void addCounterEvent(const char * name, const char * category, double value);
+
+    /** @brief Write the buffered events to the trace file. */
+    void flush();
+
+private:
+    TraceRecorder();
+
+    struct Event
+    {
+        const char * name;
+        const char * category;
+        char phase;
+        int64_t timestamp_us;
+        int64_t duration_us;
+        double value;
+        uint32_t thread_id;
+    };
+
+    void addEvent(const Event & event);
+    void writeEvent(const Event & event);
+
+    static uint32_t currentThreadId();
+
+    bool enabled_ = false;
+    bool first_event_ = true;
+    int process_id_ = 0;
+
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::vector<Event> events_;
+};
+
+/**
+ * \class TraceScope
+ * \brief RAII helper that records a complete event spanning its own lifetime.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char * name, const char * category);
+    ~TraceScope();
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope & operator=(const TraceScope &) = delete;
+
+private:
+    const char * name_;
+    const char * category_;
+    int64_t start_us_ = -1;
+};
+
+}  // namespace rviz_legged_plugins::common
+
+#define RVIZ_LEGGED_TRACE_CONCAT_IMPL(a, b) a ## b
+#define RVIZ_LEGGED_TRACE_CONCAT(a, b) RVIZ_LEGGED_TRACE_CONCAT_IMPL(a, b)
+
+/** Trace the enclosing scope. The arguments must be string literals. */
+#define RVIZ_LEGGED_TRACE_SCOPE(name, category) \
+    rviz_legged_plugins::common::TraceScope RVIZ_LEGGED_TRACE_CONCAT(trace_scope_, __LINE__)( \
+        name, category)
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <OgreColourValue.h>
+#include <OgreHardwareVertexBuffer.h>
+#include <OgreSimpleRenderable.h>
+#include <OgreVector3.h>
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class TrailBuffer
+ * \brief Line strip growing by one point at a time, drawn from a single vertex buffer.
+ *
+ * Appending a point writes that vertex only: the buffer doubles its capacity when full, hence a
+ * point costs an amortized constant time whatever the length of the trail, and the trail a
+ * single draw call. With a maximum number of points, the buffer holds twice as many points and
+ * draws a sliding window of it; the window is moved back to the start of the buffer once it
+ * reaches the end.
+ */
+class TrailBuffer : public Ogre::SimpleRenderable
+{
+public:
+    TrailBuffer();
+
+    ~TrailBuffer() override;
+
+    TrailBuffer(const TrailBuffer &) = delete;
+    TrailBuffer & operator=(const TrailBuffer &) = delete;
+
+    /** @brief Keep the max_points newest points only, 0 keeping all the points, and clear. */
+    void setMaxPoints(size_t max_points);
+
+    void append(const Ogre::Vector3 & position, const Ogre::ColourValue & colour);
+
+    /** @brief Drop the points and release the vertex buffer. */
+    void clear();
+
+    size_t size() const {return vertices_.size() - begin_;}
+    bool empty() const {return size() == 0;}
+
+    /** @brief The newest point. The trail must not be empty. */
+    Ogre::Vector3 back() const;
+
+    /** @brief Overridden from Renderable. */
+    Ogre::Real getSquaredViewDepth(const Ogre::Camera * camera) const override;
+
+    /** @brief Overridden from MovableObject. */
+    Ogre::Real getBoundingRadius() const override;
+
+private:
+    struct Vertex
+    {
+        float position[3];
+        uint32_t colour;
+    };
+
+    /** @brief Allocate a vertex buffer of capacity vertices, and upload the points. */
+    void reallocate(size_t capacity);
+    void updateRenderOperation();
+    void updateBounds();
+
+    // Copy of the vertex buffer, up to its last written vertex; the points are those from begin_.
+    std::vector<Vertex> vertices_;
+    size_t begin_ = 0;
+    size_t max_points_ = 0;
+    size_t capacity_ = 0;
+    Ogre::HardwareVertexBufferSharedPtr buffer_;
+    Ogre::VertexElementType colour_type_;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "rclcpp/node.hpp"
+#include "tf2_ros/message_filter.h"
+
+#include "rviz_common/transformation/frame_transformer.hpp"
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class TransformFilter
+ * \brief Holds the messages of a topic until the transform of their frame at their stamp arrives.
+ *
+ * The counterpart, for the topics a display subscribes to itself, of the tf2_ros::MessageFilter of
+ * a MessageFilterDisplay; MessageT only needs a header. Until reset(), or after clear(), the
+ * messages are passed through at once.
+ */
+template<typename MessageT>
+class TransformFilter
+{
+public:
+    using Callback = std::function<void(std::shared_ptr<const MessageT>)>;
+
+    TransformFilter() = default;
+
+    explicit TransformFilter(Callback callback)
+    : callback_(std::move(callback)) {}
+
+    /** @brief Hold the messages until their frame can be transformed into target_frame. */
+    void reset(
+        rviz_common::transformation::FrameTransformer & transformer, const std::string & target_frame,
+        uint32_t queue_size, const rclcpp::Node::SharedPtr & node)
+    {
+        filter_ = std::make_shared<
+            tf2_ros::MessageFilter<MessageT, rviz_common::transformation::FrameTransformer>>(
+            transformer, target_frame, queue_size, node);
+        filter_->registerCallback(callback_);
+    }
+
+    /** @brief Drop the held messages and pass the next ones through. */
+    void clear() {filter_.reset();}
+
+    void setTargetFrame(const std::string & target_frame)
+    {
+        if (filter_) {
+            filter_->setTargetFrame(target_frame);
+        }
+    }
+
+    void add(std::shared_ptr<const MessageT> msg)
+    {
+        if (filter_) {
+            filter_->add(msg);
+        } else {
+            callback_(msg);
+        }
+    }
+
+private:
+    Callback callback_;
+    std::shared_ptr<tf2_ros::MessageFilter<MessageT, rviz_common::transformation::FrameTransformer>>
+    filter_;
+};
+
+}  // namespace rviz_legged_plugins::common
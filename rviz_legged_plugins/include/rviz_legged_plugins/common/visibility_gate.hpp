@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+
+namespace Ogre
+{
+class SceneNode;
+}  // namespace Ogre
+
+namespace rviz_common
+{
+class DisplayContext;
+}  // namespace rviz_common
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class VisibilityGate
+ * \brief Defers the processing of the messages of a display while its content is off-screen.
+ *
+ * While the bounding box of the scene node of the display is outside the view frustum, only the
+ * latest message is kept; it is processed as soon as the content is visible again. The kept
+ * message is also processed every refresh period, so that content moving back into the view is
+ * noticed even though its bounding box is stale. With a minimum period, the messages are also kept
+ * while the last one was processed less than that period ago.
+ */
+class VisibilityGate
+{
+public:
+    /** @brief Seconds after which a kept message is processed even though the content is culled. */
+    static constexpr float kRefreshPeriod = 1.0f;
+
+    void initialize(rviz_common::DisplayContext * context, Ogre::SceneNode * scene_node);
+
+    /**
+     * @brief Whether a message must be processed now.
+     *
+     * When it returns false, process is kept, replacing any previously kept message, and is
+     * called by a later update().
+     */
+    bool admit(std::function<void()> process);
+
+    /** @brief To be called once per frame, from Display::update(). */
+    void update(float wall_dt);
+
+    /** @brief Set the minimum time, in s, between two processed messages; 0 for no limit. */
+    void setMinPeriod(float min_period) {min_period_ = min_period;}
+
+    /** @brief Whether the message being processed is a kept one, already seen by the display. */
+    bool isReplaying() const {return replaying_;}
+
+    /** @brief Drop the kept message, e.g. on reset. */
+    void clear() {pending_ = nullptr;}
+
+private:
+    bool isContentVisible() const;
+
+    bool isDue() const {return time_since_processed_ >= min_period_ && isContentVisible();}
+
+    rviz_common::DisplayContext * context_ = nullptr;
+    Ogre::SceneNode * scene_node_ = nullptr;
+
+    std::function<void()> pending_;
+    bool replaying_ = false;
+    float time_since_processed_ = 0.0f;
+    float min_period_ = 0.0f;
+};
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
+#include <OgreTexture.h>
+#include <OgreVector3.h>
+
+#include "rviz_legged_plugins/common/colormap.hpp"
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+
+namespace Ogre
+{
+class ManualObject;
+}
+
+namespace rviz_legged_plugins::common
+{
+/**
+ * \class WrenchArrowMaterial
+ * \brief Material of wrench arrows drawn as lines, styled entirely by its parameters.
+ *
+ * The vertices written by addWrench() hold the contact point, their offset from it at unit scale
+ * and the force of the wrench. The vertex shader scales the arrows and maps the forces to the
+ * colormap, hence changing the scales, colors, alpha, colormap or range of any number of arrows
+ * is a parameter update.
+ */
+class WrenchArrowMaterial
+{
+public:
+    enum ColorMode
+    {
+        FLAT,
+        MAGNITUDE,
+        TANGENTIAL_NORMAL_RATIO
+    };
+
+    /**
+     * \struct Ranges
+     * \brief Ranges of the magnitudes and ratios of the forces of a message, for the auto range.
+     */
+    struct Ranges
+    {
+        ScalarRange magnitude;
+        ScalarRange ratio;
+    };
+
+    /** Vertices of the line list of a wrench: a shaft and four barbs per arrow. */
+    static constexpr size_t kWrenchVertexCount = 20;
+
+    WrenchArrowMaterial();
+
+    ~WrenchArrowMaterial();
+
+    WrenchArrowMaterial(const WrenchArrowMaterial &) = delete;
+    WrenchArrowMaterial & operator=(const WrenchArrowMaterial &) = delete;
+
+    const std::string & getName() const {return material_->getName();}
+
+    void setScales(float force_scale, float torque_scale);
+
+    /** @brief Draw the arrows with the head of the force, instead of its tail, on the contact point. */
+    void setArrowHeadAsReference(bool enabled);
+
+    void setColors(const Ogre::ColourValue & force_color, const Ogre::ColourValue & torque_color);
+
+    /** @brief Set the alpha of the arrows, blended without depth writes below 1. */
+    void setAlpha(float alpha);
+
+    void setColorMode(ColorMode mode);
+
+    void setColormap(Colormap colormap);
+
+    /** @brief Map the ranges of each message to the colormap, or the fixed range [min, max]. */
+    void setRange(bool auto_range, float min, float max);
+
+    /** @brief Ranges of the colormap values of the wrenches of a message. */
+    static Ranges computeRanges(const std::vector<WrenchSample> & samples);
+
+    /** @brief Append the arrows of a wrench to the current section of a line list. */
+    static void addWrench(
+        Ogre::ManualObject & manual_object, const Ogre::Vector3 & position, const WrenchSample & sample,
+        const Ranges & ranges);
+
+    /** @brief Bounds of the arrows of a wrench for scales up to force_scale and torque_scale. */
+    static Ogre::AxisAlignedBox bounds(
+        const Ogre::Vector3 & position, const WrenchSample & sample, float force_scale, float torque_scale);
+
+private:
+    Ogre::MaterialPtr material_;
+    // 256 x 1 texels of the colormap, sampled by the fragment shader.
+    Ogre::TexturePtr colormap_texture_;
+    std::optional<Colormap> colormap_;
+};
+
+}  // namespace rviz_legged_plugins::common
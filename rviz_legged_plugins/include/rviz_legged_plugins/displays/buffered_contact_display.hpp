@@ -0,0 +1,903 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <OgreMath.h>
+#include <OgreQuaternion.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreVector3.h>
+
+#include "builtin_interfaces/msg/time.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "rclcpp/time.hpp"
+#include "std_msgs/msg/header.hpp"
+
+#include "rviz_common/display_context.hpp"
+#include "rviz_common/frame_manager_iface.hpp"
+#include "rviz_common/message_filter_display.hpp"
+#include "rviz_common/msg_conversions.hpp"
+#include "rviz_common/properties/enum_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+#include "rviz_common/properties/int_property.hpp"
+#include "rviz_common/properties/property.hpp"
+#include "rviz_common/properties/status_property.hpp"
+#include "rviz_common/properties/string_property.hpp"
+
+#include "rviz_legged_plugins/common/frame_budget.hpp"
+#include "rviz_legged_plugins/common/timeline.hpp"
+#include "rviz_legged_plugins/common/timeline_store.hpp"
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
+#include "rviz_legged_plugins/common/transform_filter.hpp"
+#include "rviz_legged_plugins/common/visibility_gate.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+/** Transform used for a message whose stamp has no transform yet. */
+enum TransformPolicy
+{
+    // The messages wait for the transform at their stamp, in the filter of the topic.
+    EXACT,
+    // The newest transform.
+    LATEST_AVAILABLE,
+    // The newest transform, moved to the stamp at the velocity of the frame.
+    EXTRAPOLATED
+};
+
+/**
+ * \class BufferedContactDisplay
+ * \brief Base of the displays keeping what they draw for their last messages.
+ *
+ * It provides the parts shared by the legged displays:
+ * - a ring buffer of message slots, whose instances are pooled and reused by later messages, and
+ *   can be created when the display is initialized from the "Expected Contacts";
+ * - the resolution of the frames of a message, each frame being looked up once;
+ * - the "Transform Policy" of the lookups: a message can be drawn with the newest transform, or
+ *   one extrapolated to its stamp, instead of waiting for the transform at its stamp;
+ * - a snapshot of the style properties, read again only after one of them changed;
+ * - a timeline store of the last messages, drawn again by renderRecord() when the timeline is
+ *   scrubbed;
+ * - a visibility gate deferring the messages while the content is off-screen, see admitMessage();
+ * - the "Frame Budget" of the display: while the frames take longer, the FrameBudget governor
+ *   reduces the history, then the display applies the further reductions it supports in
+ *   applyFrameBudgetLevel().
+ *
+ * Policy provides:
+ * - Instance, what is drawn for one element of a message (a contact, a path), created by
+ *   createInstance();
+ * - Style, the values of the style properties, filled by readStyle();
+ * - static void setVisible(Instance &, bool), which hides the pooled instances a message does not
+ *   use;
+ * - static constexpr const char * kTraceCategory and kMessageAgeCounter, the category of the trace
+ *   events and the name of the counter of the age of the messages;
+ * - static constexpr size_t kTimelineColumns, the number of columns of the timeline records, and
+ *   static constexpr int kTimelineMemoryMiB, the default memory of the timeline store.
+ *
+ * The template does not declare Q_OBJECT; the concrete displays declare their own slots.
+ * Displays whose instances use resources they own, e.g. materials, must call clearSlots() in
+ * their destructor.
+ */
+template<typename MessageType, typename Policy>
+class BufferedContactDisplay : public rviz_common::MessageFilterDisplay<MessageType>
+{
+public:
+    using Instance = typename Policy::Instance;
+    using Style = typename Policy::Style;
+
+    /**
+     * \struct Slot
+     * \brief Instances drawn for one message, below a node carrying the transform of its frame.
+     */
+    struct Slot
+    {
+        Ogre::SceneNode * node = nullptr;
+        std::vector<std::unique_ptr<Instance>> instances;
+        // Number of instances used by the message, the following ones being hidden.
+        size_t size = 0;
+    };
+
+    /** \struct FrameTransform \brief Pose of a frame in the fixed frame. */
+    struct FrameTransform
+    {
+        Ogre::Vector3 position;
+        Ogre::Quaternion orientation;
+    };
+
+    BufferedContactDisplay()
+    : timeline_store_(Policy::kTimelineColumns)
+    {
+        transform_policy_property_ = new rviz_common::properties::EnumProperty(
+            "Transform Policy", "Exact",
+            "Transform of the messages whose stamp has no transform yet. Exact holds them until it "
+            "arrives, Latest Available draws them at once with the newest transform, Extrapolated "
+            "moves the newest transform to their stamp at the velocity of their frame.",
+            this);
+        transform_policy_property_->addOption("Exact", EXACT);
+        transform_policy_property_->addOption("Latest Available", LATEST_AVAILABLE);
+        transform_policy_property_->addOption("Extrapolated", EXTRAPOLATED);
+        QObject::connect(
+            transform_policy_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {updateTransformPolicy();});
+
+        max_extrapolation_property_ = new rviz_common::properties::FloatProperty(
+            "Max Extrapolation", 0.1F,
+            "Longest time, in s, the newest transform is extrapolated over; the transform of a "
+            "later stamp is extrapolated to this horizon only.",
+            transform_policy_property_);
+        max_extrapolation_property_->setMin(0.0F);
+        max_extrapolation_property_->hide();
+
+        expected_contacts_property_ = new rviz_common::properties::IntProperty(
+            "Expected Contacts", 0,
+            "Number of contacts expected in a message. The objects of that many contacts are created "
+            "for every buffered message when the display is initialized, rather than on the first "
+            "messages. 0 creates them on demand.",
+            this);
+        expected_contacts_property_->setMin(0);
+        QObject::connect(
+            expected_contacts_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {prewarmSlots();});
+
+        frame_budget_property_ = new rviz_common::properties::FloatProperty(
+            "Frame Budget", 0.0F,
+            "Target render time, in ms, of the frames: the culling and draw calls of the scene, "
+            "without the wait for the display. While the frames take longer, the quality of the "
+            "display is reduced step by step (history, pose markers, cone detail, update rate) and "
+            "restored once they are fast again. 0 keeps the full quality.",
+            this);
+        frame_budget_property_->setMin(0.0F);
+        QObject::connect(
+            frame_budget_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {updateFrameBudget();});
+    }
+
+    ~BufferedContactDisplay() override
+    {
+        common::FrameBudget::instance().setBudget(this, 0.0f);
+        common::Timeline::instance().unregisterStore(&timeline_store_);
+        clearSlots();
+    }
+
+protected:
+    /** @brief Create an instance, attached below parent. */
+    virtual std::unique_ptr<Instance> createInstance(Ogre::SceneNode * parent) = 0;
+
+    /** @brief Read the style properties. */
+    virtual void readStyle(Style & style) const = 0;
+
+    /** @brief Draw a record of the timeline store into a new slot. */
+    virtual void renderRecord(const common::TimelineStore::Record & record) = 0;
+
+    /** @brief Allocate the buffers of an instance created ahead of the messages, hidden next. */
+    virtual void prewarmInstance(Instance & instance) {(void)instance;}
+
+    /**
+     * @brief Apply the reductions of a level of the frame budget, beyond the history.
+     *
+     * Called when the level of the display changes, the style being read again before its next
+     * use.
+     */
+    virtual void applyFrameBudgetLevel(common::FrameBudget::Level level) {(void)level;}
+
+    /**
+     * @brief Overridden from MessageFilterDisplay.
+     *
+     * Unless the Transform Policy is Exact, the messages of the topic skip the filter waiting for
+     * the transform at their stamp.
+     */
+    void subscribe() override
+    {
+        rviz_common::MessageFilterDisplay<MessageType>::subscribe();
+        if (!this->subscription_ || transformPolicy() == EXACT) {
+            return;
+        }
+
+        this->tf_filter_.reset();
+        this->messages_received_ = 0;
+        this->subscription_->registerCallback(
+            [this](const typename MessageType::ConstSharedPtr & msg) {
+                this->setStatus(
+                    rviz_common::properties::StatusProperty::Ok, "Topic",
+                    QString::number(++this->messages_received_) + " messages received");
+                this->processMessage(msg);
+            });
+    }
+
+    /**
+     * @brief Reset the filter of another topic of the display to follow the Transform Policy.
+     *
+     * Under Exact, its messages wait for the transform at their stamp like those of the topic;
+     * otherwise they are passed through. Called when the topic is subscribed.
+     */
+    template<typename T>
+    void resetTransformFilter(common::TransformFilter<T> & filter)
+    {
+        if (transformPolicy() != EXACT) {
+            filter.clear();
+            return;
+        }
+        filter.reset(
+            *this->context_->getFrameManager()->getTransformer(), this->fixed_frame_.toStdString(),
+            static_cast<uint32_t>(this->message_queue_property_->getInt()),
+            this->rviz_ros_node_.lock()->get_raw_node());
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Ring buffer
+
+    /**
+     * @brief Set the number of messages kept; the newest ones are kept when it decreases.
+     *
+     * The frame budget may keep fewer messages.
+     */
+    void setHistoryLength(size_t length)
+    {
+        requested_history_length_ = std::max<size_t>(length, 1);
+        resizeHistory(effectiveHistoryLength());
+    }
+
+    /**
+     * @brief Create the slots of the whole history, with the instances of the Expected Contacts.
+     *
+     * Called when the history length or the Expected Contacts change; displays must call it again
+     * after clearSlots(), except on destruction. The instances already created are kept.
+     */
+    void prewarmSlots()
+    {
+        size_t contacts = static_cast<size_t>(expected_contacts_property_->getInt());
+        if (contacts == 0 || !this->scene_node_) {
+            return;
+        }
+
+        RVIZ_LEGGED_TRACE_SCOPE("prewarmSlots", Policy::kTraceCategory);
+        auto start = std::chrono::steady_clock::now();
+
+        // The new slots are the oldest ones, claimed first.
+        bool empty = slots_.empty();
+        while (slots_.size() < history_length_) {
+            slots_.emplace_back();
+            slots_.back().node = this->scene_node_->createChildSceneNode();
+        }
+        if (empty) {
+            newest_ = slots_.size() - 1;
+        }
+        for (auto & slot : slots_) {
+            while (slot.instances.size() < contacts) {
+                slot.instances.push_back(createInstance(slot.node));
+                prewarmInstance(*slot.instances.back());
+                Policy::setVisible(*slot.instances.back(), false);
+            }
+        }
+
+        prewarm_time_ += std::chrono::steady_clock::now() - start;
+    }
+
+    /**
+     * @brief Slot of a new message of size elements.
+     *
+     * Once the ring is full, it is the slot of the oldest message, whose instances are reused:
+     * only the missing instances are created and the extra ones are hidden.
+     */
+    Slot & claimSlot(size_t size)
+    {
+        if (slots_.size() < history_length_) {
+            slots_.emplace_back();
+            slots_.back().node = this->scene_node_->createChildSceneNode();
+            newest_ = slots_.size() - 1;
+        } else {
+            newest_ = (newest_ + 1) % slots_.size();
+        }
+
+        auto & slot = slots_[newest_];
+        if (slot.instances.size() < size) {
+            auto start = std::chrono::steady_clock::now();
+            startup_created_instances_ += size - slot.instances.size();
+            while (slot.instances.size() < size) {
+                slot.instances.push_back(createInstance(slot.node));
+            }
+            startup_creation_time_ += std::chrono::steady_clock::now() - start;
+        }
+        if (size > 0) {
+            first_message_drawn_ = true;
+        }
+        for (size_t i = 0; i < slot.instances.size(); i++) {
+            Policy::setVisible(*slot.instances[i], i < size);
+        }
+        slot.size = size;
+        return slot;
+    }
+
+    /** @brief Slot of the last message, nullptr if there is none. */
+    Slot * newestSlot()
+    {
+        return slots_.empty() ? nullptr : &slots_[newest_];
+    }
+
+    /** @brief Call f on the slots, from the newest to the oldest, until it returns false. */
+    template<typename F>
+    void forEachSlotNewestFirst(F f)
+    {
+        for (size_t k = 0; k < slots_.size(); k++) {
+            if (!f(slots_[(newest_ + slots_.size() - k) % slots_.size()])) {
+                return;
+            }
+        }
+    }
+
+    size_t slotCount() const {return slots_.size();}
+
+    /** @brief The "Expected Contacts" property, parent of the expected layout of the display. */
+    rviz_common::properties::Property * expectedContactsProperty() const
+    {
+        return expected_contacts_property_;
+    }
+
+    /** @brief Destroy all the slots and their instances. */
+    void clearSlots()
+    {
+        for (auto & slot : slots_) {
+            destroySlot(slot);
+        }
+        slots_.clear();
+        newest_ = 0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Frames
+
+    /**
+     * @brief Look up the transforms of a table of frames sharing a stamp, each frame once.
+     *
+     * On success, the transform of frame_ids[i] is resolvedFrame(i). Otherwise the status
+     * reports the missing frame.
+     */
+    bool resolveFrames(
+        const std::vector<std::string> & frame_ids, const builtin_interfaces::msg::Time & stamp)
+    {
+        RVIZ_LEGGED_TRACE_SCOPE("resolveFrames", Policy::kTraceCategory);
+
+        resolved_frames_.resize(frame_ids.size());
+        for (size_t i = 0; i < frame_ids.size(); i++) {
+            if (!lookupTransform(frame_ids[i], stamp, resolved_frames_[i])) {
+                this->setMissingTransformToFixedFrame(frame_ids[i]);
+                return false;
+            }
+        }
+        this->setTransformOk();
+        return true;
+    }
+
+    const FrameTransform & resolvedFrame(size_t index) const {return resolved_frames_[index];}
+
+    /** @brief Start the lookups of a message whose elements have their own headers. */
+    void beginFrameBatch() {frame_batch_.clear();}
+
+    /**
+     * @brief Transform of the frame of a header, looked up once per frame and stamp of the batch.
+     * @return false if it is missing, the status reporting the missing frame.
+     */
+    bool lookupFrame(const std_msgs::msg::Header & header, FrameTransform & transform)
+    {
+        for (const auto & entry : frame_batch_) {
+            if (entry.stamp == header.stamp && entry.frame_id == header.frame_id) {
+                transform = entry.transform;
+                return true;
+            }
+        }
+
+        RVIZ_LEGGED_TRACE_SCOPE("getTransform", Policy::kTraceCategory);
+
+        if (!lookupTransform(header.frame_id, header.stamp, transform)) {
+            this->setMissingTransformToFixedFrame(header.frame_id);
+            return false;
+        }
+        this->setTransformOk();
+        frame_batch_.push_back({header.frame_id, header.stamp, transform});
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Style
+
+    /** @brief Read the style again before its next use whenever property changes. */
+    void watchStyle(rviz_common::properties::Property * property)
+    {
+        // Emitted before the slots connected to changed() run, which therefore see the new style.
+        QObject::connect(
+            property, &rviz_common::properties::Property::aboutToChange, this,
+            [this]() {style_dirty_ = true;});
+    }
+
+    /** @brief Snapshot of the style properties, read once after any change. */
+    const Style & style()
+    {
+        if (style_dirty_) {
+            readStyle(style_);
+            style_dirty_ = false;
+        }
+        return style_;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Timeline
+
+    /** @brief Add the "Timeline Memory" property and register the store, from onInitialize(). */
+    void initializeTimeline()
+    {
+        timeline_memory_property_ = new rviz_common::properties::IntProperty(
+            "Timeline Memory", Policy::kTimelineMemoryMiB,
+            "Memory, in MiB, of the last messages recorded for the Timeline panel, which draws them "
+            "again when scrubbing back in time. The time recorded grows with the memory and shrinks "
+            "with the rate and the size of the messages, as shown by the \"Timeline\" status. "
+            "0 disables the recording.",
+            this);
+        timeline_memory_property_->setMin(0);
+        QObject::connect(
+            timeline_memory_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {
+                timeline_store_.setMemoryLimit(
+                    static_cast<size_t>(timeline_memory_property_->getInt()) << 20);
+            });
+        timeline_store_.setMemoryLimit(static_cast<size_t>(timeline_memory_property_->getInt()) << 20);
+
+        timeline_spill_property_ = new rviz_common::properties::StringProperty(
+            "Spill Directory", "",
+            "Directory of the files receiving the messages dropped from the timeline memory, which "
+            "are read back only when drawn. Empty keeps only the messages in memory.",
+            timeline_memory_property_);
+        QObject::connect(
+            timeline_spill_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {updateTimelineSpill();});
+        updateTimelineSpill();
+
+        common::Timeline::instance().registerStore(&timeline_store_);
+    }
+
+    /**
+     * @brief Record a message of rows rows in the timeline store.
+     * @return the values of the record, to be filled column after column, or nullptr if the
+     * message is not recorded.
+     */
+    float * recordMessage(const builtin_interfaces::msg::Time & stamp, size_t rows)
+    {
+        return timeline_store_.append(rclcpp::Time(stamp).nanoseconds(), rows);
+    }
+
+    /** @brief Whether the timeline is scrubbed, the live messages being only recorded. */
+    bool isScrubbing() const
+    {
+        return timeline_store_.memoryLimit() > 0 && common::Timeline::instance().isScrubbing();
+    }
+
+    /** @brief Drop the recorded messages, e.g. on reset. */
+    void clearTimeline() {timeline_store_.clear();}
+
+    /** @brief Follow the changes of the timeline and refresh the statuses, from update(). */
+    void updateTimeline(float wall_dt)
+    {
+        auto & timeline = common::Timeline::instance();
+        // Without recording, the display ignores the timeline.
+        if (timeline.revision() != timeline_revision_ && timeline_store_.memoryLimit() > 0) {
+            timeline_revision_ = timeline.revision();
+            drawTimeline(
+                timeline.isScrubbing() ? timeline.scrubTime() : std::numeric_limits<int64_t>::max());
+        }
+
+        if (first_message_drawn_ && !startup_reported_) {
+            startup_reported_ = true;
+            reportStartup();
+        }
+
+        time_since_status_ += wall_dt;
+        if (time_since_status_ >= 1.0f) {
+            time_since_status_ = 0.0f;
+            updateTimelineStatus();
+            updateTransformStatus();
+            updateFrameBudgetStatus();
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Visibility
+
+    /** @brief Gate of the messages, initialized and updated by the display. */
+    common::VisibilityGate & visibilityGate() {return visibility_gate_;}
+
+    /**
+     * @brief Whether a message must be handled now.
+     *
+     * While the content is off-screen, only the latest message is kept: when this returns false,
+     * handler is called again with it once the content is visible.
+     */
+    template<typename Derived, typename MessagePtr>
+    bool admitMessage(void (Derived::* handler)(MessagePtr), MessagePtr msg)
+    {
+        auto * display = static_cast<Derived *>(this);
+        return visibility_gate_.admit([display, handler, msg] {(display->*handler)(msg);});
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Frame budget
+
+    /** @brief Level of the frame budget applied to the display, FULL_QUALITY without a budget. */
+    common::FrameBudget::Level frameBudgetLevel() const {return frame_budget_level_;}
+
+    /** @brief Follow the changes of the level of the governor, from update(). */
+    void followFrameBudget()
+    {
+        auto revision = common::FrameBudget::instance().revision();
+        if (revision != frame_budget_revision_) {
+            frame_budget_revision_ = revision;
+            applyFrameBudget();
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Tracing
+
+    /** @brief Trace the age of a message when it is processed, including the wait for its TF. */
+    void traceMessageAge(const builtin_interfaces::msg::Time & stamp)
+    {
+        auto & tracer = common::TraceRecorder::instance();
+        if (tracer.isEnabled()) {
+            tracer.addCounterEvent(
+                Policy::kMessageAgeCounter, Policy::kTraceCategory,
+                1e-6 * static_cast<double>(
+                    this->context_->getClock()->now().nanoseconds() -
+                    rclcpp::Time(stamp).nanoseconds()));
+        }
+    }
+
+private:
+    // Fraction of the requested history kept from the REDUCED_HISTORY level on.
+    static constexpr size_t kReducedHistoryDivisor = 4;
+
+    size_t effectiveHistoryLength() const
+    {
+        if (frame_budget_level_ >= common::FrameBudget::REDUCED_HISTORY) {
+            return std::max<size_t>(requested_history_length_ / kReducedHistoryDivisor, 1);
+        }
+        return requested_history_length_;
+    }
+
+    /** @brief Set the number of slots; the newest ones are kept when it decreases. */
+    void resizeHistory(size_t length)
+    {
+        if (!slots_.empty()) {
+            // Order the slots from the oldest to the newest, so that the ring grows at its end.
+            std::rotate(slots_.begin(), slots_.begin() + (newest_ + 1) % slots_.size(), slots_.end());
+            if (slots_.size() > length) {
+                auto dropped = slots_.begin() + static_cast<std::ptrdiff_t>(slots_.size() - length);
+                for (auto it = slots_.begin(); it != dropped; ++it) {
+                    destroySlot(*it);
+                }
+                slots_.erase(slots_.begin(), dropped);
+            }
+            newest_ = slots_.size() - 1;
+        }
+        history_length_ = length;
+        prewarmSlots();
+    }
+
+    struct FrameEntry
+    {
+        std::string frame_id;
+        builtin_interfaces::msg::Time stamp;
+        FrameTransform transform;
+    };
+
+    /**
+     * @brief Report the time from the creation of the display to the first frame drawing a
+     * message, and the time spent creating the objects of the messages, which prewarmSlots() moves
+     * ahead of them.
+     */
+    void reportStartup()
+    {
+        auto milliseconds = [](std::chrono::steady_clock::duration duration) {
+                return std::chrono::duration<double, std::milli>(duration).count();
+            };
+        double first_frame = milliseconds(std::chrono::steady_clock::now() - initialized_at_);
+        double creation = milliseconds(startup_creation_time_);
+
+        auto & tracer = common::TraceRecorder::instance();
+        if (tracer.isEnabled()) {
+            tracer.addCounterEvent("time to first frame [ms]", Policy::kTraceCategory, first_frame);
+            tracer.addCounterEvent(
+                "object creation until first frame [ms]", Policy::kTraceCategory, creation);
+        }
+        this->setStatus(
+            rviz_common::properties::StatusProperty::Ok, "Startup",
+            QString(
+                "First frame %1 ms after the creation of the display; %2 objects created for the "
+                "messages in %3 ms, %4 ms ahead of them")
+            .arg(first_frame, 0, 'f', 1)
+            .arg(startup_created_instances_)
+            .arg(creation, 0, 'f', 1)
+            .arg(milliseconds(prewarm_time_), 0, 'f', 1));
+    }
+
+    // Time over which the velocity of a frame is estimated, before the newest transform.
+    static constexpr double kVelocityWindow = 0.05;
+
+    TransformPolicy transformPolicy() const
+    {
+        return static_cast<TransformPolicy>(transform_policy_property_->getOptionInt());
+    }
+
+    /** @brief Transform of a frame at a stamp, following the Transform Policy. */
+    bool lookupTransform(
+        const std::string & frame_id, const builtin_interfaces::msg::Time & stamp,
+        FrameTransform & transform)
+    {
+        auto * frame_manager = this->context_->getFrameManager();
+        transform_lookups_++;
+        if (frame_manager->getTransform(frame_id, stamp, transform.position, transform.orientation) &&
+            !transform.position.isNaN())
+        {
+            return true;
+        }
+        auto policy = transformPolicy();
+        if (policy == EXACT) {
+            return false;
+        }
+
+        // The newest transform, and its stamp, of the frame in the fixed frame.
+        geometry_msgs::msg::PoseStamped pose;
+        pose.header.frame_id = frame_id;
+        pose.pose.orientation.w = 1.0;
+        try {
+            pose = frame_manager->getTransformer()->transform(pose, frame_manager->getFixedFrame());
+        } catch (const std::exception &) {
+            return false;
+        }
+        transform.position = rviz_common::pointMsgToOgre(pose.pose.position);
+        transform.orientation = rviz_common::quaternionMsgToOgre(pose.pose.orientation);
+        if (transform.position.isNaN()) {
+            return false;
+        }
+
+        int64_t newest_ns = rclcpp::Time(pose.header.stamp).nanoseconds();
+        double lag = 1e-9 * static_cast<double>(rclcpp::Time(stamp).nanoseconds() - newest_ns);
+        double horizon = std::clamp(
+            lag, 0.0, policy == EXTRAPOLATED ? max_extrapolation_property_->getFloat() : 0.0);
+        FrameTransform previous;
+        if (horizon > 0.0 &&
+            frame_manager->getTransform(
+                frame_id, rclcpp::Time(newest_ns - static_cast<int64_t>(1e9 * kVelocityWindow)),
+                previous.position, previous.orientation))
+        {
+            // Constant linear and angular velocities over the window.
+            auto ratio = static_cast<Ogre::Real>(horizon / kVelocityWindow);
+            transform.position += (transform.position - previous.position) * ratio;
+            Ogre::Radian angle;
+            Ogre::Vector3 axis;
+            // The shortest rotation: q and -q are the same orientation, but not the same angle.
+            auto delta = transform.orientation * previous.orientation.Inverse();
+            if (delta.w < 0.0f) {
+                delta = -delta;
+            }
+            delta.ToAngleAxis(angle, axis);
+            transform.orientation = Ogre::Quaternion(angle * ratio, axis) * transform.orientation;
+            transform_extrapolations_++;
+        } else {
+            horizon = 0.0;
+        }
+
+        transform_fallbacks_++;
+        transform_max_lag_ = std::max(transform_max_lag_, lag - horizon);
+        return true;
+    }
+
+    void updateTransformPolicy()
+    {
+        max_extrapolation_property_->setHidden(transformPolicy() != EXTRAPOLATED);
+        if (!this->context_) {
+            return;
+        }
+
+        updateTransformStatus();
+        // The filter of the topic is bypassed or restored by a new subscription.
+        if (this->isEnabled()) {
+            this->unsubscribe();
+            this->reset();
+            this->subscribe();
+        }
+    }
+
+    /** @brief Report the lookups of the last second that did not find the transform at the stamp. */
+    void updateTransformStatus()
+    {
+        auto policy = transformPolicy();
+        QString text;
+        if (policy == EXACT) {
+            text = "Exact: the messages wait for the transform at their stamp";
+        } else {
+            text = QString("%1: %2 of %3 lookups without the transform at the stamp")
+                .arg(policy == LATEST_AVAILABLE ? "Latest Available" : "Extrapolated")
+                .arg(transform_fallbacks_)
+                .arg(transform_lookups_);
+            if (policy == EXTRAPOLATED) {
+                text += QString(", %1 extrapolated").arg(transform_extrapolations_);
+            }
+            if (transform_fallbacks_ > 0) {
+                text += QString(", up to %1 ms behind").arg(1e3 * transform_max_lag_, 0, 'f', 1);
+            }
+        }
+        this->setStatus(rviz_common::properties::StatusProperty::Ok, "Transform Policy", text);
+
+        transform_lookups_ = 0;
+        transform_fallbacks_ = 0;
+        transform_extrapolations_ = 0;
+        transform_max_lag_ = 0.0;
+    }
+
+    void updateFrameBudget()
+    {
+        common::FrameBudget::instance().setBudget(this, 1e-3f * frame_budget_property_->getFloat());
+        applyFrameBudget();
+        updateFrameBudgetStatus();
+    }
+
+    /** @brief Apply the level of the governor, or the full quality without a budget. */
+    void applyFrameBudget()
+    {
+        auto level = frame_budget_property_->getFloat() > 0.0F ?
+            common::FrameBudget::instance().level() : common::FrameBudget::FULL_QUALITY;
+        if (level == frame_budget_level_) {
+            return;
+        }
+
+        RVIZ_LEGGED_TRACE_SCOPE("applyFrameBudget", Policy::kTraceCategory);
+
+        frame_budget_level_ = level;
+        style_dirty_ = true;
+        resizeHistory(effectiveHistoryLength());
+        applyFrameBudgetLevel(level);
+        if (this->context_) {
+            this->context_->queueRender();
+        }
+    }
+
+    void updateFrameBudgetStatus()
+    {
+        if (frame_budget_property_->getFloat() <= 0.0F) {
+            this->deleteStatus("Frame Budget");
+            return;
+        }
+        const auto & frame_budget = common::FrameBudget::instance();
+        this->setStatus(
+            frame_budget_level_ == common::FrameBudget::FULL_QUALITY ?
+            rviz_common::properties::StatusProperty::Ok :
+            rviz_common::properties::StatusProperty::Warn,
+            "Frame Budget",
+            QString(
+                "Level %1 of %2, %3: frames rendered in %4 ms for a budget of %5 ms, history of %6 "
+                "messages")
+            .arg(static_cast<int>(frame_budget_level_))
+            .arg(common::FrameBudget::kMaxLevel)
+            .arg(common::FrameBudget::levelName(frame_budget_level_))
+            .arg(1e3 * frame_budget.frameTime(), 0, 'f', 1)
+            .arg(1e3 * frame_budget.budget(), 0, 'f', 1)
+            .arg(effectiveHistoryLength()));
+    }
+
+    /** @brief Draw the records up to stamp_ns, as many as the history length. */
+    void drawTimeline(int64_t stamp_ns)
+    {
+        RVIZ_LEGGED_TRACE_SCOPE("drawTimeline", Policy::kTraceCategory);
+
+        auto index = timeline_store_.seek(stamp_ns);
+        size_t count = index ? std::min(*index + 1, history_length_) : 0;
+
+        // The slots without a record are hidden, then the records are drawn from the oldest.
+        for (size_t k = count; k < history_length_; k++) {
+            claimSlot(0);
+        }
+        for (size_t k = 0; k < count; k++) {
+            renderRecord(timeline_store_.record(*index + 1 - count + k));
+        }
+        this->context_->queueRender();
+    }
+
+    void updateTimelineSpill()
+    {
+        timeline_spill_error_.clear();
+        auto directory = timeline_spill_property_->getStdString();
+        if (directory.empty()) {
+            timeline_store_.closeSpill();
+        } else {
+            timeline_store_.openSpill(directory, timeline_spill_error_);
+        }
+        updateTimelineStatus();
+    }
+
+    void updateTimelineStatus()
+    {
+        if (!timeline_spill_error_.empty()) {
+            this->setStatus(
+                rviz_common::properties::StatusProperty::Error, "Timeline",
+                QString::fromStdString(timeline_spill_error_));
+            return;
+        }
+        if (timeline_store_.memoryLimit() == 0) {
+            this->deleteStatus("Timeline");
+            return;
+        }
+        double duration = timeline_store_.empty() ? 0.0 :
+            1e-9 * static_cast<double>(timeline_store_.newestStamp() - timeline_store_.oldestStamp());
+        this->setStatus(
+            rviz_common::properties::StatusProperty::Ok, "Timeline",
+            QString("%1 messages over %2 s, %3 of %4 MiB%5")
+            .arg(timeline_store_.size())
+            .arg(duration, 0, 'f', 1)
+            .arg(static_cast<double>(timeline_store_.memoryUsage()) / (1 << 20), 0, 'f', 1)
+            .arg(timeline_store_.memoryLimit() >> 20)
+            .arg(
+                timeline_store_.isSpilling() ?
+                QString(", %1 MiB spilled").arg(
+                    static_cast<double>(timeline_store_.spilledBytes()) / (1 << 20), 0, 'f', 1) :
+                QString()));
+    }
+
+    void destroySlot(Slot & slot)
+    {
+        slot.instances.clear();
+        if (slot.node) {
+            this->scene_manager_->destroySceneNode(slot.node);
+            slot.node = nullptr;
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t newest_ = 0;
+    // Number of slots, and the number set by the display, which the frame budget may reduce.
+    size_t history_length_ = 1;
+    size_t requested_history_length_ = 1;
+
+    rviz_common::properties::IntProperty * expected_contacts_property_ = nullptr;
+    // Startup benchmark: from the construction of the display to the first frame drawing a message.
+    std::chrono::steady_clock::time_point initialized_at_ = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration prewarm_time_{};
+    std::chrono::steady_clock::duration startup_creation_time_{};
+    size_t startup_created_instances_ = 0;
+    bool first_message_drawn_ = false;
+    bool startup_reported_ = false;
+
+    std::vector<FrameTransform> resolved_frames_;
+    std::vector<FrameEntry> frame_batch_;
+
+    rviz_common::properties::EnumProperty * transform_policy_property_ = nullptr;
+    rviz_common::properties::FloatProperty * max_extrapolation_property_ = nullptr;
+    // Lookups since the last status.
+    uint32_t transform_lookups_ = 0;
+    uint32_t transform_fallbacks_ = 0;
+    uint32_t transform_extrapolations_ = 0;
+    // Time, in s, between the stamp of a message and its transform, after extrapolation.
+    double transform_max_lag_ = 0.0;
+
+    Style style_;
+    bool style_dirty_ = true;
+
+    common::TimelineStore timeline_store_;
+
+    // Defers the messages received while the content is outside the view.
+    common::VisibilityGate visibility_gate_;
+    rviz_common::properties::IntProperty * timeline_memory_property_ = nullptr;
+    rviz_common::properties::StringProperty * timeline_spill_property_ = nullptr;
+    std::string timeline_spill_error_;
+    uint64_t timeline_revision_ = 0;
+    float time_since_status_ = 0.0f;
+
+    rviz_common::properties::FloatProperty * frame_budget_property_ = nullptr;
+    common::FrameBudget::Level frame_budget_level_ = common::FrameBudget::FULL_QUALITY;
+    uint64_t frame_budget_revision_ = 0;
+};
+
+}  // namespace rviz_legged_plugins::displays
@@ -30,30 +30,41 @@
 #pragma once
 
 #include <memory>
-#include <deque>
+#include <vector>
 
+#include <OgreVector3.h>
+
+#include "rclcpp/subscription.hpp"
+
+#include "rviz_legged_msgs/msg/wrenches_packed.hpp"
 #include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
 
-#include "rviz_common/message_filter_display.hpp"
+#include "rviz_legged_plugins/common/colormap.hpp"
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/frame_monitor.hpp"
+#include "rviz_legged_plugins/common/transform_filter.hpp"
+#include "rviz_legged_plugins/common/wrench_arrow_material.hpp"
+#include "rviz_legged_plugins/displays/buffered_contact_display.hpp"
+#include "rviz_legged_plugins/type_adapters/eigen_wrenches.hpp"
+
 #include "rviz_default_plugins/visibility_control.hpp"
 
 namespace Ogre
 {
+class ManualObject;
 class SceneNode;
 }
 
-namespace rviz_rendering
-{
-class WrenchVisual;
-}
-
 namespace rviz_common
 {
 namespace properties
 {
+class BoolProperty;
 class ColorProperty;
+class EnumProperty;
 class FloatProperty;
 class IntProperty;
+class RosTopicProperty;
 }
 }
 
@@ -62,9 +73,49 @@ namespace rviz_legged_plugins
 namespace displays
 {
 
+/**
+ * \struct ExternalWrenchPolicy
+ * \brief Instances and style of the ExternalWrenchDisplay.
+ */
+struct ExternalWrenchPolicy
+{
+    /**
+     * Arrows of a wrench, drawn as a line list with the material of the display, and the wrench
+     * they are bounded by.
+     */
+    struct Instance
+    {
+        explicit Instance(Ogre::ManualObject * manual_object)
+        : manual_object(manual_object) {}
+
+        ~Instance();
+
+        Instance(const Instance &) = delete;
+        Instance & operator=(const Instance &) = delete;
+
+        Ogre::ManualObject * manual_object;
+        Ogre::Vector3 position = Ogre::Vector3::ZERO;
+        common::WrenchSample sample;
+    };
+
+    // Every other style property is a parameter of the arrow material, applied when it changes.
+    struct Style
+    {
+        bool accept_nan;
+    };
+
+    static void setVisible(Instance & instance, bool visible);
+
+    static constexpr const char * kTraceCategory = "ExternalWrench";
+    static constexpr const char * kMessageAgeCounter = "ExternalWrench message age [ms]";
+    // Position, force and torque of every wrench.
+    static constexpr size_t kTimelineColumns = 9;
+    // About eight minutes of the wrenches of four feet at 100 Hz.
+    static constexpr int kTimelineMemoryMiB = 16;
+};
 
 class RVIZ_DEFAULT_PLUGINS_PUBLIC ExternalWrenchDisplay : public
-    rviz_common::MessageFilterDisplay<rviz_legged_msgs::msg::WrenchesStamped>
+    BufferedContactDisplay<rviz_legged_msgs::msg::WrenchesStamped, ExternalWrenchPolicy>
 {
     Q_OBJECT
 
@@ -77,20 +128,65 @@ public:
 
     void reset() override;
 
+    void update(float wall_dt, float ros_dt) override;
+
     void processMessage(rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg) override;
 
+    /** @brief Process a packed message, received on the "Packed Topic". */
+    void processPackedMessage(rviz_legged_msgs::msg::WrenchesPacked::ConstSharedPtr msg);
+
+    /** @brief Process a type-adapted message, received on the "Intra-process Topic". */
+    void processAdaptedMessage(std::shared_ptr<const type_adapters::EigenWrenches> msg);
+
+protected:
+    void subscribe() override;
+
+    void unsubscribe() override;
+
+    void fixedFrameChanged() override;
+
+    std::unique_ptr<Instance> createInstance(Ogre::SceneNode * parent) override;
+
+    void readStyle(Style & style) const override;
+
+    void renderRecord(const common::TimelineStore::Record & record) override;
+
+    void applyFrameBudgetLevel(common::FrameBudget::Level level) override;
+
+    void prewarmInstance(Instance & instance) override;
+
 private
     Q_SLOTS:
-    void updateWrenchVisuals();
+    void updateArrowMaterial();
     void updateHistoryLength();
+    void updateColorMode();
+    void updatePackedTopic();
+    void updateAdaptedTopic();
 
 private:
-    std::shared_ptr<rviz_rendering::WrenchVisual> createWrenchVisual(
-        const geometry_msgs::msg::WrenchStamped & msg,
-        const Ogre::Quaternion & orientation,
-        const Ogre::Vector3 & position);
+    void subscribePacked();
+    void subscribeAdapted();
 
-    std::deque<std::shared_ptr<rviz_rendering::WrenchVisual>> visuals_;
+    /** @brief Record the wrenches gathered in the scratch buffers, and draw them unless scrubbing. */
+    void recordAndDrawWrenches(const builtin_interfaces::msg::Time & stamp);
+
+    /** @brief Draw the wrenches of the message, gathered in the scratch buffers, in a new slot. */
+    void addWrenchVisuals();
+
+    /** @brief Write the arrows of the wrench of an instance. */
+    void drawWrench(Instance & instance, const common::WrenchArrowMaterial::Ranges & ranges);
+
+    // Wrenches of the message being processed, in the fixed frame, reused across messages.
+    std::vector<common::WrenchSample> message_samples_;
+    std::vector<Ogre::Vector3> message_positions_;
+
+    // Created on initialization, once the material scripts are loaded.
+    std::unique_ptr<common::WrenchArrowMaterial> arrow_material_;
+
+    // Scales the bounds of the arrows are computed for. They are doubled when the scale properties
+    // outgrow them, hence growing a scale rarely updates the bounds of every instance.
+    float bounds_force_scale_ = 0.0f;
+    float bounds_torque_scale_ = 0.0f;
 
     rviz_common::properties::BoolProperty * arrow_head_as_reference_;
     rviz_common::properties::BoolProperty * accept_nan_values_;
@@ -99,10 +195,25 @@ private:
     rviz_common::properties::FloatProperty * alpha_property_;
     rviz_common::properties::FloatProperty * force_scale_property_;
     rviz_common::properties::FloatProperty * torque_scale_property_;
-    rviz_common::properties::FloatProperty * width_property_;
     rviz_common::properties::IntProperty * history_length_property_;
-
-    int n_wrenches_ = 1;
+    rviz_common::properties::EnumProperty * force_color_mode_property_;
+    rviz_common::properties::EnumProperty * colormap_property_;
+    rviz_common::properties::BoolProperty * auto_range_property_;
+    rviz_common::properties::FloatProperty * range_min_property_;
+    rviz_common::properties::FloatProperty * range_max_property_;
+    rviz_common::properties::RosTopicProperty * packed_topic_property_;
+    rviz_common::properties::RosTopicProperty * adapted_topic_property_;
+
+    rclcpp::Subscription<rviz_legged_msgs::msg::WrenchesPacked>::SharedPtr packed_subscription_;
+    common::TransformFilter<rviz_legged_msgs::msg::WrenchesPacked> packed_filter_;
+    uint32_t packed_messages_received_ = 0;
+
+    rclcpp::Subscription<type_adapters::EigenWrenches>::SharedPtr adapted_subscription_;
+    common::TransformFilter<type_adapters::EigenWrenches> adapted_filter_;
+    uint32_t adapted_messages_received_ = 0;
+
+    // Marks the render frames in the trace, held while the display is initialized.
+    std::shared_ptr<common::FrameMonitor> frame_monitor_;
 };
 
 }   // namespace displays
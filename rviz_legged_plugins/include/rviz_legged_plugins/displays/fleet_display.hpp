@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <regex>
+#include <set>
+#include <string>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreColourValue.h>
+#include <OgreManualObject.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rosidl_runtime_cpp/traits.hpp"
+
+#include "rviz_common/display.hpp"
+#include "rviz_common/display_context.hpp"
+#include "rviz_common/frame_manager_iface.hpp"
+#include "rviz_common/properties/bool_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+#include "rviz_common/properties/property.hpp"
+#include "rviz_common/properties/status_property.hpp"
+#include "rviz_common/properties/string_property.hpp"
+#include "rviz_common/ros_integration/ros_node_abstraction_iface.hpp"
+
+#include "rviz_legged_plugins/common/frame_monitor.hpp"
+#include "rviz_legged_plugins/common/topic_pattern.hpp"
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
+#include "rviz_legged_plugins/common/transform_filter.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+/**
+ * \class FleetDisplay
+ * \brief Base of the displays drawing a fleet of robots, one topic per robot, with one display.
+ *
+ * Every MessageType topic matching the "Topic Pattern", a glob in which * matches any part of one
+ * name level, is subscribed to, the ROS graph being searched again every "Discovery Period". The
+ * messages of each robot wait for the transform at their stamp in their own filter, then are
+ * passed to processMessage() with the data of the robot.
+ *
+ * After messages or style changes, redraw() is called once on the next frame and draws all the
+ * robots in the single ManualObject of the display, with one material, so that the rendering cost
+ * of a robot is its vertices rather than its own scene objects. Its section is updated in place,
+ * between beginDraw() and endDraw().
+ *
+ * RobotData holds what is drawn for one robot and provides clear().
+ * The template does not declare Q_OBJECT; the concrete displays declare their own slots.
+ */
+template<typename MessageType, typename RobotData>
+class FleetDisplay : public rviz_common::Display
+{
+public:
+    /** \struct Robot \brief Subscription and data of one robot. */
+    struct Robot
+    {
+        // Declared first, to be destroyed after the subscription feeding it.
+        common::TransformFilter<MessageType> filter;
+        typename rclcpp::Subscription<MessageType>::SharedPtr subscription;
+        RobotData data;
+        uint32_t messages_received = 0;
+    };
+
+    FleetDisplay(const QString & default_pattern, const char * trace_category)
+    : trace_category_(trace_category)
+    {
+        topic_pattern_property_ = new rviz_common::properties::StringProperty(
+            "Topic Pattern", default_pattern,
+            "Topics to subscribe to, one per robot. * matches any part of a name level and ? a single "
+            "character.",
+            this);
+        QObject::connect(
+            topic_pattern_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {updateTopicPattern();});
+
+        discovery_period_property_ = new rviz_common::properties::FloatProperty(
+            "Discovery Period", 1.0f,
+            "Period, in s, at which the ROS graph is searched for new or removed matching topics.",
+            this);
+        discovery_period_property_->setMin(0.1f);
+
+        color_by_robot_property_ = new rviz_common::properties::BoolProperty(
+            "Color by Robot", false,
+            "Draw each robot with its own hue instead of the color of the display.", this);
+        QObject::connect(
+            color_by_robot_property_, &rviz_common::properties::Property::changed, this,
+            [this]() {markDirty();});
+    }
+
+    ~FleetDisplay() override
+    {
+        robots_.clear();
+        if (manual_object_) {
+            scene_manager_->destroyManualObject(manual_object_);
+        }
+    }
+
+    /** @brief Overridden from Display. */
+    void reset() override
+    {
+        Display::reset();
+        for (auto & [topic, robot] : robots_) {
+            robot.data.clear();
+        }
+        markDirty();
+    }
+
+    /** @brief Overridden from Display. */
+    void update(float wall_dt, float ros_dt) override
+    {
+        (void) ros_dt;
+
+        time_since_discovery_ += wall_dt;
+        if (time_since_discovery_ >= discovery_period_property_->getFloat()) {
+            time_since_discovery_ = 0.0f;
+            discoverTopics();
+        }
+
+        // All the messages received since the last frame are drawn at once.
+        if (dirty_) {
+            draw();
+        }
+    }
+
+protected:
+    /** @brief Overridden from Display. */
+    void onInitialize() override
+    {
+        Display::onInitialize();
+        frame_monitor_ = common::FrameMonitor::acquire();
+
+        manual_object_ = scene_manager_->createManualObject();
+        manual_object_->setDynamic(true);
+        scene_node_->attachObject(manual_object_);
+
+        topic_regex_ = common::globToRegex(topic_pattern_property_->getStdString());
+    }
+
+    /** @brief Overridden from Display. */
+    void onEnable() override
+    {
+        time_since_discovery_ = 0.0f;
+        discoverTopics();
+    }
+
+    /** @brief Overridden from Display. */
+    void onDisable() override
+    {
+        robots_.clear();
+        deleteStatus("Fleet");
+        draw();
+    }
+
+    /** @brief Overridden from Display. */
+    void fixedFrameChanged() override
+    {
+        for (auto & [topic, robot] : robots_) {
+            robot.filter.setTargetFrame(fixed_frame_.toStdString());
+        }
+        reset();
+    }
+
+    /** @brief Read a message of a robot into its data. */
+    virtual void processMessage(
+        const std::string & topic, RobotData & robot, typename MessageType::ConstSharedPtr msg) = 0;
+
+    /** @brief Draw the data of all the robots, between beginDraw() and endDraw(). */
+    virtual void redraw() = 0;
+
+    /** @brief Redraw the robots on the next frame. */
+    void markDirty()
+    {
+        dirty_ = true;
+        context_->queueRender();
+    }
+
+    /**
+     * @brief Start updating the section of the ManualObject with vertex_count vertices.
+     *
+     * The section is created by the first draw, then updated in place, keeping its vertex buffer
+     * when it is large enough.
+     */
+    void beginDraw(
+        const std::string & material_name, Ogre::RenderOperation::OperationType operation,
+        size_t vertex_count)
+    {
+        manual_object_->estimateVertexCount(vertex_count);
+        if (manual_object_->getNumSections() == 0) {
+            manual_object_->begin(material_name, operation, "rviz_rendering");
+        } else {
+            manual_object_->getSection(0)->setMaterialName(material_name, "rviz_rendering");
+            manual_object_->beginUpdate(0);
+        }
+    }
+
+    /** @brief End the section, an update only growing the bounds of the ManualObject. */
+    void endDraw(const Ogre::AxisAlignedBox & bounds)
+    {
+        manual_object_->end();
+        manual_object_->setBoundingBox(bounds);
+    }
+
+    /** @brief Empty the section, keeping its vertex buffer for the next draws. */
+    void clearDraw()
+    {
+        if (manual_object_->getNumSections() > 0) {
+            manual_object_->beginUpdate(0);
+            manual_object_->end();
+            manual_object_->setBoundingBox(Ogre::AxisAlignedBox::BOX_NULL);
+        }
+    }
+
+    /** @brief Color of the robot of the given index when "Color by Robot" is enabled, else color. */
+    Ogre::ColourValue robotColor(size_t robot_index, const Ogre::ColourValue & color) const
+    {
+        if (!color_by_robot_property_->getBool()) {
+            return color;
+        }
+        // Hues spread with the golden ratio stay distinct whatever the number of robots.
+        Ogre::ColourValue robot_color;
+        robot_color.setHSB(std::fmod(0.618034f * static_cast<float>(robot_index), 1.0f), 0.8f, 0.9f);
+        robot_color.a = color.a;
+        return robot_color;
+    }
+
+    /** @brief Set the status of a robot, named after its topic. */
+    void setRobotStatus(
+        rviz_common::properties::StatusProperty::Level level, const std::string & topic,
+        const std::string & text)
+    {
+        setStatus(level, QString::fromStdString(topic), QString::fromStdString(text));
+    }
+
+    void deleteRobotStatus(const std::string & topic) {deleteStatus(QString::fromStdString(topic));}
+
+    // Robots by topic name.
+    std::map<std::string, Robot> robots_;
+
+    // Draws all the robots, in one section.
+    Ogre::ManualObject * manual_object_ = nullptr;
+
+private:
+    // Messages of a robot held while waiting for their transform, as the default of
+    // MessageFilterDisplay.
+    static constexpr uint32_t kFilterSize = 10;
+
+    void updateTopicPattern()
+    {
+        topic_regex_ = common::globToRegex(topic_pattern_property_->getStdString());
+
+        // Robots that no longer match are dropped and new ones subscribed at once.
+        if (isEnabled()) {
+            time_since_discovery_ = 0.0f;
+            discoverTopics();
+        }
+    }
+
+    void discoverTopics()
+    {
+        RVIZ_LEGGED_TRACE_SCOPE("discoverTopics", trace_category_);
+
+        auto node = context_->getRosNodeAbstraction().lock()->get_raw_node();
+        const std::string type = rosidl_generator_traits::name<MessageType>();
+
+        std::set<std::string> matching_topics;
+        for (const auto & [topic, types] : node->get_topic_names_and_types()) {
+            if (std::find(types.begin(), types.end(), type) != types.end() &&
+                std::regex_match(topic, topic_regex_))
+            {
+                matching_topics.insert(topic);
+            }
+        }
+
+        for (auto it = robots_.begin(); it != robots_.end(); ) {
+            if (matching_topics.count(it->first) == 0) {
+                deleteRobotStatus(it->first);
+                it = robots_.erase(it);
+                dirty_ = true;
+            } else {
+                ++it;
+            }
+        }
+
+        for (const auto & topic : matching_topics) {
+            if (robots_.count(topic) > 0) {
+                continue;
+            }
+
+            // The messages wait for the transform at their stamp, as in a MessageFilterDisplay.
+            auto & robot = robots_[topic];
+            robot.filter = common::TransformFilter<MessageType>(
+                [this, topic](typename MessageType::ConstSharedPtr msg) {
+                    receiveMessage(topic, msg);
+                });
+            robot.filter.reset(
+                *context_->getFrameManager()->getTransformer(), fixed_frame_.toStdString(), kFilterSize,
+                node);
+
+            // Best effort subscriptions are compatible with both reliable and best effort publishers.
+            robot.subscription = node->template create_subscription<MessageType>(
+                topic, rclcpp::SensorDataQoS(),
+                [filter = &robot.filter](typename MessageType::ConstSharedPtr msg) {
+                    filter->add(msg);
+                });
+        }
+
+        setStatus(
+            rviz_common::properties::StatusProperty::Ok, "Fleet",
+            QString::number(robots_.size()) + " robots");
+    }
+
+    void receiveMessage(const std::string & topic, typename MessageType::ConstSharedPtr msg)
+    {
+        RVIZ_LEGGED_TRACE_SCOPE("processMessage", trace_category_);
+
+        auto it = robots_.find(topic);
+        if (it == robots_.end()) {
+            return;
+        }
+        it->second.messages_received++;
+        processMessage(topic, it->second.data, msg);
+        markDirty();
+    }
+
+    void draw()
+    {
+        RVIZ_LEGGED_TRACE_SCOPE("redraw", trace_category_);
+
+        dirty_ = false;
+        if (!manual_object_) {
+            return;
+        }
+        redraw();
+        context_->queueRender();
+    }
+
+    const char * trace_category_;
+
+    std::regex topic_regex_;
+    float time_since_discovery_ = 0.0f;
+    bool dirty_ = false;
+
+    // Marks the render frames in the trace, held while the display is initialized.
+    std::shared_ptr<common::FrameMonitor> frame_monitor_;
+
+    rviz_common::properties::StringProperty * topic_pattern_property_;
+    rviz_common::properties::FloatProperty * discovery_period_property_;
+    rviz_common::properties::BoolProperty * color_by_robot_property_;
+};
+
+}  // namespace rviz_legged_plugins::displays
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rviz_legged_msgs/msg/friction_cones.hpp"
+
+#include "rviz_default_plugins/visibility_control.hpp"
+
+#include "rviz_legged_plugins/common/material_cache.hpp"
+#include "rviz_legged_plugins/displays/fleet_display.hpp"
+
+namespace rviz_common::properties
+{
+class ColorProperty;
+class FloatProperty;
+}  // namespace rviz_common::properties
+
+namespace rviz_legged_plugins::displays
+{
+/** Friction cones of one robot of a fleet, their contact points expressed in the fixed frame. */
+struct FleetFrictionCones
+{
+    std::vector<Ogre::Vector3> positions;
+    std::vector<Ogre::Vector3> normals;
+    std::vector<float> friction_coefficients;
+
+    void clear()
+    {
+        positions.clear();
+        normals.clear();
+        friction_coefficients.clear();
+    }
+};
+
+/**
+ * \class FleetFrictionConesDisplay
+ * \brief Displays the friction cones of a fleet of robots with a single display.
+ *
+ * The last friction cones of all the robots matching the "Topic Pattern" are drawn as coarse cone
+ * meshes, with the sides of common::coarseConeMesh(), all in one triangle list.
+ */
+class RVIZ_DEFAULT_PLUGINS_PUBLIC FleetFrictionConesDisplay
+    : public FleetDisplay<rviz_legged_msgs::msg::FrictionCones, FleetFrictionCones>
+{
+    Q_OBJECT
+
+public:
+    FleetFrictionConesDisplay();
+
+protected:
+    /** @brief Overridden from FleetDisplay. */
+    void processMessage(
+        const std::string & topic, FleetFrictionCones & robot,
+        rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg) override;
+
+    /** @brief Overridden from FleetDisplay. */
+    void redraw() override;
+
+private Q_SLOTS:
+    void updateStyle();
+
+private:
+    common::MaterialCache::Handle material_;
+
+    rviz_common::properties::ColorProperty * color_property_;
+    rviz_common::properties::FloatProperty * alpha_property_;
+    rviz_common::properties::FloatProperty * cone_height_property_;
+};
+
+}  // namespace rviz_legged_plugins::displays
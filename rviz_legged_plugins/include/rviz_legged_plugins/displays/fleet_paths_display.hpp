@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rviz_legged_msgs/msg/paths.hpp"
+
+#include "rviz_default_plugins/visibility_control.hpp"
+
+#include "rviz_legged_plugins/common/material_cache.hpp"
+#include "rviz_legged_plugins/displays/fleet_display.hpp"
+
+namespace rviz_common::properties
+{
+class ColorProperty;
+class FloatProperty;
+}  // namespace rviz_common::properties
+
+namespace rviz_legged_plugins::displays
+{
+/** Paths of one robot of a fleet, expressed in the fixed frame. */
+struct FleetPaths
+{
+    // Positions of all the paths, one after the other.
+    std::vector<Ogre::Vector3> positions;
+    // End of each path in positions.
+    std::vector<size_t> path_ends;
+
+    void clear()
+    {
+        positions.clear();
+        path_ends.clear();
+    }
+};
+
+/**
+ * \class FleetPathsDisplay
+ * \brief Displays the paths of a fleet of robots with a single display.
+ *
+ * The last paths of all the robots matching the "Topic Pattern" are drawn as lines.
+ */
+class RVIZ_DEFAULT_PLUGINS_PUBLIC FleetPathsDisplay
+    : public FleetDisplay<rviz_legged_msgs::msg::Paths, FleetPaths>
+{
+    Q_OBJECT
+
+public:
+    FleetPathsDisplay();
+
+protected:
+    /** @brief Overridden from FleetDisplay. */
+    void processMessage(
+        const std::string & topic, FleetPaths & robot,
+        rviz_legged_msgs::msg::Paths::ConstSharedPtr msg) override;
+
+    /** @brief Overridden from FleetDisplay. */
+    void redraw() override;
+
+private Q_SLOTS:
+    void updateStyle();
+
+private:
+    common::MaterialCache::Handle material_;
+
+    // Positions of the path being read, reused across messages.
+    std::vector<Ogre::Vector3> path_positions_;
+
+    rviz_common::properties::ColorProperty * color_property_;
+    rviz_common::properties::FloatProperty * alpha_property_;
+};
+
+}  // namespace rviz_legged_plugins::displays
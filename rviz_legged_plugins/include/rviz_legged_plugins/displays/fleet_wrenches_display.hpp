@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+#include "rviz_default_plugins/visibility_control.hpp"
+
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/material_cache.hpp"
+#include "rviz_legged_plugins/displays/fleet_display.hpp"
+
+namespace rviz_common::properties
+{
+class ColorProperty;
+class FloatProperty;
+}  // namespace rviz_common::properties
+
+namespace rviz_legged_plugins::displays
+{
+/** Contact wrenches of one robot of a fleet, expressed in the fixed frame. */
+struct FleetWrenches
+{
+    std::vector<Ogre::Vector3> positions;
+    std::vector<common::WrenchSample> wrenches;
+
+    void clear()
+    {
+        positions.clear();
+        wrenches.clear();
+    }
+};
+
+/**
+ * \class FleetWrenchesDisplay
+ * \brief Displays the contact wrenches of a fleet of robots with a single display.
+ *
+ * The last wrenches of all the robots matching the "Topic Pattern" are drawn as line arrows.
+ */
+class RVIZ_DEFAULT_PLUGINS_PUBLIC FleetWrenchesDisplay
+    : public FleetDisplay<rviz_legged_msgs::msg::WrenchesStamped, FleetWrenches>
+{
+    Q_OBJECT
+
+public:
+    FleetWrenchesDisplay();
+
+protected:
+    /** @brief Overridden from FleetDisplay. */
+    void processMessage(
+        const std::string & topic, FleetWrenches & robot,
+        rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg) override;
+
+    /** @brief Overridden from FleetDisplay. */
+    void redraw() override;
+
+private Q_SLOTS:
+    void updateStyle();
+
+private:
+    common::MaterialCache::Handle material_;
+
+    rviz_common::properties::ColorProperty * force_color_property_;
+    rviz_common::properties::ColorProperty * torque_color_property_;
+    rviz_common::properties::FloatProperty * alpha_property_;
+    rviz_common::properties::FloatProperty * force_scale_property_;
+    rviz_common::properties::FloatProperty * torque_scale_property_;
+};
+
+}  // namespace rviz_legged_plugins::displays
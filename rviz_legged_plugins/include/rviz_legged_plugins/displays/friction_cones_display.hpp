@@ -29,28 +29,39 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 
-#include "rviz_legged_msgs/msg/friction_cones.hpp"
+#include <OgreEntity.h>
+#include <OgreSceneManager.h>
+#include <OgreVector3.h>
+
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/time.hpp"
 
-#include "rviz_common/message_filter_display.hpp"
+#include "rviz_legged_msgs/msg/friction_cones.hpp"
+#include "rviz_legged_msgs/msg/friction_cones_packed.hpp"
 
 #include "rviz_default_plugins/visibility_control.hpp"
 
-namespace rviz_rendering
-{
-class Shape;
-}  // namespace rviz_rendering
+#include "rviz_legged_plugins/common/age_fade_material.hpp"
+#include "rviz_legged_plugins/common/frame_monitor.hpp"
+#include "rviz_legged_plugins/common/material_cache.hpp"
+#include "rviz_legged_plugins/common/transform_filter.hpp"
+#include "rviz_legged_plugins/displays/buffered_contact_display.hpp"
 
 namespace rviz_common
 {
 class QueueSizeProperty;
 namespace properties
 {
+class BoolProperty;
 class ColorProperty;
 class FloatProperty;
 class IntProperty;
+class RosTopicProperty;
 }  // namespace properties
 }  // namespace rviz_common
 
@@ -59,12 +70,82 @@ namespace rviz_legged_plugins
 {
 namespace displays
 {
+/**
+ * \struct FrictionConesPolicy
+ * \brief Instances and style of the FrictionConesDisplay.
+ */
+struct FrictionConesPolicy
+{
+    /** Mesh of the cones, that of the cone shape of rviz_rendering. */
+    static constexpr const char * kConeMesh = "rviz_cone.mesh";
+
+    /**
+     * Cone of a contact, and the offset of its center from the contact point.
+     *
+     * The cone is an entity of the shared cone mesh, whose material is set by the display, rather
+     * than a shape with a material of its own.
+     */
+    struct Instance
+    {
+        Instance(Ogre::SceneManager * scene_manager, Ogre::SceneNode * parent)
+        : scene_manager(scene_manager),
+          node(parent->createChildSceneNode()),
+          entity(scene_manager->createEntity(kConeMesh))
+        {
+            node->attachObject(entity);
+        }
+
+        ~Instance()
+        {
+            scene_manager->destroyEntity(entity);
+            if (coarse_entity) {
+                scene_manager->destroyEntity(coarse_entity);
+            }
+            scene_manager->destroySceneNode(node);
+        }
+
+        Ogre::SceneManager * scene_manager;
+        Ogre::SceneNode * node;
+        Ogre::Entity * entity;
+        Ogre::Vector3 offset = Ogre::Vector3::ZERO;
+        // Stamp of the message of the cone, from which it fades.
+        rclcpp::Time stamp;
+
+        // Coarse cone drawn instead of the cone while the frame budget reduces the cone detail,
+        // created on first use.
+        Ogre::Entity * coarse_entity = nullptr;
+        bool coarse = false;
+        bool visible = true;
+    };
+
+    struct Style
+    {
+        float height;
+    };
+
+    static void setVisible(Instance & instance, bool visible)
+    {
+        instance.visible = visible;
+        instance.entity->setVisible(visible && !instance.coarse);
+        if (instance.coarse_entity) {
+            instance.coarse_entity->setVisible(visible && instance.coarse);
+        }
+    }
+
+    static constexpr const char * kTraceCategory = "FrictionCones";
+    static constexpr const char * kMessageAgeCounter = "FrictionCones message age [ms]";
+    // Contact point, normal direction and friction coefficient of every cone.
+    static constexpr size_t kTimelineColumns = 7;
+    // About ten minutes of the cones of four feet at 100 Hz.
+    static constexpr int kTimelineMemoryMiB = 16;
+};
+
 /**
  * \class FrictionConesDisplay
  * \brief Displays a the friction cones of the feet in contact with the terrain.
  */
 class RVIZ_DEFAULT_PLUGINS_PUBLIC FrictionConesDisplay : public
-    rviz_common::MessageFilterDisplay<rviz_legged_msgs::msg::FrictionCones>
+    BufferedContactDisplay<rviz_legged_msgs::msg::FrictionCones, FrictionConesPolicy>
 {
     Q_OBJECT
 
@@ -79,27 +160,102 @@ public:
 
     void reset() override;
 
+    void update(float wall_dt, float ros_dt) override;
+
     void processMessage(rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg) override;
 
+    /** @brief Process a packed message, received on the "Packed Topic". */
+    void processPackedMessage(rviz_legged_msgs::msg::FrictionConesPacked::ConstSharedPtr msg);
+
 protected:
     void onInitialize() override;
 
+    void subscribe() override;
+
+    void unsubscribe() override;
+
+    void fixedFrameChanged() override;
+
+    std::unique_ptr<Instance> createInstance(Ogre::SceneNode * parent) override;
+
+    void readStyle(Style & style) const override;
+
+    void renderRecord(const common::TimelineStore::Record & record) override;
+
+    void applyFrameBudgetLevel(common::FrameBudget::Level level) override;
+
 private Q_SLOTS:
     void updateBufferLength();
     void updateColorAndAlpha();
+    void updateFadeDuration();
+    void updatePackedTopic();
+    void resetDuplicateDetection();
 
 private:
-    int number_cones_ = 1;
+    void subscribePacked();
+
+    /** @brief Whether a message has the same content as the last one processed in full. */
+    bool isDuplicate(uint64_t hash) const;
+
+    /**
+     * @brief Record the cones gathered in the scratch buffers and, unless scrubbing, draw them.
+     *
+     * A message identical to the last one drawn only moves the newest cones.
+     */
+    void addCones(const builtin_interfaces::msg::Time & stamp, uint64_t hash);
+
+    /** @brief Draw the cones gathered in the scratch buffers in a new slot. */
+    void drawCones(const rclcpp::Time & stamp);
+
+    void updateCone(
+        Instance & instance, const Ogre::Vector3 & position,
+        const Ogre::Vector3 & normal_direction, double friction_coefficient);
 
-    float getDisplayedRange(rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg);
-    geometry_msgs::msg::Pose getPose(/*float displayed_range*/);
+    /** @brief Move the cones of the newest message, keeping their geometry, to new positions. */
+    void placeNewestCones();
 
-    std::vector<std::shared_ptr<rviz_rendering::Shape>> cones_;
+    /** @brief Draw an instance with the coarse cone mesh, or with the cone mesh. */
+    void setConeDetail(Instance & instance, bool coarse);
+
+    bool isFading() const;
+
+    /** @brief Material of the cones: the fade material while fading, the shared one otherwise. */
+    const Ogre::MaterialPtr & coneMaterial() const;
+
+    /** @brief Bind the cone material to all the cones, e.g. when the fading changes. */
+    void bindConeMaterial();
+
+    /** @brief Pass the stamp of an instance to the fade material. */
+    void stampCone(Instance & instance);
+
+    // Material of all the cones, which are destroyed by the destructor before it.
+    common::MaterialCache::Handle cone_material_;
+    // Material of the cones when they fade with their age, created on demand.
+    std::unique_ptr<common::AgeFadeMaterial> fade_material_;
+
+    // Cones of the message being processed, the contact points in the fixed frame.
+    std::vector<Ogre::Vector3> message_positions_;
+    std::vector<Ogre::Vector3> message_normals_;
+    std::vector<float> message_friction_coefficients_;
 
     rviz_common::properties::FloatProperty * height_property_;
     rviz_common::properties::ColorProperty * color_property_;
     rviz_common::properties::FloatProperty * alpha_property_;
     rviz_common::properties::IntProperty * buffer_length_property_;
+    rviz_common::properties::FloatProperty * fade_duration_property_;
+    rviz_common::properties::RosTopicProperty * packed_topic_property_;
+    rviz_common::properties::BoolProperty * skip_duplicates_property_;
+    rviz_common::properties::BoolProperty * ignore_stamps_property_;
+
+    // Content hash of the last message processed in full, unset when the cones must be rebuilt.
+    std::optional<uint64_t> last_message_hash_;
+
+    rclcpp::Subscription<rviz_legged_msgs::msg::FrictionConesPacked>::SharedPtr packed_subscription_;
+    common::TransformFilter<rviz_legged_msgs::msg::FrictionConesPacked> packed_filter_;
+    uint32_t packed_messages_received_ = 0;
+
+    // Marks the render frames in the trace, held while the display is initialized.
+    std::shared_ptr<common::FrameMonitor> frame_monitor_;
 };
 
 }  // namespace displays
@@ -30,41 +30,141 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
-#include "rviz_legged_msgs/msg/paths.hpp"
+#include <OgreAxisAlignedBox.h>
+#include <OgreColourValue.h>
+
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/subscription.hpp"
+#include "std_msgs/msg/float64_multi_array.hpp"
 
-#include "rviz_common/message_filter_display.hpp"
+#include "rviz_legged_msgs/msg/paths.hpp"
 
-#include "rviz_rendering/objects/arrow.hpp"
-#include "rviz_rendering/objects/axes.hpp"
 #include "rviz_rendering/objects/billboard_line.hpp"
 
 #include "rviz_default_plugins/visibility_control.hpp"
 
+#include "rviz_legged_plugins/common/age_fade_material.hpp"
+#include "rviz_legged_plugins/common/colormap.hpp"
+#include "rviz_legged_plugins/common/frame_monitor.hpp"
+#include "rviz_legged_plugins/common/material_cache.hpp"
+#include "rviz_legged_plugins/common/pose_marker_material.hpp"
+#include "rviz_legged_plugins/common/terrain_shadow_material.hpp"
+#include "rviz_legged_plugins/common/trail_buffer.hpp"
+#include "rviz_legged_plugins/common/transform_filter.hpp"
+#include "rviz_legged_plugins/displays/buffered_contact_display.hpp"
+#include "rviz_legged_plugins/type_adapters/eigen_paths.hpp"
+
 namespace Ogre
 {
 class ManualObject;
+class SceneNode;
 }
 
 namespace rviz_common::properties
 {
+class BoolProperty;
 class ColorProperty;
 class FloatProperty;
 class IntProperty;
 class EnumProperty;
+class RosTopicProperty;
+class TfFrameProperty;
 class VectorProperty;
 }  // namespace rviz_common
 
 namespace rviz_legged_plugins::displays
 {
+/**
+ * \struct PathsPolicy
+ * \brief Instances and style of the PathsDisplay.
+ */
+struct PathsPolicy
+{
+    enum LineStyle
+    {
+        LINES,
+        BILLBOARDS
+    };
+
+    enum PoseStyle
+    {
+        NONE,
+        AXES,
+        ARROWS,
+    };
+
+    enum ColorMode
+    {
+        FLAT,
+        TIME_ALONG_HORIZON,
+        SPEED
+    };
+
+    /** Line of a path, of the Line Style it was created with, and its pose markers. */
+    struct Instance
+    {
+        explicit Instance(Ogre::SceneNode * parent)
+        : parent(parent) {}
+
+        ~Instance();
+
+        Instance(const Instance &) = delete;
+        Instance & operator=(const Instance &) = delete;
+
+        Ogre::SceneNode * parent;
+        Ogre::ManualObject * manual_object = nullptr;
+        std::unique_ptr<rviz_rendering::BillboardLine> billboard_line;
+        // Pose arrows or axes, drawn with the pose marker material, and the box of their poses.
+        Ogre::ManualObject * markers = nullptr;
+        Ogre::AxisAlignedBox marker_positions;
+    };
+
+    struct Style
+    {
+        LineStyle line_style;
+        float line_width;
+        ColorMode color_mode;
+        common::Colormap colormap;
+        bool auto_range;
+        float range_min;
+        float range_max;
+        // Color of the Flat mode, with the alpha of all the modes.
+        Ogre::ColourValue color;
+        PoseStyle pose_style;
+        float axes_length;
+        float axes_radius;
+        float arrow_shaft_length;
+        float arrow_head_length;
+        float arrow_shaft_diameter;
+        float arrow_head_diameter;
+        // A pose marker every pose_stride poses, more than 1 when the frame budget is exceeded.
+        size_t pose_stride;
+    };
+
+    /** @brief Hidden paths are emptied. */
+    static void setVisible(Instance & instance, bool visible);
+
+    static constexpr const char * kTraceCategory = "Paths";
+    static constexpr const char * kMessageAgeCounter = "Paths message age [ms]";
+    // Position and orientation of every pose, its time along the horizon and the index of its
+    // path. The first row is the pose of the message frame, with a path index of -1.
+    static constexpr size_t kTimelineColumns = 9;
+    // About the last minute of the paths of four feet, of 50 poses each, at 100 Hz.
+    static constexpr int kTimelineMemoryMiB = 96;
+};
+
 /**
  * \class PathsDisplay
  * \brief Displays a nav_msgs::msg::Path message
  */
 class RVIZ_DEFAULT_PLUGINS_PUBLIC PathsDisplay : public
-    rviz_common::MessageFilterDisplay<rviz_legged_msgs::msg::Paths>
+    BufferedContactDisplay<rviz_legged_msgs::msg::Paths, PathsPolicy>
 {
     Q_OBJECT
 
@@ -78,64 +178,248 @@ public:
     /** @brief Overridden from Display. */
     void reset() override;
 
+    /** @brief Overridden from Display. */
+    void update(float wall_dt, float ros_dt) override;
+
     /** @brief Overridden from MessageFilterDisplay. */
     void processMessage(rviz_legged_msgs::msg::Paths::ConstSharedPtr msg) override;
 
+    /** @brief Process a type-adapted message, received on the "Intra-process Topic". */
+    void processAdaptedMessage(std::shared_ptr<const type_adapters::EigenPaths> msg);
+
+    /** @brief Process a serialized message, received on the "Serialized Topic". */
+    void processSerializedMessage(std::shared_ptr<const rclcpp::SerializedMessage> msg);
+
 protected:
     /** @brief Overridden from Display. */
     void onInitialize() override;
 
+    /** @brief Overridden from MessageFilterDisplay. */
+    void subscribe() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void unsubscribe() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void fixedFrameChanged() override;
+
+    /** @brief Overridden from BufferedContactDisplay. */
+    std::unique_ptr<Instance> createInstance(Ogre::SceneNode * parent) override;
+
+    /** @brief Overridden from BufferedContactDisplay. */
+    void readStyle(Style & style) const override;
+
+    /** @brief Overridden from BufferedContactDisplay. */
+    void renderRecord(const common::TimelineStore::Record & record) override;
+
+    void applyFrameBudgetLevel(common::FrameBudget::Level level) override;
+
+    /** @brief Overridden from BufferedContactDisplay. */
+    void prewarmInstance(Instance & instance) override;
+
 private Q_SLOTS:
     void updateBufferLength();
     void updateStyle();
+    void updateExpectedPathLength();
     void updateLineWidth();
     void updateOffset();
     void updatePoseStyle();
     void updatePoseAxisGeometry();
     void updatePoseArrowColor();
     void updatePoseArrowGeometry();
+    void updateAdaptedTopic();
+    void updateSerializedTopic();
+    void updateFadeDuration();
+    void updateColorMode();
+    void updateExecutedTrajectory();
+    void updateTerrainShadow();
+    void updateTerrainTopic();
+    void updateShadowAlpha();
+    void resetDuplicateDetection();
 
 private:
-    void destroyObjects();
-    void allocateArrowVector(std::vector<std::unique_ptr<rviz_rendering::Arrow>> & arrow_vect, size_t num);
-    void allocateAxesVector(std::vector<std::unique_ptr<rviz_rendering::Axes>> & axes_vect, size_t num);
-    void destroyPoseAxesChain();
-    void destroyPoseArrowChain();
-    void updateManualObject(
-        Ogre::ManualObject * manual_object, nav_msgs::msg::Path& msg,
-        const Ogre::Matrix4 & transform);
-    void updateBillBoardLine(
-        rviz_rendering::BillboardLine * billboard_line, nav_msgs::msg::Path& msg,
-        const Ogre::Matrix4 & transform);
-    void updatePoseMarkers(
-        size_t buffer_index, nav_msgs::msg::Path& msg, const Ogre::Matrix4 & transform);
-    void updateAxesMarkers(
-        std::vector<std::unique_ptr<rviz_rendering::Axes>> & axes_vect, nav_msgs::msg::Path& msg,
-        const Ogre::Matrix4 & transform);
-    void updateArrowMarkers(
-        std::vector<std::unique_ptr<rviz_rendering::Arrow>> & arrow_vect, nav_msgs::msg::Path& msg,
-        const Ogre::Matrix4 & transform);
-
-    int number_paths_ = 0;
-
-    std::vector<Ogre::ManualObject *> manual_objects_;
-    std::vector<std::unique_ptr<rviz_rendering::BillboardLine>> billboard_lines_;
-    std::vector<std::vector<std::unique_ptr<rviz_rendering::Axes>>> axes_chain_;
-    std::vector<std::vector<std::unique_ptr<rviz_rendering::Arrow>>> arrow_chain_;
-    Ogre::MaterialPtr lines_material_;
+    void subscribeAdapted();
+    void subscribeSerialized();
+    void subscribeTerrain();
+    void processTerrain(std_msgs::msg::Float64MultiArray::ConstSharedPtr msg);
+    bool isShadowing() const;
+    bool isFading() const;
+    /** @brief Whether a message has the same content as the last one processed in full. */
+    bool isDuplicate(uint64_t hash) const;
+
+    /** Paths of a timeline record, drawn as the paths of a message. */
+    struct RecordedPaths
+    {
+        struct Path
+        {
+            // Rows of the poses of the path in the record.
+            size_t begin;
+            size_t end;
+        };
+
+        std_msgs::msg::Header header;
+        common::TimelineStore::Record record;
+        std::vector<Path> paths;
+    };
+
+    /** Serialized message and its header, read ahead for the transform filter. */
+    struct SerializedPaths
+    {
+        std_msgs::msg::Header header;
+        std::shared_ptr<const rclcpp::SerializedMessage> message;
+    };
+
+    /** @brief Pass a serialized message to the transform filter, with its header. */
+    void addSerializedMessage(std::shared_ptr<const rclcpp::SerializedMessage> msg);
+
+    /**
+     * @brief Decode a serialized Paths message into decoded_paths_, without building the message.
+     *
+     * Only the header of the message and the poses and stamps of the paths are read, straight
+     * into the columns of a record, whose first row is left for the pose of the frame.
+     * @return false if the message is malformed or contains invalid floating point values.
+     */
+    bool decodePaths(const rcl_serialized_message_t & serialized);
+
+    /** @brief Position of the first pose of a path, in the message frame, if it has poses. */
+    static bool readFirstPosition(
+        const rviz_legged_msgs::msg::Paths & msg, size_t path_index, Ogre::Vector3 & position);
+    static bool readFirstPosition(
+        const type_adapters::EigenPaths & msg, size_t path_index, Ogre::Vector3 & position);
+
+    /**
+     * @brief Append the first pose of every path, in the fixed frame, to the executed trajectory of
+     * the path.
+     *
+     * Called for every message before the visibility gate, so that the trajectory has no gap while
+     * the paths are off-screen.
+     */
+    template<typename PathsMessage>
+    void accumulateExecuted(const PathsMessage & msg);
+    void accumulateExecuted(const rclcpp::SerializedMessage & msg);
+
+    /** @brief Append first_positions_, in the frame of header, to the executed trajectories. */
+    void appendExecuted(const std_msgs::msg::Header & header);
+
+    void clearExecuted();
+
+    /** @brief Record the paths of a message, in its frame, and the pose of the frame. */
+    void recordPaths(const rviz_legged_msgs::msg::Paths & msg, const FrameTransform & frame);
+    void recordPaths(const type_adapters::EigenPaths & msg, const FrameTransform & frame);
+    void recordPaths(const RecordedPaths & msg, const FrameTransform & frame);
+
+    /**
+     * @brief Draw the paths of a message, validated, into a new slot.
+     *
+     * The paths are drawn in the message frame, the slot node carrying its transform.
+     */
+    template<typename PathsMessage>
+    void addPaths(const PathsMessage & msg, const FrameTransform & frame);
+
+    // The paths of a message are drawn by a loop specialized for the Line Style and the Pose
+    // Style, chosen once per message.
+    template<PathsPolicy::LineStyle kLineStyle, typename PathsMessage>
+    void dispatchPoseStyle(const PathsMessage & msg, Slot & slot);
+    template<
+        PathsPolicy::LineStyle kLineStyle, PathsPolicy::PoseStyle kPoseStyle, typename PathsMessage>
+    void renderPaths(const PathsMessage & msg, Slot & slot);
+
+    /** @brief Fill the scratch buffers with the poses of a path, in the message frame. */
+    void readPathPoses(const rviz_legged_msgs::msg::Paths & msg, size_t path_index, bool orientations);
+    void readPathPoses(const type_adapters::EigenPaths & msg, size_t path_index, bool orientations);
+    void readPathPoses(const RecordedPaths & msg, size_t path_index, bool orientations);
+
+    /** @brief Compute the colormap scalars of all the paths of a message, and their range. */
+    void computePathScalars(const rviz_legged_msgs::msg::Paths & msg);
+    void computePathScalars(const type_adapters::EigenPaths & msg);
+    void computePathScalars(const RecordedPaths & msg);
+    void computePathScalars(PathsPolicy::ColorMode mode, std::vector<float> & scalars);
+    void finishPathScalars();
+    /** @brief Fill path_colors_ for a path of the message, empty in the Flat mode. */
+    void updatePathColors(size_t path_index);
+
+    Ogre::ColourValue getPoseArrowColor() const;
+    void updateManualObject(Ogre::ManualObject * manual_object);
+
+    /** @brief Material of the lines, following the fading, the terrain shadow and the alpha. */
+    const std::string & lineMaterialName();
+
+    /** @brief Bind the material of the lines to the lines already drawn. */
+    void bindLineMaterials();
+    void updateBillBoardLine(rviz_rendering::BillboardLine * billboard_line);
+    void updatePoseMarkers(Instance & instance, PathsPolicy::PoseStyle pose_style);
+
+    /** @brief Create the material of the pose markers, with the current sizes and color. */
+    void createPoseMarkerMaterial();
+
+    /** @brief Grow the bounds of the pose markers when the marker sizes outgrow them. */
+    void updateMarkerBounds();
+    void setMarkerBounds(Instance & instance);
+
+    /** @brief Call f on every instance of every slot. */
+    template<typename F>
+    void forEachInstance(F f);
+
+    // Content hash of the last message processed in full, unset when the paths must be rebuilt.
+    std::optional<uint64_t> last_message_hash_;
+
+    common::MaterialCache::Handle opaque_lines_material_;
+    common::MaterialCache::Handle transparent_lines_material_;
+    // Material of all the pose markers, whose sizes and arrow color are its parameters. Created on
+    // initialization, once the material scripts are loaded.
+    std::unique_ptr<common::PoseMarkerMaterial> pose_marker_material_;
+    // Distance from their pose the bounds of the markers are computed for, doubled when the marker
+    // sizes outgrow it, hence growing a size rarely updates the bounds of every marker.
+    float marker_bounds_extent_ = 0.0f;
+
+    // Scratch buffers of the path poses in the message frame, reused across messages. The
+    // orientations are filled only when pose markers are displayed.
+    std::vector<Ogre::Vector3> path_positions_;
+    std::vector<Ogre::Quaternion> path_orientations_;
+    std::vector<Ogre::ColourValue> path_colors_;
+
+    // Colormap scalars of the poses of every path of the message, and the scratch buffers they
+    // are computed from.
+    std::vector<std::vector<float>> path_scalars_;
+    common::ScalarRange path_scalar_range_;
+    std::vector<Ogre::Vector3> scalar_positions_;
+    std::vector<double> scalar_stamps_;
+
+    std::unique_ptr<rviz_common::properties::RosTopicProperty> adapted_topic_property_;
+    rclcpp::Subscription<type_adapters::EigenPaths>::SharedPtr adapted_subscription_;
+    common::TransformFilter<type_adapters::EigenPaths> adapted_filter_;
+    uint32_t adapted_messages_received_ = 0;
+
+    std::unique_ptr<rviz_common::properties::RosTopicProperty> serialized_topic_property_;
+    rclcpp::Subscription<rviz_legged_msgs::msg::Paths>::SharedPtr serialized_subscription_;
+    common::TransformFilter<SerializedPaths> serialized_filter_;
+    uint32_t serialized_messages_received_ = 0;
+    // Paths of the last serialized message, whose record values are those of decoded_values_.
+    RecordedPaths decoded_paths_;
+    std::vector<float> decoded_values_;
 
     std::unique_ptr<rviz_common::properties::EnumProperty> style_property_;
+    std::unique_ptr<rviz_common::properties::EnumProperty> color_mode_property_;
+    std::unique_ptr<rviz_common::properties::EnumProperty> colormap_property_;
+    std::unique_ptr<rviz_common::properties::BoolProperty> auto_range_property_;
+    std::unique_ptr<rviz_common::properties::FloatProperty> range_min_property_;
+    std::unique_ptr<rviz_common::properties::FloatProperty> range_max_property_;
     std::unique_ptr<rviz_common::properties::ColorProperty> color_property_;
     std::unique_ptr<rviz_common::properties::FloatProperty> alpha_property_;
     std::unique_ptr<rviz_common::properties::FloatProperty> line_width_property_;
     std::unique_ptr<rviz_common::properties::IntProperty> buffer_length_property_;
-    std::unique_ptr<rviz_common::properties::VectorProperty> offset_property_;
+    std::unique_ptr<rviz_common::properties::IntProperty> expected_path_length_property_;
+    std::unique_ptr<rviz_common::properties::FloatProperty> fade_duration_property_;
+    std::unique_ptr<rviz_common::properties::BoolProperty> skip_duplicates_property_;
+    std::unique_ptr<rviz_common::properties::BoolProperty> ignore_stamps_property_;
+    std::unique_ptr<rviz_common::properties::BoolProperty> executed_property_;
+    std::unique_ptr<rviz_common::properties::IntProperty> executed_max_points_property_;
 
-    enum LineStyle
-    {
-        LINES,
-        BILLBOARDS
-    };
+    // Created when fading is enabled for the first time.
+    std::unique_ptr<common::AgeFadeMaterial> fade_material_;
+    // Stamp, in the time base of fade_material_, of the paths being rendered.
+    float path_stamp_ = 0.0F;
+    std::unique_ptr<rviz_common::properties::VectorProperty> offset_property_;
 
     // pose marker property
     std::unique_ptr<rviz_common::properties::EnumProperty> pose_style_property_;
@@ -147,12 +431,28 @@ private:
     std::unique_ptr<rviz_common::properties::FloatProperty> pose_arrow_shaft_diameter_property_;
     std::unique_ptr<rviz_common::properties::FloatProperty> pose_arrow_head_diameter_property_;
 
-    enum PoseStyle
-    {
-        NONE,
-        AXES,
-        ARROWS,
-    };
+    std::unique_ptr<rviz_common::properties::BoolProperty> terrain_shadow_property_;
+    std::unique_ptr<rviz_common::properties::RosTopicProperty> terrain_topic_property_;
+    std::unique_ptr<rviz_common::properties::TfFrameProperty> terrain_frame_property_;
+    std::unique_ptr<rviz_common::properties::FloatProperty> shadow_alpha_property_;
+    rclcpp::Subscription<std_msgs::msg::Float64MultiArray>::SharedPtr terrain_subscription_;
+    // Terrain plane in the Terrain Frame, moved with the frame into the shadow material every frame.
+    common::TerrainPlane terrain_plane_;
+    // Created when the terrain shadow is enabled for the first time.
+    std::unique_ptr<common::TerrainShadowMaterial> terrain_shadow_material_;
+
+    // Executed trajectory of every path, in the fixed frame, drawn below executed_node_.
+    Ogre::SceneNode * executed_node_ = nullptr;
+    std::vector<std::unique_ptr<common::TrailBuffer>> executed_trails_;
+    // Whether the trails hold transparent points, and use the transparent material.
+    bool executed_transparent_ = false;
+    // First position of every path of the message, NaN without poses, reused across messages.
+    std::vector<Ogre::Vector3> first_positions_;
+    // Header of the serialized message being accumulated.
+    std_msgs::msg::Header executed_header_;
+
+    // Marks the render frames in the trace, held while the display is initialized.
+    std::shared_ptr<common::FrameMonitor> frame_monitor_;
 };
 
-}  // namespace rviz_legged_plugins
\ No newline at end of file
+}  // namespace rviz_legged_plugins
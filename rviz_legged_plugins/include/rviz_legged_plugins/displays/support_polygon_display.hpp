@@ -0,0 +1,131 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rclcpp/subscription.hpp"
+
+#include "rviz_legged_msgs/msg/friction_cones.hpp"
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+#include "rviz_common/message_filter_display.hpp"
+
+#include "rviz_default_plugins/visibility_control.hpp"
+
+#include "rviz_legged_plugins/common/age_fade_material.hpp"
+#include "rviz_legged_plugins/common/contact_hull.hpp"
+#include "rviz_legged_plugins/common/material_cache.hpp"
+#include "rviz_legged_plugins/common/transform_filter.hpp"
+
+namespace Ogre
+{
+class ManualObject;
+}
+
+namespace rviz_common::properties
+{
+class BoolProperty;
+class ColorProperty;
+class FloatProperty;
+class IntProperty;
+class RosTopicProperty;
+}  // namespace rviz_common::properties
+
+namespace rviz_legged_plugins::displays
+{
+/**
+ * \class SupportPolygonDisplay
+ * \brief Displays the support polygon, i.e. the convex hull of the active contacts.
+ *
+ * The active contacts are the wrenches whose force exceeds the "Force Threshold" or, when the
+ * "Friction Cones Topic" is set, the apexes of the friction cones. The hull is updated
+ * incrementally and drawn, together with its optional history, in a single ManualObject.
+ */
+class RVIZ_DEFAULT_PLUGINS_PUBLIC SupportPolygonDisplay : public
+    rviz_common::MessageFilterDisplay<rviz_legged_msgs::msg::WrenchesStamped>
+{
+    Q_OBJECT
+
+public:
+    SupportPolygonDisplay();
+
+    ~SupportPolygonDisplay() override;
+
+    /** @brief Overridden from Display. */
+    void reset() override;
+
+    /** @brief Overridden from Display. */
+    void update(float wall_dt, float ros_dt) override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void processMessage(rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg) override;
+
+    /** @brief Process a message received on the "Friction Cones Topic". */
+    void processCones(rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg);
+
+protected:
+    /** @brief Overridden from Display. */
+    void onInitialize() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void subscribe() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void unsubscribe() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void fixedFrameChanged() override;
+
+private Q_SLOTS:
+    void updateManualObject();
+    void updateHistoryLength();
+    void updateTolerance();
+    void updateConesTopic();
+    void updateFadeDuration();
+
+private:
+    /** Support polygon and stamp of the message it was computed from. */
+    struct Polygon
+    {
+        std::vector<Ogre::Vector3> vertices;
+        rclcpp::Time stamp;
+    };
+
+    void subscribeCones();
+    void updateContacts(const rclcpp::Time & stamp);
+    bool isFading() const;
+
+    common::ContactHull hull_;
+
+    // Vertices of the current support polygon (back) and of the previous ones.
+    std::deque<Polygon> history_;
+
+    // Active contacts of the last message, reused across messages.
+    std::vector<std::string> contact_ids_;
+    std::vector<Ogre::Vector3> contact_positions_;
+
+    Ogre::ManualObject * manual_object_ = nullptr;
+    // Materials of the outlines, unless fading, and of the fill.
+    common::MaterialCache::Handle material_;
+    common::MaterialCache::Handle fill_material_;
+    // Material of the outlines when they fade with their age, created on demand.
+    std::unique_ptr<common::AgeFadeMaterial> fade_material_;
+
+    rclcpp::Subscription<rviz_legged_msgs::msg::FrictionCones>::SharedPtr cones_subscription_;
+    common::TransformFilter<rviz_legged_msgs::msg::FrictionCones> cones_filter_;
+
+    rviz_common::properties::RosTopicProperty * cones_topic_property_;
+    rviz_common::properties::FloatProperty * force_threshold_property_;
+    rviz_common::properties::FloatProperty * tolerance_property_;
+    rviz_common::properties::ColorProperty * color_property_;
+    rviz_common::properties::FloatProperty * alpha_property_;
+    rviz_common::properties::BoolProperty * fill_property_;
+    rviz_common::properties::IntProperty * history_length_property_;
+    rviz_common::properties::FloatProperty * fade_duration_property_;
+};
+
+}  // namespace rviz_legged_plugins::displays
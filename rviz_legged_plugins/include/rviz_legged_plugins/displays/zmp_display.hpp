@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rclcpp/subscription.hpp"
+#include "std_msgs/msg/float64_multi_array.hpp"
+
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+#include "rviz_common/message_filter_display.hpp"
+
+#include "rviz_default_plugins/visibility_control.hpp"
+
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+
+namespace rviz_rendering
+{
+class Shape;
+}  // namespace rviz_rendering
+
+namespace rviz_common::properties
+{
+class ColorProperty;
+class FloatProperty;
+class RosTopicProperty;
+class TfFrameProperty;
+}  // namespace rviz_common::properties
+
+namespace rviz_legged_plugins::displays
+{
+/**
+ * \class ZmpDisplay
+ * \brief Displays the zero moment point and the projection of the CoM on the terrain.
+ *
+ * Both points are computed from the contact wrenches at the rate of the WrenchesStamped messages.
+ * As in ExternalWrenchDisplay, each force is applied at the origin of its frame and its components
+ * are expressed along the axes of the fixed frame. The CoM is the origin of the "CoM Frame" and
+ * the terrain is the plane z = a x + b y + c published on the "Terrain Topic" and expressed in the
+ * "Terrain Frame" (the horizontal plane through its origin until the first message is received).
+ */
+class RVIZ_DEFAULT_PLUGINS_PUBLIC ZmpDisplay : public
+    rviz_common::MessageFilterDisplay<rviz_legged_msgs::msg::WrenchesStamped>
+{
+    Q_OBJECT
+
+public:
+    ZmpDisplay();
+
+    ~ZmpDisplay() override;
+
+    /** @brief Overridden from Display. */
+    void reset() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void processMessage(rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg) override;
+
+protected:
+    /** @brief Overridden from Display. */
+    void onInitialize() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void subscribe() override;
+
+    /** @brief Overridden from MessageFilterDisplay. */
+    void unsubscribe() override;
+
+private Q_SLOTS:
+    void updateShapes();
+    void updateTerrainTopic();
+
+private:
+    void subscribeTerrain();
+    void processTerrain(std_msgs::msg::Float64MultiArray::ConstSharedPtr msg);
+
+    std::unique_ptr<rviz_rendering::Shape> zmp_shape_;
+    std::unique_ptr<rviz_rendering::Shape> com_shape_;
+
+    // Terrain plane expressed in the terrain frame.
+    common::TerrainPlane terrain_plane_;
+
+    // Contact positions in the fixed frame and contact wrenches, reused across messages.
+    std::vector<Ogre::Vector3> contact_positions_;
+    std::vector<common::WrenchSample> contact_wrenches_;
+
+    rclcpp::Subscription<std_msgs::msg::Float64MultiArray>::SharedPtr terrain_subscription_;
+
+    rviz_common::properties::TfFrameProperty * com_frame_property_;
+    rviz_common::properties::TfFrameProperty * terrain_frame_property_;
+    rviz_common::properties::RosTopicProperty * terrain_topic_property_;
+    rviz_common::properties::ColorProperty * zmp_color_property_;
+    rviz_common::properties::ColorProperty * com_color_property_;
+    rviz_common::properties::FloatProperty * alpha_property_;
+    rviz_common::properties::FloatProperty * radius_property_;
+};
+
+}  // namespace rviz_legged_plugins::displays
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "rviz_common/panel.hpp"
+
+#include "rviz_default_plugins/visibility_control.hpp"
+
+class QCheckBox;
+class QLabel;
+class QSlider;
+class QTimer;
+
+namespace rviz_legged_plugins::panels
+{
+/**
+ * \class TimelinePanel
+ * \brief Scrubs the legged displays back through the messages recorded in their timeline stores.
+ *
+ * The slider spans the recorded messages of all the displays. Moving it draws the displays at
+ * that instant while the live messages keep being recorded; "Live" draws the live messages again.
+ */
+class RVIZ_DEFAULT_PLUGINS_PUBLIC TimelinePanel : public rviz_common::Panel
+{
+    Q_OBJECT
+
+public:
+    explicit TimelinePanel(QWidget * parent = nullptr);
+
+    /** @brief Back to live, so that the displays do not stay on a past instant. */
+    ~TimelinePanel() override;
+
+private Q_SLOTS:
+    void scrub(int position);
+    void setLive(bool live);
+    /** @brief Follow the recorded range and the memory of the stores. */
+    void refresh();
+
+private:
+    static constexpr int kSliderSteps = 1000;
+
+    QSlider * slider_;
+    QCheckBox * live_check_box_;
+    QLabel * time_label_;
+    QLabel * memory_label_;
+    QTimer * refresh_timer_;
+};
+
+}  // namespace rviz_legged_plugins::panels
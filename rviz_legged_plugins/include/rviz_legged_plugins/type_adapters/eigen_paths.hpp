@@ -0,0 +1,88 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "rclcpp/type_adapter.hpp"
+#include "std_msgs/msg/header.hpp"
+
+#include "rviz_legged_msgs/msg/paths.hpp"
+
+namespace rviz_legged_plugins::type_adapters
+{
+
+/**
+ * \struct EigenPaths
+ * \brief Eigen-backed counterpart of rviz_legged_msgs::msg::Paths (REP-2007 type adaptation).
+ *
+ * Every path is a contiguous 7 x n matrix whose columns are the poses of the path, stored as
+ * position (x, y, z) followed by the orientation quaternion (x, y, z, w). All the poses are
+ * expressed in header.frame_id.
+ */
+struct EigenPaths
+{
+    using PathMatrix = Eigen::Matrix<double, 7, Eigen::Dynamic>;
+
+    std_msgs::msg::Header header;
+    std::vector<PathMatrix> paths;
+};
+
+}  // namespace rviz_legged_plugins::type_adapters
+
+template<>
+struct rclcpp::TypeAdapter<
+    rviz_legged_plugins::type_adapters::EigenPaths, rviz_legged_msgs::msg::Paths>
+{
+    using is_specialized = std::true_type;
+    using custom_type = rviz_legged_plugins::type_adapters::EigenPaths;
+    using ros_message_type = rviz_legged_msgs::msg::Paths;
+
+    static void convert_to_ros_message(const custom_type & source, ros_message_type & destination)
+    {
+        destination.header = source.header;
+        destination.paths.resize(source.paths.size());
+
+        for (size_t i = 0; i < source.paths.size(); i++) {
+            const auto & matrix = source.paths[i];
+            auto & path = destination.paths[i];
+
+            path.header = source.header;
+            path.poses.resize(static_cast<size_t>(matrix.cols()));
+            for (Eigen::Index j = 0; j < matrix.cols(); j++) {
+                auto & pose_stamped = path.poses[static_cast<size_t>(j)];
+                pose_stamped.header = source.header;
+                pose_stamped.pose.position.x = matrix(0, j);
+                pose_stamped.pose.position.y = matrix(1, j);
+                pose_stamped.pose.position.z = matrix(2, j);
+                pose_stamped.pose.orientation.x = matrix(3, j);
+                pose_stamped.pose.orientation.y = matrix(4, j);
+                pose_stamped.pose.orientation.z = matrix(5, j);
+                pose_stamped.pose.orientation.w = matrix(6, j);
+            }
+        }
+    }
+
+    static void convert_to_custom(const ros_message_type & source, custom_type & destination)
+    {
+        destination.header = source.header;
+        destination.paths.resize(source.paths.size());
+
+        for (size_t i = 0; i < source.paths.size(); i++) {
+            const auto & poses = source.paths[i].poses;
+            auto & matrix = destination.paths[i];
+
+            matrix.resize(7, static_cast<Eigen::Index>(poses.size()));
+            for (size_t j = 0; j < poses.size(); j++) {
+                const auto & pose = poses[j].pose;
+                matrix.col(static_cast<Eigen::Index>(j)) <<
+                    pose.position.x, pose.position.y, pose.position.z,
+                    pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w;
+            }
+        }
+    }
+};
+
+RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE(
+    rviz_legged_plugins::type_adapters::EigenPaths, rviz_legged_msgs::msg::Paths);
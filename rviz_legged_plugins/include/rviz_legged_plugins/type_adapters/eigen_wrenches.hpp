@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "rclcpp/type_adapter.hpp"
+#include "std_msgs/msg/header.hpp"
+
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+namespace rviz_legged_plugins::type_adapters
+{
+
+/**
+ * \struct EigenWrenches
+ * \brief Eigen-backed counterpart of rviz_legged_msgs::msg::WrenchesStamped (REP-2007 type
+ * adaptation).
+ *
+ * The wrenches are the columns of a contiguous 6 x n matrix, force (x, y, z) followed by torque
+ * (x, y, z). The i-th wrench is expressed in frame_ids[i]; all of them share header.stamp.
+ */
+struct EigenWrenches
+{
+    using WrenchMatrix = Eigen::Matrix<double, 6, Eigen::Dynamic>;
+
+    std_msgs::msg::Header header;
+    std::vector<std::string> frame_ids;
+    WrenchMatrix wrenches;
+};
+
+}  // namespace rviz_legged_plugins::type_adapters
+
+template<>
+struct rclcpp::TypeAdapter<
+    rviz_legged_plugins::type_adapters::EigenWrenches, rviz_legged_msgs::msg::WrenchesStamped>
+{
+    using is_specialized = std::true_type;
+    using custom_type = rviz_legged_plugins::type_adapters::EigenWrenches;
+    using ros_message_type = rviz_legged_msgs::msg::WrenchesStamped;
+
+    static void convert_to_ros_message(const custom_type & source, ros_message_type & destination)
+    {
+        destination.header = source.header;
+        destination.wrenches_stamped.resize(static_cast<size_t>(source.wrenches.cols()));
+
+        for (Eigen::Index i = 0; i < source.wrenches.cols(); i++) {
+            auto & wrench_stamped = destination.wrenches_stamped[static_cast<size_t>(i)];
+            wrench_stamped.header.stamp = source.header.stamp;
+            wrench_stamped.header.frame_id = source.frame_ids[static_cast<size_t>(i)];
+            wrench_stamped.wrench.force.x = source.wrenches(0, i);
+            wrench_stamped.wrench.force.y = source.wrenches(1, i);
+            wrench_stamped.wrench.force.z = source.wrenches(2, i);
+            wrench_stamped.wrench.torque.x = source.wrenches(3, i);
+            wrench_stamped.wrench.torque.y = source.wrenches(4, i);
+            wrench_stamped.wrench.torque.z = source.wrenches(5, i);
+        }
+    }
+
+    static void convert_to_custom(const ros_message_type & source, custom_type & destination)
+    {
+        const auto & wrenches_stamped = source.wrenches_stamped;
+
+        destination.header = source.header;
+        destination.frame_ids.resize(wrenches_stamped.size());
+        destination.wrenches.resize(6, static_cast<Eigen::Index>(wrenches_stamped.size()));
+
+        for (size_t i = 0; i < wrenches_stamped.size(); i++) {
+            const auto & wrench = wrenches_stamped[i].wrench;
+            destination.frame_ids[i] = wrenches_stamped[i].header.frame_id;
+            destination.wrenches.col(static_cast<Eigen::Index>(i)) <<
+                wrench.force.x, wrench.force.y, wrench.force.z,
+                wrench.torque.x, wrench.torque.y, wrench.torque.z;
+        }
+    }
+};
+
+RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE(
+    rviz_legged_plugins::type_adapters::EigenWrenches, rviz_legged_msgs::msg::WrenchesStamped);
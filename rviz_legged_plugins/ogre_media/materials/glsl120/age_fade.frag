@@ -0,0 +1,8 @@
+#version 120
+
+varying vec4 faded_colour;
+
+void main()
+{
+  gl_FragColor = faded_colour;
+}
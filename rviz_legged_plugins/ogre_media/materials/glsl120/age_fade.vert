@@ -0,0 +1,21 @@
+#version 120
+
+// Fades the vertex colour out with the age of the vertex. The stamp of the vertex, in the time
+// base of the display, is its first texture coordinate.
+
+uniform mat4 worldViewProj;
+uniform float now;
+uniform float fade_duration;
+
+attribute vec4 vertex;
+attribute vec4 colour;
+attribute vec4 uv0;
+
+varying vec4 faded_colour;
+
+void main()
+{
+  gl_Position = worldViewProj * vertex;
+  float age = now - uv0.x;
+  faded_colour = vec4(colour.rgb, colour.a * clamp(1.0 - age / fade_duration, 0.0, 1.0));
+}
@@ -0,0 +1,25 @@
+#version 120
+
+// Fades a solid coloured mesh out with its age. The stamp of the mesh, in the time base of the
+// display, is the x of its custom parameter 0; the mesh is lit by a headlight.
+
+uniform mat4 worldViewProj;
+uniform vec4 camera_position;
+uniform float now;
+uniform float fade_duration;
+uniform vec4 stamp;
+uniform vec4 colour;
+
+attribute vec4 vertex;
+attribute vec3 normal;
+
+varying vec4 faded_colour;
+
+void main()
+{
+  gl_Position = worldViewProj * vertex;
+  float age = now - stamp.x;
+  vec3 to_camera = normalize(camera_position.xyz - vertex.xyz);
+  float diffuse = 0.4 + 0.6 * abs(dot(normalize(normal), to_camera));
+  faded_colour = vec4(diffuse * colour.rgb, colour.a * clamp(1.0 - age / fade_duration, 0.0, 1.0));
+}
@@ -0,0 +1,8 @@
+#version 120
+
+varying vec4 marker_colour;
+
+void main()
+{
+  gl_FragColor = marker_colour;
+}
@@ -0,0 +1,36 @@
+#version 120
+
+// Draws the pose markers of the paths, arrows or axes, as meshes sized by the parameters of the
+// material. The vertex is the pose. The first texture coordinate is the axis of the part of the
+// marker, with w = 1 for the arrows, which take the arrow colour, and 0 for the axes, which take
+// the vertex colour; the second one is the radial direction of the vertex. The third and fourth
+// ones weigh the lengths and the radii giving the offset of the vertex along the axis and the
+// radial direction.
+
+uniform mat4 worldViewProj;
+uniform mat4 worldView;
+// Shaft and head of the arrows, and axes.
+uniform vec3 lengths;
+uniform vec3 radii;
+uniform vec4 arrow_colour;
+
+attribute vec4 vertex;
+attribute vec3 normal;
+attribute vec4 colour;
+attribute vec4 uv0;
+attribute vec4 uv1;
+attribute vec4 uv2;
+attribute vec4 uv3;
+
+varying vec4 marker_colour;
+
+void main()
+{
+  vec3 offset = uv0.xyz * dot(uv2.xyz, lengths) + uv1.xyz * dot(uv3.xyz, radii);
+  gl_Position = worldViewProj * vec4(vertex.xyz + offset, 1.0);
+
+  // Lit by a light at the camera.
+  vec3 view_normal = normalize((worldView * vec4(normal, 0.0)).xyz);
+  vec4 base = mix(colour, arrow_colour, uv0.w);
+  marker_colour = vec4((0.4 + 0.6 * abs(view_normal.z)) * base.rgb, base.a);
+}
@@ -0,0 +1,8 @@
+#version 120
+
+varying vec4 shadow_colour;
+
+void main()
+{
+  gl_FragColor = shadow_colour;
+}
@@ -0,0 +1,23 @@
+#version 120
+
+// Projects the vertex on the terrain plane along the plane normal, for the shadow of a line on the
+// terrain. The plane is given in world coordinates as (normal, distance to the origin).
+
+uniform mat4 world;
+uniform mat4 viewProj;
+uniform vec4 plane;
+uniform float shadow_alpha;
+
+attribute vec4 vertex;
+attribute vec4 colour;
+
+varying vec4 shadow_colour;
+
+void main()
+{
+  vec4 position = world * vertex;
+  // Lifted slightly above the plane, not to fight with a terrain drawn on it.
+  position.xyz -= (dot(plane.xyz, position.xyz) - plane.w - 0.002) * plane.xyz;
+  gl_Position = viewProj * position;
+  shadow_colour = vec4(colour.rgb, colour.a * shadow_alpha);
+}
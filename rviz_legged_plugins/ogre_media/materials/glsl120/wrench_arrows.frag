@@ -0,0 +1,19 @@
+#version 120
+
+uniform vec4 force_colour;
+uniform vec4 torque_colour;
+uniform float alpha;
+uniform float colour_mode;
+uniform sampler2D colormap;
+
+varying float torque;
+varying float colormap_position;
+
+void main()
+{
+  // The centers of the 256 texels of the colormap span [0.5 / 256, 1 - 0.5 / 256].
+  vec3 force_rgb = colour_mode > 0.5 ?
+    texture2D(colormap, vec2((0.5 + 255.0 * colormap_position) / 256.0, 0.5)).rgb :
+    force_colour.rgb;
+  gl_FragColor = vec4(mix(force_rgb, torque_colour.rgb, torque), alpha);
+}
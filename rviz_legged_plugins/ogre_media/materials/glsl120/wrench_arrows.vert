@@ -0,0 +1,40 @@
+#version 120
+
+// Draws the arrows of the wrenches as lines. The vertex is the contact point of the wrench. The
+// first texture coordinate is the offset of the vertex from it at unit scale, with w = 1 for the
+// torque arrow and 0 for the force arrow; the second one is the force, mapped to the colormap;
+// the third one holds the ranges of the magnitudes and of the ratios of the message, for the auto
+// range.
+
+uniform mat4 worldViewProj;
+uniform float force_scale;
+uniform float torque_scale;
+// 1 to draw the arrows with the head of the force, rather than its tail, on the contact point.
+uniform float head_reference;
+// 0 for the flat colour, 1 for the magnitude of the force, 2 for its tangential to normal ratio.
+uniform float colour_mode;
+uniform float auto_range;
+uniform vec2 range;
+
+attribute vec4 vertex;
+attribute vec4 uv0;
+attribute vec4 uv1;
+attribute vec4 uv2;
+
+varying float torque;
+varying float colormap_position;
+
+void main()
+{
+  torque = uv0.w;
+  vec3 force = uv1.xyz;
+  vec3 position = vertex.xyz + mix(force_scale, torque_scale, torque) * uv0.xyz -
+    head_reference * 1.25 * force_scale * force;
+  gl_Position = worldViewProj * vec4(position, 1.0);
+
+  bool magnitude = colour_mode < 1.5;
+  float value = magnitude ? length(force) : length(force.xy) / max(abs(force.z), 1e-6);
+  vec2 bounds = auto_range > 0.5 ? (magnitude ? uv2.xy : uv2.zw) : range;
+  colormap_position = bounds.y > bounds.x ?
+    clamp((value - bounds.x) / (bounds.y - bounds.x), 0.0, 1.0) : 0.0;
+}
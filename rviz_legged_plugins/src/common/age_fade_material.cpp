@@ -0,0 +1,74 @@
+#include "rviz_legged_plugins/common/age_fade_material.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <OgreEntity.h>
+#include <OgreMaterialManager.h>
+#include <OgrePass.h>
+#include <OgreSubEntity.h>
+#include <OgreTechnique.h>
+#include <OgreVector4.h>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+// Custom parameter of the renderables holding their stamp, bound by the AgeFadeSolid material.
+constexpr size_t kStampParameter = 0;
+
+}  // namespace
+
+AgeFadeMaterial::AgeFadeMaterial(Kind kind)
+{
+    // Each instance has its own parameters, hence its own clone of the material script.
+    static int count = 0;
+    auto base = Ogre::MaterialManager::getSingleton().getByName(
+        kind == SOLID_COLOR ? "rviz_legged_plugins/AgeFadeSolid" : "rviz_legged_plugins/AgeFade",
+        "rviz_rendering");
+    material_ = base->clone("AgeFadeMaterial" + std::to_string(count++));
+    material_->load();
+}
+
+AgeFadeMaterial::~AgeFadeMaterial()
+{
+    Ogre::MaterialManager::getSingleton().remove(material_->getHandle());
+}
+
+void AgeFadeMaterial::setFadeDuration(float seconds)
+{
+    material_->getTechnique(0)->getPass(0)->getVertexProgramParameters()->setNamedConstant(
+        "fade_duration", std::max(seconds, 1e-3f));
+}
+
+void AgeFadeMaterial::setColor(const Ogre::ColourValue & color)
+{
+    material_->getTechnique(0)->getPass(0)->getVertexProgramParameters()->setNamedConstant(
+        "colour", color);
+}
+
+void AgeFadeMaterial::setStamp(Ogre::Entity & entity, float stamp)
+{
+    for (unsigned int i = 0; i < entity.getNumSubEntities(); i++) {
+        entity.getSubEntity(i)->setCustomParameter(kStampParameter, Ogre::Vector4(stamp, 0.0f, 0.0f, 0.0f));
+    }
+}
+
+void AgeFadeMaterial::setNow(const rclcpp::Time & now)
+{
+    material_->getTechnique(0)->getPass(0)->getVertexProgramParameters()->setNamedConstant(
+        "now", toShaderTime(now));
+}
+
+float AgeFadeMaterial::toShaderTime(const rclcpp::Time & time)
+{
+    if (!has_epoch_) {
+        has_epoch_ = true;
+        epoch_nanoseconds_ = time.nanoseconds();
+    }
+    return static_cast<float>(1e-9 * static_cast<double>(time.nanoseconds() - epoch_nanoseconds_));
+}
+
+}  // namespace rviz_legged_plugins::common
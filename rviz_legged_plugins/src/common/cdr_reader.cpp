@@ -0,0 +1,129 @@
+#include "rviz_legged_plugins/common/cdr_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+// Two bytes of representation identifier and two of options precede the values, which are
+// aligned from the end of the header.
+constexpr size_t kEncapsulationSize = 4;
+
+// Second byte of the identifiers of the big endian encapsulations, the little endian ones add 1.
+constexpr uint8_t kPlainCdr = 0x00;
+constexpr uint8_t kPlainCdr2 = 0x06;
+
+bool isHostLittleEndian()
+{
+    uint16_t value = 1;
+    uint8_t first_byte;
+    std::memcpy(&first_byte, &value, 1);
+    return first_byte == 1;
+}
+
+}  // namespace
+
+CdrReader::CdrReader(const uint8_t * data, size_t size)
+: data_(data),
+  size_(size)
+{
+    if (!data_ || size_ < kEncapsulationSize) {
+        ok_ = false;
+        return;
+    }
+    // Only plain CDR (0x0000-0x0001) and XCDR2 (0x0006-0x0007) hold the fields in order: the
+    // parameter lists and the delimited XCDR2 add headers the reader does not parse.
+    uint8_t kind = data_[1] & ~1;
+    if (data_[0] != 0 || (kind != kPlainCdr && kind != kPlainCdr2)) {
+        ok_ = false;
+        return;
+    }
+    // The second byte of the identifier is odd for little endian values. XCDR2 aligns the 8-byte
+    // values to 4 bytes only.
+    bool little_endian = (data_[1] & 1) != 0;
+    swap_ = little_endian != isHostLittleEndian();
+    max_alignment_ = kind == kPlainCdr2 ? 4 : 8;
+    offset_ = kEncapsulationSize;
+}
+
+template<typename T>
+bool CdrReader::readValue(T & value)
+{
+    if (!align(sizeof(T))) {
+        return false;
+    }
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, data_ + offset_, sizeof(T));
+    if (swap_) {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+    std::memcpy(&value, bytes, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+}
+
+bool CdrReader::read(int32_t & value)
+{
+    return readValue(value);
+}
+
+bool CdrReader::read(uint32_t & value)
+{
+    return readValue(value);
+}
+
+bool CdrReader::read(double & value)
+{
+    return readValue(value);
+}
+
+bool CdrReader::read(std::string_view & value)
+{
+    uint32_t length;
+    if (!readSequenceLength(length, 1)) {
+        return false;
+    }
+    // The length counts the terminating null character.
+    const auto * characters = reinterpret_cast<const char *>(data_ + offset_);
+    value = std::string_view(characters, length > 0 ? length - 1 : 0);
+    offset_ += length;
+    return true;
+}
+
+bool CdrReader::skipString()
+{
+    std::string_view value;
+    return read(value);
+}
+
+bool CdrReader::readSequenceLength(uint32_t & length, size_t min_element_size)
+{
+    if (!read(length)) {
+        return false;
+    }
+    if (static_cast<uint64_t>(length) * min_element_size > size_ - offset_) {
+        ok_ = false;
+    }
+    return ok_;
+}
+
+bool CdrReader::align(size_t size)
+{
+    if (!ok_) {
+        return false;
+    }
+    size_t alignment = std::min(size, max_alignment_);
+    size_t padding = (alignment - (offset_ - kEncapsulationSize) % alignment) % alignment;
+    if (offset_ + padding + size > size_) {
+        ok_ = false;
+        return false;
+    }
+    offset_ += padding;
+    return true;
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,77 @@
+#include "rviz_legged_plugins/common/colormap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+// Viridis sampled at 9 regularly spaced points, interpolated linearly in between.
+constexpr std::array<std::array<float, 3>, 9> kViridis = {{
+    {0.267004f, 0.004874f, 0.329415f},
+    {0.278826f, 0.175490f, 0.483397f},
+    {0.229739f, 0.322361f, 0.545706f},
+    {0.172719f, 0.448791f, 0.557885f},
+    {0.127568f, 0.566949f, 0.550556f},
+    {0.157851f, 0.683765f, 0.501686f},
+    {0.369214f, 0.788888f, 0.382914f},
+    {0.678489f, 0.863742f, 0.189503f},
+    {0.993248f, 0.906157f, 0.143936f},
+}};
+
+Ogre::ColourValue sampleViridis(float t)
+{
+    float position = t * static_cast<float>(kViridis.size() - 1);
+    size_t i = std::min(static_cast<size_t>(position), kViridis.size() - 2);
+    float w = position - static_cast<float>(i);
+
+    const auto & a = kViridis[i];
+    const auto & b = kViridis[i + 1];
+    return Ogre::ColourValue(
+        a[0] + w * (b[0] - a[0]), a[1] + w * (b[1] - a[1]), a[2] + w * (b[2] - a[2]));
+}
+
+Ogre::ColourValue sampleJet(float t)
+{
+    auto channel = [t](float center) {
+        return std::clamp(1.5f - std::abs(4.0f * t - center), 0.0f, 1.0f);
+    };
+    return Ogre::ColourValue(channel(3.0f), channel(2.0f), channel(1.0f));
+}
+
+}  // namespace
+
+Ogre::ColourValue sampleColormap(Colormap colormap, float t)
+{
+    t = std::isfinite(t) ? std::clamp(t, 0.0f, 1.0f) : 0.0f;
+
+    switch (colormap) {
+        case Colormap::JET:
+            return sampleJet(t);
+        case Colormap::VIRIDIS:
+        default:
+            return sampleViridis(t);
+    }
+}
+
+void ScalarRange::include(float value)
+{
+    if (std::isfinite(value)) {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+}
+
+float ScalarRange::normalize(float value) const
+{
+    if (!(max > min)) {
+        return 0.0f;
+    }
+    return std::clamp((value - min) / (max - min), 0.0f, 1.0f);
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,50 @@
+#include "rviz_legged_plugins/common/cone_mesh.hpp"
+
+#include <OgreManualObject.h>
+#include <OgreMath.h>
+#include <OgreMeshManager.h>
+#include <OgreSceneManager.h>
+#include <OgreVector3.h>
+
+namespace rviz_legged_plugins::common
+{
+
+const std::string & coarseConeMesh(Ogre::SceneManager * scene_manager)
+{
+    static const std::string name = "rviz_legged_plugins/CoarseCone";
+    if (Ogre::MeshManager::getSingleton().resourceExists(name, "rviz_rendering")) {
+        return name;
+    }
+
+    const Ogre::Vector3 apex(0.0f, 0.5f, 0.0f);
+    const Ogre::Vector3 base_center(0.0f, -0.5f, 0.0f);
+    auto rim = [](unsigned int side) {
+            Ogre::Radian angle(Ogre::Math::TWO_PI * static_cast<float>(side) / kCoarseConeSides);
+            return Ogre::Vector3(0.5f * Ogre::Math::Cos(angle), -0.5f, 0.5f * Ogre::Math::Sin(angle));
+        };
+
+    auto * manual_object = scene_manager->createManualObject();
+    manual_object->begin("BaseWhiteNoLighting", Ogre::RenderOperation::OT_TRIANGLE_LIST, "rviz_rendering");
+    for (unsigned int side = 0; side < kCoarseConeSides; side++) {
+        auto first = rim(side);
+        auto second = rim(side + 1);
+
+        // Flat shaded sides, facing outwards.
+        auto normal = (second - apex).crossProduct(first - apex).normalisedCopy();
+        for (const auto & vertex : {apex, second, first}) {
+            manual_object->position(vertex);
+            manual_object->normal(normal);
+        }
+        for (const auto & vertex : {base_center, first, second}) {
+            manual_object->position(vertex);
+            manual_object->normal(Ogre::Vector3::NEGATIVE_UNIT_Y);
+        }
+    }
+    manual_object->end();
+
+    manual_object->convertToMesh(name, "rviz_rendering");
+    scene_manager->destroyManualObject(manual_object);
+    return name;
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,193 @@
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include "rviz_common/msg_conversions.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+float sanitize(double value, bool accept_nan)
+{
+    return static_cast<float>((accept_nan && std::isnan(value)) ? 0.0 : value);
+}
+
+bool isFinite(const Ogre::Vector3 & vector)
+{
+    return std::isfinite(vector.x) && std::isfinite(vector.y) && std::isfinite(vector.z);
+}
+}  // namespace
+
+bool wrenchToSample(const geometry_msgs::msg::Wrench & wrench, bool accept_nan, WrenchSample & sample)
+{
+    sample.force = Ogre::Vector3(
+        sanitize(wrench.force.x, accept_nan),
+        sanitize(wrench.force.y, accept_nan),
+        sanitize(wrench.force.z, accept_nan));
+    sample.torque = Ogre::Vector3(
+        sanitize(wrench.torque.x, accept_nan),
+        sanitize(wrench.torque.y, accept_nan),
+        sanitize(wrench.torque.z, accept_nan));
+
+    return isFinite(sample.force) && isFinite(sample.torque);
+}
+
+bool packedWrenchToSample(
+    const std::vector<float> & forces, const std::vector<float> & torques, size_t i,
+    bool accept_nan, WrenchSample & sample)
+{
+    sample.force = Ogre::Vector3(
+        sanitize(forces[3 * i], accept_nan),
+        sanitize(forces[3 * i + 1], accept_nan),
+        sanitize(forces[3 * i + 2], accept_nan));
+
+    if (torques.empty()) {
+        sample.torque = Ogre::Vector3::ZERO;
+    } else {
+        sample.torque = Ogre::Vector3(
+            sanitize(torques[3 * i], accept_nan),
+            sanitize(torques[3 * i + 1], accept_nan),
+            sanitize(torques[3 * i + 2], accept_nan));
+    }
+
+    return isFinite(sample.force) && isFinite(sample.torque);
+}
+
+bool wrenchToSample(const Eigen::Matrix<double, 6, 1> & wrench, bool accept_nan, WrenchSample & sample)
+{
+    sample.force = Ogre::Vector3(
+        sanitize(wrench[0], accept_nan), sanitize(wrench[1], accept_nan), sanitize(wrench[2], accept_nan));
+    sample.torque = Ogre::Vector3(
+        sanitize(wrench[3], accept_nan), sanitize(wrench[4], accept_nan), sanitize(wrench[5], accept_nan));
+
+    return isFinite(sample.force) && isFinite(sample.torque);
+}
+
+ConeGeometry computeConeGeometry(
+    const Ogre::Vector3 & normal_direction, double friction_coefficient, float height)
+{
+    ConeGeometry geometry;
+
+    // The shape is centered in the middle of the cone, while the apex must lie on the contact point.
+    geometry.offset = normal_direction * height / 2;
+
+    // The axis of the cone shape is aligned with -y.
+    Eigen::Quaterniond quat = Eigen::Quaterniond::FromTwoVectors(
+        Eigen::Vector3d(0, -1, 0),
+        Eigen::Vector3d(normal_direction.x, normal_direction.y, normal_direction.z));
+    geometry.orientation = Ogre::Quaternion(
+        static_cast<float>(quat.w()), static_cast<float>(quat.x()),
+        static_cast<float>(quat.y()), static_cast<float>(quat.z()));
+
+    float cone_width = 2.0f * height * static_cast<float>(friction_coefficient);
+    geometry.scale = Ogre::Vector3(cone_width, height, cone_width);
+
+    return geometry;
+}
+
+TerrainPlane TerrainPlane::fromCoefficients(double a, double b, double c)
+{
+    TerrainPlane plane;
+    plane.point = Ogre::Vector3(0, 0, static_cast<float>(c));
+    plane.normal = Ogre::Vector3(static_cast<float>(-a), static_cast<float>(-b), 1);
+    plane.normal.normalise();
+    return plane;
+}
+
+TerrainPlane TerrainPlane::transformed(
+    const Ogre::Vector3 & position, const Ogre::Quaternion & orientation) const
+{
+    TerrainPlane plane;
+    plane.point = position + orientation * point;
+    plane.normal = orientation * normal;
+    return plane;
+}
+
+Ogre::Vector3 TerrainPlane::project(const Ogre::Vector3 & point_to_project) const
+{
+    return point_to_project - normal.dotProduct(point_to_project - point) * normal;
+}
+
+bool computeZmp(
+    const std::vector<Ogre::Vector3> & positions, const std::vector<WrenchSample> & wrenches,
+    const Ogre::Vector3 & reference, const Ogre::Vector3 & normal, Ogre::Vector3 & zmp)
+{
+    // Resultant force and moment about the reference point.
+    Ogre::Vector3 force = Ogre::Vector3::ZERO;
+    Ogre::Vector3 moment = Ogre::Vector3::ZERO;
+    for (size_t i = 0; i < wrenches.size(); i++) {
+        force += wrenches[i].force;
+        moment += (positions[i] - reference).crossProduct(wrenches[i].force) + wrenches[i].torque;
+    }
+
+    // The ZMP is the point of the plane about which the moment is parallel to the normal.
+    float normal_force = force.dotProduct(normal);
+    if (std::abs(normal_force) < std::numeric_limits<float>::epsilon()) {
+        return false;
+    }
+
+    zmp = reference + normal.crossProduct(moment) / normal_force;
+    return true;
+}
+
+void transformPathPositions(
+    const nav_msgs::msg::Path & path, const Ogre::Matrix4 & transform,
+    std::vector<Ogre::Vector3> & positions)
+{
+    positions.clear();
+    positions.reserve(path.poses.size());
+
+    for (const auto & pose_stamped : path.poses) {
+        positions.push_back(transform * rviz_common::pointMsgToOgre(pose_stamped.pose.position));
+    }
+}
+
+void transformPathPositions(
+    const Eigen::Matrix<double, 7, Eigen::Dynamic> & path, const Ogre::Matrix4 & transform,
+    std::vector<Ogre::Vector3> & positions)
+{
+    positions.clear();
+    positions.reserve(static_cast<size_t>(path.cols()));
+
+    for (Eigen::Index i = 0; i < path.cols(); i++) {
+        positions.push_back(
+            transform * Ogre::Vector3(
+                static_cast<float>(path(0, i)), static_cast<float>(path(1, i)),
+                static_cast<float>(path(2, i))));
+    }
+}
+
+void transformPathOrientations(
+    const nav_msgs::msg::Path & path, const Ogre::Quaternion & rotation,
+    std::vector<Ogre::Quaternion> & orientations)
+{
+    orientations.clear();
+    orientations.reserve(path.poses.size());
+
+    for (const auto & pose_stamped : path.poses) {
+        orientations.push_back(rotation * rviz_common::quaternionMsgToOgre(pose_stamped.pose.orientation));
+    }
+}
+
+void transformPathOrientations(
+    const Eigen::Matrix<double, 7, Eigen::Dynamic> & path, const Ogre::Quaternion & rotation,
+    std::vector<Ogre::Quaternion> & orientations)
+{
+    orientations.clear();
+    orientations.reserve(static_cast<size_t>(path.cols()));
+
+    for (Eigen::Index i = 0; i < path.cols(); i++) {
+        orientations.push_back(
+            rotation * Ogre::Quaternion(
+                static_cast<float>(path(6, i)), static_cast<float>(path(3, i)),
+                static_cast<float>(path(4, i)), static_cast<float>(path(5, i))));
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
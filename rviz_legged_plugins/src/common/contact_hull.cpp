@@ -0,0 +1,202 @@
+#include "rviz_legged_plugins/common/contact_hull.hpp"
+
+#include <algorithm>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+// Twice the signed area of the triangle o, a, b in the xy plane: positive if counterclockwise.
+float cross(const Ogre::Vector3 & o, const Ogre::Vector3 & a, const Ogre::Vector3 & b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+}  // namespace
+
+bool ContactHull::setContacts(
+    const std::vector<std::string> & ids, const std::vector<Ogre::Vector3> & positions)
+{
+    bool needs_rebuild = false;
+    pending_.clear();
+
+    for (auto & contact : contacts_) {
+        contact.active = false;
+    }
+
+    for (size_t i = 0; i < ids.size(); i++) {
+        auto it = std::find_if(
+            contacts_.begin(), contacts_.end(),
+            [&ids, i](const Contact & contact) {return contact.id == ids[i];});
+
+        if (it == contacts_.end()) {
+            // Touchdown.
+            Contact contact;
+            contact.id = ids[i];
+            contact.position = positions[i];
+            contact.active = true;
+            contacts_.push_back(contact);
+            pending_.push_back(contacts_.size() - 1);
+            continue;
+        }
+
+        it->active = true;
+        if (it->position.distance(positions[i]) <= tolerance_) {
+            continue;
+        }
+
+        it->position = positions[i];
+        if (it->on_hull) {
+            needs_rebuild = true;
+        } else {
+            pending_.push_back(static_cast<size_t>(it - contacts_.begin()));
+        }
+    }
+
+    // Lift off. The indices of the hull and of the pending insertions are shifted accordingly.
+    for (size_t k = contacts_.size(); k-- > 0; ) {
+        if (contacts_[k].active) {
+            continue;
+        }
+
+        needs_rebuild = needs_rebuild || contacts_[k].on_hull;
+        contacts_.erase(contacts_.begin() + static_cast<std::ptrdiff_t>(k));
+
+        for (auto & index : hull_) {
+            index -= (index > k) ? 1 : 0;
+        }
+        for (auto & index : pending_) {
+            index -= (index > k) ? 1 : 0;
+        }
+    }
+
+    if (needs_rebuild) {
+        rebuild();
+        updateVertices();
+        return true;
+    }
+
+    bool changed = false;
+    for (auto index : pending_) {
+        // A degenerate hull is rebuilt from all the contacts, including the pending ones.
+        if (hull_.size() < 3) {
+            rebuild();
+            changed = true;
+            break;
+        }
+        changed = insert(index) || changed;
+    }
+    if (changed) {
+        updateVertices();
+    }
+    return changed;
+}
+
+void ContactHull::clear()
+{
+    contacts_.clear();
+    hull_.clear();
+    vertices_.clear();
+}
+
+bool ContactHull::insert(size_t index)
+{
+    const size_t n = hull_.size();
+    const auto & p = contacts_[index].position;
+    auto visible = [this, &p, n](size_t i) {
+        return cross(contacts_[hull_[i]].position, contacts_[hull_[(i + 1) % n]].position, p) < 0;
+    };
+
+    // The edges visible from an outer point form a single chain, from first to last.
+    size_t first = n;
+    for (size_t i = 0; i < n; i++) {
+        if (visible(i) && !visible((i + n - 1) % n)) {
+            first = i;
+            break;
+        }
+    }
+    if (first == n) {
+        // The point lies inside the hull.
+        contacts_[index].on_hull = false;
+        return false;
+    }
+    size_t last = first;
+    while (visible((last + 1) % n)) {
+        last = (last + 1) % n;
+    }
+
+    // Keep the vertices from the end of the chain to its start, then close the hull with the point.
+    next_hull_.clear();
+    for (size_t i = (first + 1) % n; i != (last + 1) % n; i = (i + 1) % n) {
+        contacts_[hull_[i]].on_hull = false;
+    }
+    for (size_t i = (last + 1) % n; ; i = (i + 1) % n) {
+        next_hull_.push_back(hull_[i]);
+        if (i == first) {
+            break;
+        }
+    }
+    next_hull_.push_back(index);
+    contacts_[index].on_hull = true;
+
+    hull_.swap(next_hull_);
+    return true;
+}
+
+void ContactHull::rebuild()
+{
+    // Andrew's monotone chain.
+    order_.resize(contacts_.size());
+    for (size_t i = 0; i < contacts_.size(); i++) {
+        order_[i] = i;
+        contacts_[i].on_hull = false;
+    }
+    std::sort(
+        order_.begin(), order_.end(),
+        [this](size_t a, size_t b) {
+            const auto & pa = contacts_[a].position;
+            const auto & pb = contacts_[b].position;
+            return pa.x < pb.x || (pa.x == pb.x && pa.y < pb.y);
+        });
+
+    hull_.clear();
+    if (order_.size() < 3) {
+        hull_ = order_;
+    } else {
+        hull_.resize(2 * order_.size());
+        size_t k = 0;
+        auto build_chain = [this, &k](size_t index, size_t min_size) {
+            while (k >= min_size &&
+                cross(
+                    contacts_[hull_[k - 2]].position, contacts_[hull_[k - 1]].position,
+                    contacts_[index].position) <= 0)
+            {
+                k--;
+            }
+            hull_[k++] = index;
+        };
+
+        for (size_t i = 0; i < order_.size(); i++) {
+            build_chain(order_[i], 2);
+        }
+        const size_t lower_size = k + 1;
+        for (size_t i = order_.size() - 1; i-- > 0; ) {
+            build_chain(order_[i], lower_size);
+        }
+        hull_.resize(k - 1);
+    }
+
+    for (auto index : hull_) {
+        contacts_[index].on_hull = true;
+    }
+}
+
+void ContactHull::updateVertices()
+{
+    vertices_.clear();
+    for (auto index : hull_) {
+        vertices_.push_back(contacts_[index].position);
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
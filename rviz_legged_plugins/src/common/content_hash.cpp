@@ -0,0 +1,14 @@
+#include "rviz_legged_plugins/common/content_hash.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+void ContentHash::add(const void * data, size_t size)
+{
+    const auto * bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++) {
+        value_ = (value_ ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,97 @@
+#include "rviz_legged_plugins/common/frame_budget.hpp"
+
+#include <algorithm>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+// Weight of a new frame in the smoothed render time.
+constexpr float kSmoothing = 0.1f;
+// Wall time over the budget before the quality is reduced, and under the restore threshold before it
+// is raised again: slower, so that a restored level does not immediately overrun again.
+constexpr float kDegradeDelay = 0.5f;
+constexpr float kRestoreDelay = 2.0f;
+// Fraction of the budget the render time must stay under for the quality to be raised.
+constexpr float kRestoreThreshold = 0.7f;
+// Frames longer than this, e.g. a stall of the render thread, are not counted.
+constexpr float kMaxRenderTime = 1.0f;
+
+}  // namespace
+
+FrameBudget & FrameBudget::instance()
+{
+    static FrameBudget frame_budget;
+    return frame_budget;
+}
+
+void FrameBudget::setBudget(const void * client, float budget)
+{
+    if (budget > 0.0f) {
+        budgets_[client] = budget;
+    } else {
+        budgets_.erase(client);
+    }
+
+    budget_ = 0.0f;
+    for (const auto & entry : budgets_) {
+        budget_ = budget_ > 0.0f ? std::min(budget_, entry.second) : entry.second;
+    }
+    if (budgets_.empty()) {
+        setLevel(FULL_QUALITY);
+    }
+    time_over_budget_ = 0.0f;
+    time_under_budget_ = 0.0f;
+}
+
+void FrameBudget::addFrame(float render_time, float interval)
+{
+    if (budget_ <= 0.0f || render_time > kMaxRenderTime) {
+        return;
+    }
+
+    frame_time_ = frame_time_ > 0.0f ?
+        frame_time_ + kSmoothing * (render_time - frame_time_) : render_time;
+
+    // The delays are counted in wall time, whatever the share of the frames spent rendering.
+    interval = std::min(interval, kMaxRenderTime);
+    time_over_budget_ = frame_time_ > budget_ ? time_over_budget_ + interval : 0.0f;
+    time_under_budget_ =
+        frame_time_ < kRestoreThreshold * budget_ ? time_under_budget_ + interval : 0.0f;
+
+    if (time_over_budget_ >= kDegradeDelay && level_ < kMaxLevel) {
+        setLevel(static_cast<Level>(level_ + 1));
+    } else if (time_under_budget_ >= kRestoreDelay && level_ > FULL_QUALITY) {
+        setLevel(static_cast<Level>(level_ - 1));
+    }
+}
+
+const char * FrameBudget::levelName(Level level)
+{
+    switch (level) {
+        case REDUCED_HISTORY:
+            return "reduced history";
+        case REDUCED_POSE_MARKERS:
+            return "reduced pose markers";
+        case REDUCED_CONE_DETAIL:
+            return "reduced cone detail";
+        case REDUCED_UPDATE_RATE:
+            return "reduced update rate";
+        default:
+            return "full quality";
+    }
+}
+
+void FrameBudget::setLevel(Level level)
+{
+    time_over_budget_ = 0.0f;
+    time_under_budget_ = 0.0f;
+    if (level != level_) {
+        level_ = level;
+        revision_++;
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
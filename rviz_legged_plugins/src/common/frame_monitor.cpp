@@ -0,0 +1,55 @@
+#include "rviz_legged_plugins/common/frame_monitor.hpp"
+
+#include <OgreRoot.h>
+
+#include "rviz_legged_plugins/common/frame_budget.hpp"
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+std::shared_ptr<FrameMonitor> FrameMonitor::acquire()
+{
+    static std::weak_ptr<FrameMonitor> monitor;
+    auto shared = monitor.lock();
+    if (!shared) {
+        shared.reset(new FrameMonitor());
+        monitor = shared;
+    }
+    return shared;
+}
+
+FrameMonitor::FrameMonitor()
+{
+    Ogre::Root::getSingleton().addFrameListener(this);
+}
+
+FrameMonitor::~FrameMonitor()
+{
+    if (auto * root = Ogre::Root::getSingletonPtr()) {
+        root->removeFrameListener(this);
+    }
+}
+
+bool FrameMonitor::frameStarted(const Ogre::FrameEvent & event)
+{
+    (void)event;
+    TraceRecorder::instance().addInstantEvent("render frame", "Render");
+    frame_start_ = std::chrono::steady_clock::now();
+    frame_started_ = true;
+    return true;
+}
+
+bool FrameMonitor::frameRenderingQueued(const Ogre::FrameEvent & event)
+{
+    // A monitor added during a frame sees its end only.
+    if (frame_started_) {
+        frame_started_ = false;
+        FrameBudget::instance().addFrame(
+            std::chrono::duration<float>(std::chrono::steady_clock::now() - frame_start_).count(),
+            event.timeSinceLastFrame);
+    }
+    return true;
+}
+
+}  // namespace rviz_legged_plugins::common
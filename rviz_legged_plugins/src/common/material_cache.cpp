@@ -0,0 +1,129 @@
+#include "rviz_legged_plugins/common/material_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <OgreMaterialManager.h>
+#include <OgreTechnique.h>
+
+#include "rviz_rendering/material_manager.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+/** @brief Color component quantized to 8 bits, the resolution of the color properties. */
+int quantize(float component)
+{
+    return static_cast<int>(std::lround(255.0f * std::min(std::max(component, 0.0f), 1.0f)));
+}
+
+std::string solidColorKey(const Ogre::ColourValue & color)
+{
+    return "SolidColor_" + std::to_string(quantize(color.r)) + "_" +
+           std::to_string(quantize(color.g)) + "_" + std::to_string(quantize(color.b)) + "_" +
+           std::to_string(quantize(color.a));
+}
+
+/** @brief Same state as the materials of rviz_rendering::Shape. */
+void applySolidColor(const Ogre::MaterialPtr & material, const Ogre::ColourValue & color)
+{
+    auto technique = material->getTechnique(0);
+    technique->setLightingEnabled(true);
+    technique->setAmbient(color * 0.5f);
+    technique->setDiffuse(color);
+    rviz_rendering::MaterialManager::enableAlphaBlending(material, color.a);
+}
+
+}  // namespace
+
+MaterialCache & MaterialCache::instance()
+{
+    static MaterialCache cache;
+    return cache;
+}
+
+template<typename Setup>
+MaterialCache::Handle MaterialCache::acquire(const std::string & key, Setup setup)
+{
+    auto & entry = materials_[key];
+    if (auto handle = entry.lock()) {
+        return handle;
+    }
+
+    // Restyled materials keep their name, which may therefore differ from their key.
+    static int count = 0;
+    auto material = rviz_rendering::MaterialManager::createMaterialWithNoLighting(
+        "LeggedSharedMaterial" + std::to_string(count++) + "/" + key);
+    setup(material);
+
+    Handle handle(
+        new Ogre::MaterialPtr(material),
+        [this, key](const Ogre::MaterialPtr * material) {
+            Ogre::MaterialManager::getSingleton().remove((*material)->getHandle());
+            delete material;
+            release(key);
+        });
+    entry = handle;
+    return handle;
+}
+
+void MaterialCache::release(const std::string & key)
+{
+    // The entry may already hold a newer material with the same key.
+    auto it = materials_.find(key);
+    if (it != materials_.end() && it->second.expired()) {
+        materials_.erase(it);
+    }
+}
+
+MaterialCache::Handle MaterialCache::vertexColorMaterial(bool transparent, bool two_sided)
+{
+    std::string key = std::string("VertexColor") +
+        (transparent ? "_Transparent" : "_Opaque") + (two_sided ? "_TwoSided" : "");
+
+    return acquire(
+        key, [transparent, two_sided](Ogre::MaterialPtr & material) {
+            rviz_rendering::MaterialManager::enableAlphaBlending(material, transparent ? 0.0f : 1.0f);
+            if (two_sided) {
+                material->getTechnique(0)->setCullingMode(Ogre::CULL_NONE);
+            }
+        });
+}
+
+MaterialCache::Handle MaterialCache::solidColorMaterial(const Ogre::ColourValue & color)
+{
+    return acquire(
+        solidColorKey(color), [color](Ogre::MaterialPtr & material) {
+            applySolidColor(material, color);
+        });
+}
+
+bool MaterialCache::restyleSolidColor(Handle & handle, const Ogre::ColourValue & color)
+{
+    if (!handle || handle.use_count() > 1) {
+        handle = solidColorMaterial(color);
+        return false;
+    }
+
+    // Nobody else holds the material: it is updated in place and filed under its new key, unless
+    // another material already has it.
+    for (auto it = materials_.begin(); it != materials_.end(); ++it) {
+        if (it->second.lock() == handle) {
+            materials_.erase(it);
+            break;
+        }
+    }
+    applySolidColor(*handle, color);
+
+    auto & entry = materials_[solidColorKey(color)];
+    if (entry.expired()) {
+        entry = handle;
+    }
+    return true;
+}
+
+}  // namespace rviz_legged_plugins::common
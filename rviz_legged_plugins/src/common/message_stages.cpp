@@ -0,0 +1,133 @@
+#include "rviz_legged_plugins/common/message_stages.hpp"
+
+#include "rviz_common/validate_floats.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+const char * describe(MessageError error)
+{
+    switch (error) {
+        case MessageError::LAYOUT:
+            return "The arrays of the message do not match its number of contacts";
+        case MessageError::FRAME_INDEX:
+            return "Message contained a frame index out of the frame_ids table";
+        case MessageError::INVALID_FLOATS:
+            return "Message contained invalid floating point values (nans or infs)";
+        case MessageError::NONE:
+        default:
+            return "OK";
+    }
+}
+
+MessageError readWrenches(
+    const rviz_legged_msgs::msg::WrenchesStamped & msg, bool accept_nan,
+    std::vector<WrenchSample> & samples)
+{
+    samples.clear();
+    for (const auto & wrench_stamped : msg.wrenches_stamped) {
+        WrenchSample sample;
+        if (!wrenchToSample(wrench_stamped.wrench, accept_nan, sample)) {
+            return MessageError::INVALID_FLOATS;
+        }
+        samples.push_back(sample);
+    }
+    return MessageError::NONE;
+}
+
+MessageError readPackedWrenches(
+    const rviz_legged_msgs::msg::WrenchesPacked & msg, bool accept_nan,
+    std::vector<WrenchSample> & samples)
+{
+    samples.clear();
+    const size_t n_contacts = msg.frame_indices.size();
+    if (msg.forces.size() != 3 * n_contacts ||
+        (!msg.torques.empty() && msg.torques.size() != 3 * n_contacts))
+    {
+        return MessageError::LAYOUT;
+    }
+    for (auto frame_index : msg.frame_indices) {
+        if (frame_index >= msg.frame_ids.size()) {
+            return MessageError::FRAME_INDEX;
+        }
+    }
+
+    for (size_t i = 0; i < n_contacts; i++) {
+        WrenchSample sample;
+        if (!packedWrenchToSample(msg.forces, msg.torques, i, accept_nan, sample)) {
+            return MessageError::INVALID_FLOATS;
+        }
+        samples.push_back(sample);
+    }
+    return MessageError::NONE;
+}
+
+MessageError validateCones(const rviz_legged_msgs::msg::FrictionCones & msg)
+{
+    for (const auto & cone : msg.friction_cones) {
+        if (!rviz_common::validateFloats(cone.normal_direction) ||
+            !rviz_common::validateFloats(cone.friction_coefficient))
+        {
+            return MessageError::INVALID_FLOATS;
+        }
+    }
+    return MessageError::NONE;
+}
+
+MessageError validatePackedCones(const rviz_legged_msgs::msg::FrictionConesPacked & msg)
+{
+    const size_t n_cones = msg.frame_indices.size();
+    if (msg.normal_directions.size() != 3 * n_cones || msg.friction_coefficients.size() != n_cones) {
+        return MessageError::LAYOUT;
+    }
+    if (!rviz_common::validateFloats(msg.normal_directions) ||
+        !rviz_common::validateFloats(msg.friction_coefficients))
+    {
+        return MessageError::INVALID_FLOATS;
+    }
+    for (auto frame_index : msg.frame_indices) {
+        if (frame_index >= msg.frame_ids.size()) {
+            return MessageError::FRAME_INDEX;
+        }
+    }
+    return MessageError::NONE;
+}
+
+void readCones(
+    const rviz_legged_msgs::msg::FrictionCones & msg, std::vector<Ogre::Vector3> & normals,
+    std::vector<float> & friction_coefficients)
+{
+    normals.clear();
+    friction_coefficients.clear();
+    for (const auto & cone : msg.friction_cones) {
+        normals.emplace_back(
+            static_cast<float>(cone.normal_direction.x), static_cast<float>(cone.normal_direction.y),
+            static_cast<float>(cone.normal_direction.z));
+        friction_coefficients.push_back(static_cast<float>(cone.friction_coefficient));
+    }
+}
+
+void readPackedCones(
+    const rviz_legged_msgs::msg::FrictionConesPacked & msg, std::vector<Ogre::Vector3> & normals,
+    std::vector<float> & friction_coefficients)
+{
+    normals.clear();
+    friction_coefficients.clear();
+    for (size_t i = 0; i < msg.frame_indices.size(); i++) {
+        normals.emplace_back(
+            msg.normal_directions[3 * i], msg.normal_directions[3 * i + 1], msg.normal_directions[3 * i + 2]);
+        friction_coefficients.push_back(static_cast<float>(msg.friction_coefficients[i]));
+    }
+}
+
+MessageError validatePaths(const rviz_legged_msgs::msg::Paths & msg)
+{
+    for (const auto & path : msg.paths) {
+        if (!rviz_common::validateFloats(path.poses)) {
+            return MessageError::INVALID_FLOATS;
+        }
+    }
+    return MessageError::NONE;
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,199 @@
+#include "rviz_legged_plugins/common/pose_marker_material.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <string>
+
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
+#include <OgrePass.h>
+#include <OgreTechnique.h>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+constexpr size_t kSegments = 6;
+
+/**
+ * Cross-section of a marker part: its offset along the axis and its radius, as weights of the
+ * lengths and radii of the material (shaft and head of the arrows, axes).
+ */
+struct Station
+{
+    Ogre::Vector3 length;
+    Ogre::Vector3 radius;
+};
+
+/** Frame of a marker part: its axis and two radial directions, and its colour. */
+struct Part
+{
+    Ogre::Vector3 axis;
+    Ogre::Vector3 side;
+    Ogre::Vector3 up;
+    Ogre::ColourValue colour;
+    // 1 for the arrows, which take the arrow colour of the material.
+    float arrow;
+};
+
+class PartWriter
+{
+public:
+    PartWriter(Ogre::ManualObject & manual_object, const Ogre::Vector3 & position, const Part & part)
+    : manual_object_(manual_object), position_(position), part_(part) {}
+
+    /** Side of the part between two cross-sections, with radial normals. */
+    void addSide(const Station & from, const Station & to)
+    {
+        for (size_t k = 0; k < kSegments; k++) {
+            auto a = radial(k);
+            auto b = radial(k + 1);
+            vertex(from, a, a);
+            vertex(to, a, a);
+            vertex(to, b, b);
+            vertex(from, a, a);
+            vertex(to, b, b);
+            vertex(from, b, b);
+        }
+    }
+
+    /** Disk closing a cross-section, facing normal_sign times the axis. */
+    void addCap(const Station & station, float normal_sign)
+    {
+        Station center{station.length, Ogre::Vector3::ZERO};
+        auto normal = normal_sign * part_.axis;
+        for (size_t k = 0; k < kSegments; k++) {
+            vertex(center, Ogre::Vector3::ZERO, normal);
+            vertex(station, radial(k), normal);
+            vertex(station, radial(k + 1), normal);
+        }
+    }
+
+private:
+    Ogre::Vector3 radial(size_t k) const
+    {
+        float angle = 2.0f * static_cast<float>(M_PI) * static_cast<float>(k) / kSegments;
+        return std::cos(angle) * part_.side + std::sin(angle) * part_.up;
+    }
+
+    void vertex(const Station & station, const Ogre::Vector3 & radial, const Ogre::Vector3 & normal)
+    {
+        manual_object_.position(position_);
+        manual_object_.normal(normal);
+        manual_object_.colour(part_.colour);
+        manual_object_.textureCoord(part_.axis.x, part_.axis.y, part_.axis.z, part_.arrow);
+        manual_object_.textureCoord(radial);
+        manual_object_.textureCoord(station.length);
+        manual_object_.textureCoord(station.radius);
+    }
+
+    Ogre::ManualObject & manual_object_;
+    Ogre::Vector3 position_;
+    Part part_;
+};
+
+constexpr size_t kSideVertexCount = 6 * kSegments;
+constexpr size_t kCapVertexCount = 3 * kSegments;
+
+}  // namespace
+
+const size_t PoseMarkerMaterial::kArrowVertexCount = 2 * kSideVertexCount + 2 * kCapVertexCount;
+const size_t PoseMarkerMaterial::kAxesVertexCount = 3 * (kSideVertexCount + kCapVertexCount);
+
+PoseMarkerMaterial::PoseMarkerMaterial()
+{
+    // Each instance has its own parameters, hence its own clone of the material script.
+    static int count = 0;
+    auto base = Ogre::MaterialManager::getSingleton().getByName(
+        "rviz_legged_plugins/PoseMarkers", "rviz_rendering");
+    material_ = base->clone("PoseMarkerMaterial" + std::to_string(count++));
+    material_->load();
+}
+
+PoseMarkerMaterial::~PoseMarkerMaterial()
+{
+    Ogre::MaterialManager::getSingleton().remove(material_->getHandle());
+}
+
+void PoseMarkerMaterial::setArrowGeometry(
+    float shaft_length, float shaft_diameter, float head_length, float head_diameter)
+{
+    lengths_.x = shaft_length;
+    lengths_.y = head_length;
+    radii_.x = 0.5f * shaft_diameter;
+    radii_.y = 0.5f * head_diameter;
+    setSizes();
+}
+
+void PoseMarkerMaterial::setAxesGeometry(float length, float radius)
+{
+    lengths_.z = length;
+    radii_.z = radius;
+    setSizes();
+}
+
+void PoseMarkerMaterial::setSizes()
+{
+    auto parameters = material_->getTechnique(0)->getPass(0)->getVertexProgramParameters();
+    parameters->setNamedConstant("lengths", lengths_);
+    parameters->setNamedConstant("radii", radii_);
+}
+
+void PoseMarkerMaterial::setArrowColor(const Ogre::ColourValue & color)
+{
+    material_->getTechnique(0)->getPass(0)->getVertexProgramParameters()->setNamedConstant(
+        "arrow_colour", color);
+}
+
+float PoseMarkerMaterial::extent() const
+{
+    float arrow =
+        std::abs(lengths_.x) + std::abs(lengths_.y) + std::max(std::abs(radii_.x), std::abs(radii_.y));
+    float axes = std::abs(lengths_.z) + std::abs(radii_.z);
+    return std::max(arrow, axes);
+}
+
+void PoseMarkerMaterial::addArrow(
+    Ogre::ManualObject & manual_object, const Ogre::Vector3 & position,
+    const Ogre::Quaternion & orientation)
+{
+    Part part{
+        orientation * Ogre::Vector3::UNIT_X, orientation * Ogre::Vector3::UNIT_Y,
+        orientation * Ogre::Vector3::UNIT_Z, Ogre::ColourValue::White, 1.0f};
+    Station tail{Ogre::Vector3::ZERO, Ogre::Vector3::UNIT_X};
+    Station shaft_end{Ogre::Vector3::UNIT_X, Ogre::Vector3::UNIT_X};
+    Station head_base{Ogre::Vector3::UNIT_X, Ogre::Vector3::UNIT_Y};
+    Station tip{Ogre::Vector3(1.0f, 1.0f, 0.0f), Ogre::Vector3::ZERO};
+
+    PartWriter writer(manual_object, position, part);
+    writer.addCap(tail, -1.0f);
+    writer.addSide(tail, shaft_end);
+    writer.addCap(head_base, -1.0f);
+    writer.addSide(head_base, tip);
+}
+
+void PoseMarkerMaterial::addAxes(
+    Ogre::ManualObject & manual_object, const Ogre::Vector3 & position,
+    const Ogre::Quaternion & orientation)
+{
+    Ogre::Vector3 x = orientation * Ogre::Vector3::UNIT_X;
+    Ogre::Vector3 y = orientation * Ogre::Vector3::UNIT_Y;
+    Ogre::Vector3 z = orientation * Ogre::Vector3::UNIT_Z;
+    Station base{Ogre::Vector3::ZERO, Ogre::Vector3::UNIT_Z};
+    Station end{Ogre::Vector3::UNIT_Z, Ogre::Vector3::UNIT_Z};
+
+    for (const auto & part : {
+            Part{x, y, z, Ogre::ColourValue::Red, 0.0f},
+            Part{y, z, x, Ogre::ColourValue::Green, 0.0f},
+            Part{z, x, y, Ogre::ColourValue::Blue, 0.0f}})
+    {
+        PartWriter writer(manual_object, position, part);
+        writer.addSide(base, end);
+        writer.addCap(end, 1.0f);
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
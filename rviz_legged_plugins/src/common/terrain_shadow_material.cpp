@@ -0,0 +1,64 @@
+#include "rviz_legged_plugins/common/terrain_shadow_material.hpp"
+
+#include <initializer_list>
+#include <string>
+
+#include <OgreMaterialManager.h>
+#include <OgrePass.h>
+#include <OgreTechnique.h>
+#include <OgreVector4.h>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+// The first pass draws the lines, the second one their shadow.
+constexpr unsigned short kLinesPass = 0;
+constexpr unsigned short kShadowPass = 1;
+
+}  // namespace
+
+TerrainShadowMaterial::TerrainShadowMaterial()
+{
+    // Each instance has its own plane, hence its own clones of the material script.
+    static int count = 0;
+    auto base = Ogre::MaterialManager::getSingleton().getByName(
+        "rviz_legged_plugins/TerrainShadow", "rviz_rendering");
+    opaque_material_ = base->clone("TerrainShadowMaterial" + std::to_string(count) + "_Opaque");
+    opaque_material_->load();
+
+    transparent_material_ = base->clone("TerrainShadowMaterial" + std::to_string(count) + "_Transparent");
+    auto * lines_pass = transparent_material_->getTechnique(0)->getPass(kLinesPass);
+    lines_pass->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+    lines_pass->setDepthWriteEnabled(false);
+    transparent_material_->load();
+    count++;
+}
+
+TerrainShadowMaterial::~TerrainShadowMaterial()
+{
+    Ogre::MaterialManager::getSingleton().remove(opaque_material_->getHandle());
+    Ogre::MaterialManager::getSingleton().remove(transparent_material_->getHandle());
+}
+
+void TerrainShadowMaterial::setPlane(const TerrainPlane & plane)
+{
+    auto normal = plane.normal.normalisedCopy();
+    Ogre::Vector4 coefficients(normal.x, normal.y, normal.z, normal.dotProduct(plane.point));
+    for (const auto & material : {opaque_material_, transparent_material_}) {
+        material->getTechnique(0)->getPass(kShadowPass)->getVertexProgramParameters()->setNamedConstant(
+            "plane", coefficients);
+    }
+}
+
+void TerrainShadowMaterial::setShadowAlpha(float alpha)
+{
+    for (const auto & material : {opaque_material_, transparent_material_}) {
+        material->getTechnique(0)->getPass(kShadowPass)->getVertexProgramParameters()->setNamedConstant(
+            "shadow_alpha", alpha);
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,78 @@
+#include "rviz_legged_plugins/common/timeline.hpp"
+
+#include <algorithm>
+
+#include "rviz_legged_plugins/common/timeline_store.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+Timeline & Timeline::instance()
+{
+    static Timeline timeline;
+    return timeline;
+}
+
+void Timeline::registerStore(const TimelineStore * store)
+{
+    if (std::find(stores_.begin(), stores_.end(), store) == stores_.end()) {
+        stores_.push_back(store);
+    }
+}
+
+void Timeline::unregisterStore(const TimelineStore * store)
+{
+    stores_.erase(std::remove(stores_.begin(), stores_.end(), store), stores_.end());
+}
+
+bool Timeline::recordedRange(int64_t & oldest_ns, int64_t & newest_ns) const
+{
+    bool found = false;
+    for (const auto * store : stores_) {
+        if (store->empty()) {
+            continue;
+        }
+        oldest_ns = found ? std::min(oldest_ns, store->oldestStamp()) : store->oldestStamp();
+        newest_ns = found ? std::max(newest_ns, store->newestStamp()) : store->newestStamp();
+        found = true;
+    }
+    return found;
+}
+
+size_t Timeline::memoryUsage() const
+{
+    size_t bytes = 0;
+    for (const auto * store : stores_) {
+        bytes += store->memoryUsage();
+    }
+    return bytes;
+}
+
+size_t Timeline::spilledBytes() const
+{
+    size_t bytes = 0;
+    for (const auto * store : stores_) {
+        bytes += store->spilledBytes();
+    }
+    return bytes;
+}
+
+void Timeline::scrubTo(int64_t stamp_ns)
+{
+    if (scrubbing_ && scrub_time_ns_ == stamp_ns) {
+        return;
+    }
+    scrubbing_ = true;
+    scrub_time_ns_ = stamp_ns;
+    revision_++;
+}
+
+void Timeline::goLive()
+{
+    if (scrubbing_) {
+        scrubbing_ = false;
+        revision_++;
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
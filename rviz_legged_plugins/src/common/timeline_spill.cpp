@@ -0,0 +1,179 @@
+#include "rviz_legged_plugins/common/timeline_spill.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'R', 'V', 'L', 'G', 'T', 'M', 'L', '1'};
+constexpr size_t kHeaderBytes = 16;
+// The mappings grow geometrically, from at least this size, so that they are rarely remapped.
+constexpr size_t kMinMappingBytes = size_t{1} << 20;
+
+bool writeAll(int fd, const void * data, size_t bytes, size_t offset)
+{
+    const auto * bytes_data = static_cast<const char *>(data);
+    while (bytes > 0) {
+        auto written = pwrite(fd, bytes_data, bytes, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes_data += written;
+        bytes -= static_cast<size_t>(written);
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+}  // namespace
+
+TimelineSpill::TimelineSpill(size_t columns)
+: columns_(columns)
+{
+}
+
+TimelineSpill::~TimelineSpill()
+{
+    close();
+}
+
+bool TimelineSpill::open(const std::string & directory, std::string & error)
+{
+    close();
+
+    // The displays of a process, and the processes, have their own files.
+    static std::atomic<int> counter{0};
+    base_path_ = directory + "/rviz_legged_timeline_" + std::to_string(getpid()) + "_" +
+        std::to_string(counter++);
+
+    for (auto [fd, extension] : {std::pair{&data_fd_, ".data"}, std::pair{&index_fd_, ".index"}}) {
+        *fd = ::open((base_path_ + extension).c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (*fd < 0) {
+            error = "Cannot create " + base_path_ + extension + ": " + std::strerror(errno);
+            close();
+            return false;
+        }
+    }
+
+    char header[kHeaderBytes] = {};
+    auto columns = static_cast<uint32_t>(columns_);
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    std::memcpy(header + sizeof(kMagic), &columns, sizeof(columns));
+    if (!writeAll(data_fd_, header, kHeaderBytes, 0)) {
+        error = "Cannot write " + base_path_ + ".data: " + std::strerror(errno);
+        close();
+        return false;
+    }
+    data_bytes_ = kHeaderBytes;
+    size_ = 0;
+    return true;
+}
+
+void TimelineSpill::close()
+{
+    unmap(data_mapping_);
+    unmap(index_mapping_);
+    for (int * fd : {&data_fd_, &index_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!base_path_.empty()) {
+        unlink((base_path_ + ".data").c_str());
+        unlink((base_path_ + ".index").c_str());
+        base_path_.clear();
+    }
+    data_bytes_ = 0;
+    size_ = 0;
+}
+
+bool TimelineSpill::append(int64_t stamp_ns, const float * values, size_t rows)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    Entry entry{stamp_ns, data_bytes_, rows};
+    size_t bytes = rows * columns_ * sizeof(float);
+    if (!writeAll(data_fd_, values, bytes, data_bytes_) ||
+        !writeAll(index_fd_, &entry, sizeof(entry), size_ * sizeof(Entry)))
+    {
+        return false;
+    }
+    data_bytes_ += bytes;
+    size_++;
+    return true;
+}
+
+void TimelineSpill::clear()
+{
+    if (!isOpen()) {
+        return;
+    }
+    // The pages beyond the new end of the files must not stay mapped.
+    unmap(data_mapping_);
+    unmap(index_mapping_);
+    if (ftruncate(data_fd_, kHeaderBytes) == 0 && ftruncate(index_fd_, 0) == 0) {
+        data_bytes_ = kHeaderBytes;
+        size_ = 0;
+    }
+}
+
+TimelineSpill::Entry TimelineSpill::entry(size_t index) const
+{
+    Entry entry{0, 0, 0};
+    const char * index_data = map(index_mapping_, index_fd_, (index + 1) * sizeof(Entry));
+    if (index_data) {
+        std::memcpy(&entry, index_data + index * sizeof(Entry), sizeof(Entry));
+    }
+    return entry;
+}
+
+const float * TimelineSpill::values(const Entry & entry) const
+{
+    size_t end = entry.offset + entry.rows * columns_ * sizeof(float);
+    const char * data = map(data_mapping_, data_fd_, std::max<size_t>(end, kHeaderBytes));
+    return data ? reinterpret_cast<const float *>(data + entry.offset) : nullptr;
+}
+
+const char * TimelineSpill::map(Mapping & mapping, int fd, size_t bytes)
+{
+    if (!mapping.address || bytes > mapping.bytes) {
+        // The mapping may extend beyond the end of the file, whose pages are never accessed.
+        size_t mapping_bytes =
+            std::max({bytes, mapping.address ? 2 * mapping.bytes : 0, kMinMappingBytes});
+        unmap(mapping);
+        void * address = mmap(nullptr, mapping_bytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED) {
+            mapping.address = address;
+            mapping.bytes = mapping_bytes;
+        }
+    }
+    return static_cast<const char *>(mapping.address);
+}
+
+void TimelineSpill::unmap(Mapping & mapping)
+{
+    if (mapping.address) {
+        munmap(mapping.address, mapping.bytes);
+    }
+    mapping.address = nullptr;
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,147 @@
+#include "rviz_legged_plugins/common/timeline_store.hpp"
+
+#include <algorithm>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+// Every record reserves room for its index entry in the ring, hence the index never takes more
+// memory than the ring, which is allocated half of the memory limit.
+constexpr size_t kEntryFloats = 8;
+
+// A stamp older than the newest record by more than this starts the recording again, e.g. after a
+// bag looped. Less, it is a late message, e.g. from another topic of the display, and is dropped.
+constexpr int64_t kRestartThresholdNs = 1000000000;
+
+}  // namespace
+
+TimelineStore::TimelineStore(size_t columns)
+: columns_(std::max<size_t>(columns, 1)),
+  spill_(columns_)
+{
+}
+
+void TimelineStore::setMemoryLimit(size_t bytes)
+{
+    clear();
+    memory_limit_ = bytes;
+    // The ring is allocated on the first append, recording being disabled by default.
+    values_.clear();
+    values_.shrink_to_fit();
+}
+
+float * TimelineStore::append(int64_t stamp_ns, size_t rows)
+{
+    size_t capacity = memory_limit_ / (2 * sizeof(float));
+    size_t size = rows * columns_ + kEntryFloats;
+    if (size > capacity) {
+        return nullptr;
+    }
+    if (values_.size() != capacity) {
+        values_.assign(capacity, 0.0f);
+    }
+    if (!empty() && stamp_ns < newestStamp()) {
+        if (newestStamp() - stamp_ns <= kRestartThresholdNs) {
+            return nullptr;
+        }
+        clear();
+    }
+
+    size_t offset = records_.empty() ? 0 : records_.back().offset + records_.back().size;
+    if (offset + size > capacity) {
+        // The record wraps to the start of the ring: the records stored after the write position,
+        // the oldest ones, are dropped first.
+        while (!records_.empty() && records_.front().offset >= offset) {
+            dropOldest();
+        }
+        offset = 0;
+    }
+    while (!records_.empty() && records_.front().offset >= offset &&
+        records_.front().offset < offset + size)
+    {
+        dropOldest();
+    }
+
+    records_.push_back({stamp_ns, offset, rows, size});
+    return values_.data() + offset;
+}
+
+bool TimelineStore::openSpill(const std::string & directory, std::string & error)
+{
+    return spill_.open(directory, error);
+}
+
+void TimelineStore::dropOldest()
+{
+    const auto & entry = records_.front();
+    if (spill_.isOpen()) {
+        spill_.append(entry.stamp_ns, values_.data() + entry.offset, entry.rows);
+    }
+    records_.pop_front();
+}
+
+std::optional<size_t> TimelineStore::seek(int64_t stamp_ns) const
+{
+    size_t spilled = spill_.size();
+    if (!records_.empty() && stamp_ns >= records_.front().stamp_ns) {
+        auto after = std::upper_bound(
+            records_.begin(), records_.end(), stamp_ns,
+            [](int64_t stamp, const Entry & entry) {return stamp < entry.stamp_ns;});
+        return spilled + static_cast<size_t>(after - records_.begin()) - 1;
+    }
+
+    // The spilled records are older than those of the ring; only the index pages read by the
+    // search are paged in.
+    size_t first = 0;
+    size_t last = spilled;
+    while (first < last) {
+        size_t middle = first + (last - first) / 2;
+        if (spill_.entry(middle).stamp_ns <= stamp_ns) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    if (first == 0) {
+        return std::nullopt;
+    }
+    return first - 1;
+}
+
+TimelineStore::Record TimelineStore::record(size_t index) const
+{
+    if (index < spill_.size()) {
+        auto entry = spill_.entry(index);
+        const float * values = spill_.values(entry);
+        return {entry.stamp_ns, values ? static_cast<size_t>(entry.rows) : 0, values};
+    }
+
+    const auto & entry = records_[index - spill_.size()];
+    return {entry.stamp_ns, entry.rows, values_.data() + entry.offset};
+}
+
+int64_t TimelineStore::oldestStamp() const
+{
+    return spill_.size() > 0 ? spill_.entry(0).stamp_ns : records_.front().stamp_ns;
+}
+
+int64_t TimelineStore::newestStamp() const
+{
+    return records_.empty() ? spill_.entry(spill_.size() - 1).stamp_ns : records_.back().stamp_ns;
+}
+
+void TimelineStore::clear()
+{
+    records_.clear();
+    spill_.clear();
+}
+
+size_t TimelineStore::memoryUsage() const
+{
+    return values_.capacity() * sizeof(float) + records_.size() * sizeof(Entry);
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,29 @@
+#include "rviz_legged_plugins/common/topic_pattern.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+std::regex globToRegex(const std::string & glob)
+{
+    std::string pattern;
+    for (char c : glob) {
+        switch (c) {
+            case '*':
+                pattern += "[^/]*";
+                break;
+            case '?':
+                pattern += "[^/]";
+                break;
+            case '.': case '+': case '(': case ')': case '[': case ']':
+            case '{': case '}': case '^': case '$': case '|': case '\\':
+                pattern += '\\';
+                pattern += c;
+                break;
+            default:
+                pattern += c;
+        }
+    }
+    return std::regex(pattern);
+}
+
+}  // namespace rviz_legged_plugins::common
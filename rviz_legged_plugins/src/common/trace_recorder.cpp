@@ -0,0 +1,167 @@
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+// Number of buffered events after which they are written to the file.
+constexpr size_t kFlushThreshold = 4096;
+}  // namespace
+
+TraceRecorder & TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder()
+{
+    const char * path = std::getenv("RVIZ_LEGGED_TRACE_FILE");
+    if (path == nullptr || path[0] == '\0') {
+        return;
+    }
+
+    file_.open(path, std::ios::out | std::ios::trunc);
+    if (!file_.is_open()) {
+        return;
+    }
+
+    enabled_ = true;
+    process_id_ = static_cast<int>(getpid());
+    events_.reserve(kFlushThreshold);
+
+    file_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    if (!enabled_) {
+        return;
+    }
+
+    flush();
+    file_ << "\n]}\n";
+    file_.close();
+}
+
+int64_t TraceRecorder::nowMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceRecorder::addCompleteEvent(
+    const char * name, const char * category, int64_t start_us, int64_t duration_us)
+{
+    if (!enabled_) {
+        return;
+    }
+    addEvent({name, category, 'X', start_us, duration_us, 0.0, currentThreadId()});
+}
+
+void TraceRecorder::addInstantEvent(const char * name, const char * category)
+{
+    if (!enabled_) {
+        return;
+    }
+    addEvent({name, category, 'i', nowMicroseconds(), 0, 0.0, currentThreadId()});
+}
+
+void TraceRecorder::addCounterEvent(const char * name, const char * category, double value)
+{
+    if (!enabled_) {
+        return;
+    }
+    addEvent({name, category, 'C', nowMicroseconds(), 0, value, currentThreadId()});
+}
+
+void TraceRecorder::flush()
+{
+    if (!enabled_) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & event : events_) {
+        writeEvent(event);
+    }
+    events_.clear();
+    file_.flush();
+}
+
+void TraceRecorder::addEvent(const Event & event)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back(event);
+
+    if (events_.size() >= kFlushThreshold) {
+        for (const auto & buffered_event : events_) {
+            writeEvent(buffered_event);
+        }
+        events_.clear();
+        file_.flush();
+    }
+}
+
+void TraceRecorder::writeEvent(const Event & event)
+{
+    // The names and categories are string literals chosen in this package, hence they do not need
+    // to be escaped.
+    if (!first_event_) {
+        file_ << ",\n";
+    }
+    first_event_ = false;
+
+    file_ << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+          << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp_us
+          << ",\"pid\":" << process_id_ << ",\"tid\":" << event.thread_id;
+
+    switch (event.phase) {
+        case 'X':
+        file_ << ",\"dur\":" << event.duration_us;
+        break;
+
+        case 'i':
+        file_ << ",\"s\":\"p\"";
+        break;
+
+        case 'C':
+        file_ << ",\"args\":{\"value\":" << event.value << "}";
+        break;
+    }
+
+    file_ << "}";
+}
+
+uint32_t TraceRecorder::currentThreadId()
+{
+    return static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+}
+
+TraceScope::TraceScope(const char * name, const char * category)
+: name_(name), category_(category)
+{
+    if (TraceRecorder::instance().isEnabled()) {
+        start_us_ = TraceRecorder::nowMicroseconds();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (start_us_ < 0) {
+        return;
+    }
+
+    TraceRecorder::instance().addCompleteEvent(
+        name_, category_, start_us_, TraceRecorder::nowMicroseconds() - start_us_);
+}
+
+}  // namespace rviz_legged_plugins::common
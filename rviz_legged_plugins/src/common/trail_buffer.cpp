@@ -0,0 +1,132 @@
+#include "rviz_legged_plugins/common/trail_buffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <OgreCamera.h>
+#include <OgreHardwareBufferManager.h>
+#include <OgreNode.h>
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+constexpr size_t kMinCapacity = 1024;
+
+}  // namespace
+
+TrailBuffer::TrailBuffer()
+: colour_type_(Ogre::VertexElement::getBestColourVertexElementType())
+{
+    mRenderOp.operationType = Ogre::RenderOperation::OT_LINE_STRIP;
+    mRenderOp.useIndexes = false;
+    mRenderOp.vertexData = new Ogre::VertexData();
+    mRenderOp.vertexData->vertexDeclaration->addElement(
+        0, offsetof(Vertex, position), Ogre::VET_FLOAT3, Ogre::VES_POSITION);
+    mRenderOp.vertexData->vertexDeclaration->addElement(
+        0, offsetof(Vertex, colour), colour_type_, Ogre::VES_DIFFUSE);
+    updateRenderOperation();
+}
+
+TrailBuffer::~TrailBuffer()
+{
+    delete mRenderOp.vertexData;
+}
+
+void TrailBuffer::setMaxPoints(size_t max_points)
+{
+    max_points_ = max_points;
+    clear();
+}
+
+void TrailBuffer::append(const Ogre::Vector3 & position, const Ogre::ColourValue & colour)
+{
+    if (max_points_ > 0 && size() == max_points_) {
+        begin_++;
+    }
+    if (vertices_.size() == capacity_) {
+        if (max_points_ > 0 && capacity_ >= 2 * max_points_) {
+            // The window moves back to the start every max_points_ points, which keeps the copy
+            // of its points an amortized constant time per point.
+            vertices_.erase(vertices_.begin(), vertices_.begin() + static_cast<std::ptrdiff_t>(begin_));
+            begin_ = 0;
+            buffer_->writeData(0, vertices_.size() * sizeof(Vertex), vertices_.data(), true);
+            updateBounds();
+        } else {
+            auto capacity = std::max(2 * capacity_, kMinCapacity);
+            reallocate(max_points_ > 0 ? std::min(capacity, 2 * max_points_) : capacity);
+        }
+    }
+
+    Vertex vertex{{position.x, position.y, position.z},
+        Ogre::VertexElement::convertColourValue(colour, colour_type_)};
+    buffer_->writeData(vertices_.size() * sizeof(Vertex), sizeof(Vertex), &vertex);
+    vertices_.push_back(vertex);
+
+    mBox.merge(position);
+    if (mParentNode) {
+        mParentNode->needUpdate();
+    }
+    updateRenderOperation();
+}
+
+void TrailBuffer::clear()
+{
+    vertices_.clear();
+    vertices_.shrink_to_fit();
+    begin_ = 0;
+    capacity_ = 0;
+    mRenderOp.vertexData->vertexBufferBinding->unsetAllBindings();
+    buffer_.reset();
+    updateBounds();
+    updateRenderOperation();
+}
+
+Ogre::Vector3 TrailBuffer::back() const
+{
+    const auto & position = vertices_.back().position;
+    return Ogre::Vector3(position[0], position[1], position[2]);
+}
+
+Ogre::Real TrailBuffer::getSquaredViewDepth(const Ogre::Camera * camera) const
+{
+    return mParentNode ? mParentNode->getSquaredViewDepth(camera) : 0.0f;
+}
+
+Ogre::Real TrailBuffer::getBoundingRadius() const
+{
+    return mBox.isFinite() ? Ogre::Math::boundingRadiusFromAABB(mBox) : 0.0f;
+}
+
+void TrailBuffer::reallocate(size_t capacity)
+{
+    buffer_ = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+        sizeof(Vertex), capacity, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY);
+    capacity_ = capacity;
+    if (!vertices_.empty()) {
+        buffer_->writeData(0, vertices_.size() * sizeof(Vertex), vertices_.data(), true);
+    }
+    mRenderOp.vertexData->vertexBufferBinding->setBinding(0, buffer_);
+}
+
+void TrailBuffer::updateRenderOperation()
+{
+    mRenderOp.vertexData->vertexStart = begin_;
+    mRenderOp.vertexData->vertexCount = size();
+}
+
+void TrailBuffer::updateBounds()
+{
+    mBox.setNull();
+    for (size_t i = begin_; i < vertices_.size(); i++) {
+        const auto & position = vertices_[i].position;
+        mBox.merge(Ogre::Vector3(position[0], position[1], position[2]));
+    }
+    if (mParentNode) {
+        mParentNode->needUpdate();
+    }
+}
+
+}  // namespace rviz_legged_plugins::common
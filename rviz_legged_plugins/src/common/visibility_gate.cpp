@@ -0,0 +1,70 @@
+#include "rviz_legged_plugins/common/visibility_gate.hpp"
+
+#include <utility>
+
+#include <OgreCamera.h>
+#include <OgreSceneNode.h>
+
+#include "rviz_common/display_context.hpp"
+#include "rviz_common/view_controller.hpp"
+#include "rviz_common/view_manager.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+void VisibilityGate::initialize(rviz_common::DisplayContext * context, Ogre::SceneNode * scene_node)
+{
+    context_ = context;
+    scene_node_ = scene_node;
+}
+
+bool VisibilityGate::admit(std::function<void()> process)
+{
+    if (replaying_ || isDue()) {
+        pending_ = nullptr;
+        time_since_processed_ = 0.0f;
+        return true;
+    }
+
+    pending_ = std::move(process);
+    return false;
+}
+
+void VisibilityGate::update(float wall_dt)
+{
+    time_since_processed_ += wall_dt;
+    if (!pending_) {
+        return;
+    }
+
+    if (isDue() || time_since_processed_ >= kRefreshPeriod) {
+        auto process = std::move(pending_);
+        pending_ = nullptr;
+        time_since_processed_ = 0.0f;
+
+        replaying_ = true;
+        process();
+        replaying_ = false;
+    }
+}
+
+bool VisibilityGate::isContentVisible() const
+{
+    if (!context_ || !scene_node_ || !context_->getViewManager() ||
+        !context_->getViewManager()->getCurrent())
+    {
+        return true;
+    }
+
+    // The world bounds of a scene node include those of its children. Without content yet, the
+    // extent of the next one is unknown.
+    const auto & bounds = scene_node_->_getWorldAABB();
+    if (bounds.isNull() || bounds.isInfinite()) {
+        return true;
+    }
+
+    auto * camera = context_->getViewManager()->getCurrent()->getCamera();
+    return camera == nullptr || camera->isVisible(bounds);
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -0,0 +1,199 @@
+#include "rviz_legged_plugins/common/wrench_arrow_material.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <OgreHardwarePixelBuffer.h>
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
+#include <OgrePass.h>
+#include <OgrePixelFormat.h>
+#include <OgreTechnique.h>
+#include <OgreTextureManager.h>
+#include <OgreTextureUnitState.h>
+#include <OgreVector2.h>
+#include <OgreVector4.h>
+
+#include "rviz_legged_plugins/common/material_cache.hpp"
+
+namespace rviz_legged_plugins::common
+{
+
+namespace
+{
+
+constexpr size_t kColormapTexels = 256;
+
+// Length of the shaft of an arrow, and radius of its head, relative to its length.
+constexpr float kHeadBase = 0.8f;
+constexpr float kHeadRadius = 0.08f;
+
+float tangentialNormalRatio(const Ogre::Vector3 & force)
+{
+    float tangential = std::sqrt(force.x * force.x + force.y * force.y);
+    return tangential / std::max(std::abs(force.z), 1e-6f);
+}
+
+// Bounds of a range as written to the vertices, the shader mapping an empty range to 0.
+std::pair<float, float> rangeBounds(const ScalarRange & range)
+{
+    return range.max >= range.min ? std::make_pair(range.min, range.max) : std::make_pair(0.0f, 0.0f);
+}
+
+// Append a line arrow of the given offset from the contact point at unit scale, kind being 0 for
+// a force and 1 for a torque. A null arrow is degenerate, every wrench has the same vertex count.
+void addArrow(
+    Ogre::ManualObject & manual_object, const Ogre::Vector3 & position, const Ogre::Vector3 & arrow,
+    float kind, const Ogre::Vector3 & force, const Ogre::Vector4 & ranges)
+{
+    float length = arrow.length();
+    Ogre::Vector3 direction = length > 1e-6f ? arrow / length : Ogre::Vector3::UNIT_Z;
+    Ogre::Vector3 side = direction.perpendicular();
+    Ogre::Vector3 up = direction.crossProduct(side);
+    Ogre::Vector3 head_base = kHeadBase * arrow;
+    float head_radius = kHeadRadius * length;
+
+    auto vertex = [&](const Ogre::Vector3 & offset) {
+            manual_object.position(position);
+            manual_object.textureCoord(offset.x, offset.y, offset.z, kind);
+            manual_object.textureCoord(force);
+            manual_object.textureCoord(ranges.x, ranges.y, ranges.z, ranges.w);
+        };
+    vertex(Ogre::Vector3::ZERO);
+    vertex(arrow);
+    for (const auto & barb : {side, -side, up, -up}) {
+        vertex(arrow);
+        vertex(head_base + head_radius * barb);
+    }
+}
+
+}  // namespace
+
+WrenchArrowMaterial::WrenchArrowMaterial()
+{
+    // Each instance has its own parameters, hence its own clone of the material script.
+    static int count = 0;
+    std::string name = "WrenchArrowMaterial" + std::to_string(count++);
+    auto base = Ogre::MaterialManager::getSingleton().getByName(
+        "rviz_legged_plugins/WrenchArrows", "rviz_rendering");
+    material_ = base->clone(name);
+
+    colormap_texture_ = Ogre::TextureManager::getSingleton().createManual(
+        name + "_Colormap", "rviz_rendering", Ogre::TEX_TYPE_2D, kColormapTexels, 1, 0,
+        Ogre::PF_BYTE_RGBA);
+    material_->getTechnique(0)->getPass(0)->getTextureUnitState(0)->setTextureName(
+        colormap_texture_->getName());
+    setColormap(Colormap::VIRIDIS);
+    material_->load();
+}
+
+WrenchArrowMaterial::~WrenchArrowMaterial()
+{
+    Ogre::MaterialManager::getSingleton().remove(material_->getHandle());
+    Ogre::TextureManager::getSingleton().remove(colormap_texture_->getHandle());
+}
+
+void WrenchArrowMaterial::setScales(float force_scale, float torque_scale)
+{
+    auto parameters = material_->getTechnique(0)->getPass(0)->getVertexProgramParameters();
+    parameters->setNamedConstant("force_scale", force_scale);
+    parameters->setNamedConstant("torque_scale", torque_scale);
+}
+
+void WrenchArrowMaterial::setArrowHeadAsReference(bool enabled)
+{
+    material_->getTechnique(0)->getPass(0)->getVertexProgramParameters()->setNamedConstant(
+        "head_reference", enabled ? 1.0f : 0.0f);
+}
+
+void WrenchArrowMaterial::setColors(
+    const Ogre::ColourValue & force_color, const Ogre::ColourValue & torque_color)
+{
+    auto parameters = material_->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
+    parameters->setNamedConstant("force_colour", force_color);
+    parameters->setNamedConstant("torque_colour", torque_color);
+}
+
+void WrenchArrowMaterial::setAlpha(float alpha)
+{
+    auto * pass = material_->getTechnique(0)->getPass(0);
+    bool transparent = MaterialCache::isTransparent(alpha);
+    pass->setSceneBlending(transparent ? Ogre::SBT_TRANSPARENT_ALPHA : Ogre::SBT_REPLACE);
+    pass->setDepthWriteEnabled(!transparent);
+    pass->getFragmentProgramParameters()->setNamedConstant("alpha", alpha);
+}
+
+void WrenchArrowMaterial::setColorMode(ColorMode mode)
+{
+    // Both shaders read the mode: the vertex shader picks the value mapped to the colormap, the
+    // fragment shader whether to sample it.
+    auto * pass = material_->getTechnique(0)->getPass(0);
+    pass->getVertexProgramParameters()->setNamedConstant("colour_mode", static_cast<float>(mode));
+    pass->getFragmentProgramParameters()->setNamedConstant("colour_mode", static_cast<float>(mode));
+}
+
+void WrenchArrowMaterial::setColormap(Colormap colormap)
+{
+    if (colormap_ == colormap) {
+        return;
+    }
+    colormap_ = colormap;
+
+    std::vector<uint8_t> texels(4 * kColormapTexels);
+    auto to_byte = [](float channel) {
+            return static_cast<uint8_t>(std::lround(255.0f * std::clamp(channel, 0.0f, 1.0f)));
+        };
+    for (size_t i = 0; i < kColormapTexels; i++) {
+        auto color = sampleColormap(colormap, static_cast<float>(i) / (kColormapTexels - 1));
+        texels[4 * i] = to_byte(color.r);
+        texels[4 * i + 1] = to_byte(color.g);
+        texels[4 * i + 2] = to_byte(color.b);
+        texels[4 * i + 3] = 255;
+    }
+    Ogre::PixelBox box(kColormapTexels, 1, 1, Ogre::PF_BYTE_RGBA, texels.data());
+    colormap_texture_->getBuffer()->blitFromMemory(box);
+}
+
+void WrenchArrowMaterial::setRange(bool auto_range, float min, float max)
+{
+    auto parameters = material_->getTechnique(0)->getPass(0)->getVertexProgramParameters();
+    parameters->setNamedConstant("auto_range", auto_range ? 1.0f : 0.0f);
+    parameters->setNamedConstant("range", Ogre::Vector2(min, max));
+}
+
+WrenchArrowMaterial::Ranges WrenchArrowMaterial::computeRanges(const std::vector<WrenchSample> & samples)
+{
+    Ranges ranges;
+    for (const auto & sample : samples) {
+        ranges.magnitude.include(sample.force.length());
+        ranges.ratio.include(tangentialNormalRatio(sample.force));
+    }
+    return ranges;
+}
+
+void WrenchArrowMaterial::addWrench(
+    Ogre::ManualObject & manual_object, const Ogre::Vector3 & position, const WrenchSample & sample,
+    const Ranges & ranges)
+{
+    auto magnitude = rangeBounds(ranges.magnitude);
+    auto ratio = rangeBounds(ranges.ratio);
+    Ogre::Vector4 packed_ranges(magnitude.first, magnitude.second, ratio.first, ratio.second);
+    addArrow(manual_object, position, sample.force, 0.0f, sample.force, packed_ranges);
+    addArrow(manual_object, position, sample.torque, 1.0f, sample.force, packed_ranges);
+}
+
+Ogre::AxisAlignedBox WrenchArrowMaterial::bounds(
+    const Ogre::Vector3 & position, const WrenchSample & sample, float force_scale, float torque_scale)
+{
+    // The arrows are shifted by 1.25 times the scaled force when the head is the reference.
+    float extent = 1.25f * force_scale * sample.force.length() + torque_scale * sample.torque.length();
+    Ogre::Vector3 half_size(std::max(extent, 1e-3f));
+    return Ogre::AxisAlignedBox(position - half_size, position + half_size);
+}
+
+}  // namespace rviz_legged_plugins::common
@@ -27,8 +27,10 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <memory>
 
+#include <OgreManualObject.h>
 #include <OgreSceneNode.h>
 #include <OgreSceneManager.h>
 
@@ -36,14 +38,18 @@
 
 #include "rviz_common/display_context.hpp"
 #include "rviz_common/frame_manager_iface.hpp"
+#include "rviz_common/properties/bool_property.hpp"
 #include "rviz_common/properties/color_property.hpp"
+#include "rviz_common/properties/enum_property.hpp"
 #include "rviz_common/properties/float_property.hpp"
 #include "rviz_common/properties/int_property.hpp"
 #include "rviz_common/properties/parse_color.hpp"
-#include "rviz_common/validate_floats.hpp"
+#include "rviz_common/properties/ros_topic_property.hpp"
 #include "rviz_common/logging.hpp"
-#include "rviz_rendering/objects/wrench_visual.hpp"
 
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/message_stages.hpp"
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
 #include "rviz_legged_plugins/displays/external_wrench_display.hpp"
 
 namespace rviz_legged_plugins
@@ -51,38 +57,89 @@ namespace rviz_legged_plugins
 namespace displays
 {
 
+ExternalWrenchPolicy::Instance::~Instance()
+{
+    manual_object->_getManager()->destroyManualObject(manual_object);
+}
+
+void ExternalWrenchPolicy::setVisible(Instance & instance, bool visible)
+{
+    if (visible) {
+        return;
+    }
+    // The section of a pooled instance is emptied rather than destroyed, and refilled in place.
+    auto * manual_object = instance.manual_object;
+    if (manual_object->getNumSections() > 0) {
+        manual_object->beginUpdate(0);
+        manual_object->end();
+        manual_object->setBoundingBox(Ogre::AxisAlignedBox::BOX_NULL);
+    }
+}
+
 ExternalWrenchDisplay::ExternalWrenchDisplay()
+: packed_filter_([this](rviz_legged_msgs::msg::WrenchesPacked::ConstSharedPtr msg) {
+        processPackedMessage(msg);
+    }),
+  adapted_filter_([this](std::shared_ptr<const type_adapters::EigenWrenches> msg) {
+        processAdaptedMessage(msg);
+    })
 {
     arrow_head_as_reference_ = new rviz_common::properties::BoolProperty(
         "Arrow head as reference", false,
         "Use the arrow head as reference for the position, instead of its tail.", this,
-        SLOT(updateWrenchVisuals()));
+        SLOT(updateArrowMaterial()));
     
     accept_nan_values_ = new rviz_common::properties::BoolProperty(
         "Accept NaN Values", false,
-        "NaN values in incoming messages are converted to 0 to display wrench vector.", this,
-        SLOT(updateWrenchVisuals()));
+        "NaN values in incoming messages are converted to 0 to display wrench vector.", this);
 
     force_color_property_ = new rviz_common::properties::ColorProperty(
         "Force Color", QColor(204, 51, 51), "Color to draw the force arrows.", this,
-        SLOT(updateWrenchVisuals()));
+        SLOT(updateArrowMaterial()));
 
     torque_color_property_ = new rviz_common::properties::ColorProperty(
         "Torque Color", QColor(204, 204, 51), "Color to draw the torque arrows.", this,
-        SLOT(updateWrenchVisuals()));
+        SLOT(updateArrowMaterial()));
 
     alpha_property_ = new rviz_common::properties::FloatProperty(
         "Alpha", 1.0f, "0 is fully transparent, 1.0 is fully opaque.", this,
-        SLOT(updateWrenchVisuals()));
+        SLOT(updateArrowMaterial()));
 
     force_scale_property_ = new rviz_common::properties::FloatProperty(
-        "Force Arrow Scale", 0.002f, "force arrow scale", this, SLOT(updateWrenchVisuals()));
+        "Force Arrow Scale", 0.002f, "force arrow scale", this, SLOT(updateArrowMaterial()));
 
     torque_scale_property_ = new rviz_common::properties::FloatProperty(
-        "Torque Arrow Scale", 0.002f, "torque arrow scale", this, SLOT(updateWrenchVisuals()));
-
-    width_property_ = new rviz_common::properties::FloatProperty(
-        "Arrow Width", 0.25f, "arrow width", this, SLOT(updateWrenchVisuals()));
+        "Torque Arrow Scale", 0.002f, "torque arrow scale", this, SLOT(updateArrowMaterial()));
+
+    force_color_mode_property_ = new rviz_common::properties::EnumProperty(
+        "Force Color Mode", "Flat",
+        "Color the force arrows with the Force Color, or with a colormap of their magnitude or of "
+        "the ratio of their tangential to their normal component, the normal being the z axis of "
+        "the fixed frame.",
+        this, SLOT(updateColorMode()));
+    force_color_mode_property_->addOption("Flat", common::WrenchArrowMaterial::FLAT);
+    force_color_mode_property_->addOption("Magnitude", common::WrenchArrowMaterial::MAGNITUDE);
+    force_color_mode_property_->addOption(
+        "Tangential/Normal Ratio", common::WrenchArrowMaterial::TANGENTIAL_NORMAL_RATIO);
+
+    colormap_property_ = new rviz_common::properties::EnumProperty(
+        "Colormap", "Viridis", "Colormap of the force arrows.",
+        force_color_mode_property_, SLOT(updateArrowMaterial()), this);
+    colormap_property_->addOption("Viridis", static_cast<int>(common::Colormap::VIRIDIS));
+    colormap_property_->addOption("Jet", static_cast<int>(common::Colormap::JET));
+
+    auto_range_property_ = new rviz_common::properties::BoolProperty(
+        "Auto Range", true,
+        "Map the range of the values of each message to the colormap, instead of Min and Max.",
+        force_color_mode_property_, SLOT(updateColorMode()), this);
+
+    range_min_property_ = new rviz_common::properties::FloatProperty(
+        "Min", 0.0f, "Value mapped to the start of the colormap.", force_color_mode_property_,
+        SLOT(updateArrowMaterial()), this);
+
+    range_max_property_ = new rviz_common::properties::FloatProperty(
+        "Max", 500.0f, "Value mapped to the end of the colormap.", force_color_mode_property_,
+        SLOT(updateArrowMaterial()), this);
 
     history_length_property_ = new rviz_common::properties::IntProperty(
         "History Length", 1, "Number of prior measurements to display.", this,
@@ -90,165 +147,422 @@ ExternalWrenchDisplay::ExternalWrenchDisplay()
 
     history_length_property_->setMin(1);
     history_length_property_->setMax(100000);
+
+    packed_topic_property_ = new rviz_common::properties::RosTopicProperty(
+        "Packed Topic", "",
+        QString::fromStdString(rosidl_generator_traits::name<rviz_legged_msgs::msg::WrenchesPacked>()),
+        "rviz_legged_msgs/WrenchesPacked topic to subscribe to, in addition to Topic.", this,
+        SLOT(updatePackedTopic()));
+
+    adapted_topic_property_ = new rviz_common::properties::RosTopicProperty(
+        "Intra-process Topic", "",
+        QString::fromStdString(rosidl_generator_traits::name<rviz_legged_msgs::msg::WrenchesStamped>()),
+        "WrenchesStamped topic subscribed through the EigenWrenches type adapter with intra-process "
+        "communication. EigenWrenches published in the same process are received without conversion.",
+        this, SLOT(updateAdaptedTopic()));
+
+    watchStyle(accept_nan_values_);
 }
 
 void ExternalWrenchDisplay::onInitialize()
 {
     MFDClass::onInitialize();
+    visibilityGate().initialize(context_, scene_node_);
+    frame_monitor_ = common::FrameMonitor::acquire();
+    packed_topic_property_->initialize(rviz_ros_node_);
+    adapted_topic_property_->initialize(rviz_ros_node_);
+    arrow_material_ = std::make_unique<common::WrenchArrowMaterial>();
+    initializeTimeline();
     updateHistoryLength();
+    updateColorMode();
 }
 
-ExternalWrenchDisplay::~ExternalWrenchDisplay() = default;
+void ExternalWrenchDisplay::subscribe()
+{
+    BufferedContactDisplay::subscribe();
+    subscribePacked();
+    subscribeAdapted();
+}
+
+void ExternalWrenchDisplay::unsubscribe()
+{
+    MFDClass::unsubscribe();
+    packed_subscription_.reset();
+    adapted_subscription_.reset();
+    packed_filter_.clear();
+    adapted_filter_.clear();
+}
+
+void ExternalWrenchDisplay::fixedFrameChanged()
+{
+    packed_filter_.setTargetFrame(fixed_frame_.toStdString());
+    adapted_filter_.setTargetFrame(fixed_frame_.toStdString());
+    MFDClass::fixedFrameChanged();
+}
+
+void ExternalWrenchDisplay::subscribePacked()
+{
+    if (!isEnabled() || packed_topic_property_->isEmpty()) {
+        deleteStatus("Packed Topic");
+        return;
+    }
+
+    resetTransformFilter(packed_filter_);
+    try {
+        packed_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<rviz_legged_msgs::msg::WrenchesPacked>(
+                packed_topic_property_->getTopicStd(), qos_profile,
+                [this](rviz_legged_msgs::msg::WrenchesPacked::ConstSharedPtr msg) {
+                    packed_filter_.add(msg);
+                });
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Packed Topic", "OK");
+    } catch (const rclcpp::exceptions::InvalidTopicNameError & e) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Packed Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
+
+void ExternalWrenchDisplay::updatePackedTopic()
+{
+    packed_subscription_.reset();
+    packed_filter_.clear();
+    packed_messages_received_ = 0;
+    subscribePacked();
+    context_->queueRender();
+}
+
+void ExternalWrenchDisplay::subscribeAdapted()
+{
+    if (!isEnabled() || adapted_topic_property_->isEmpty()) {
+        deleteStatus("Intra-process Topic");
+        return;
+    }
+
+    // Publishers of EigenWrenches in the same process deliver their messages without any conversion.
+    rclcpp::SubscriptionOptions options;
+    options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+
+    resetTransformFilter(adapted_filter_);
+    try {
+        adapted_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<type_adapters::EigenWrenches>(
+                adapted_topic_property_->getTopicStd(), qos_profile,
+                [this](std::shared_ptr<const type_adapters::EigenWrenches> msg) {
+                    adapted_filter_.add(msg);
+                },
+                options);
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Intra-process Topic", "OK");
+    } catch (const std::exception & e) {
+        // Intra-process communication also rejects QoS profiles with transient local durability.
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Intra-process Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
+
+void ExternalWrenchDisplay::updateAdaptedTopic()
+{
+    adapted_subscription_.reset();
+    adapted_filter_.clear();
+    adapted_messages_received_ = 0;
+    subscribeAdapted();
+    context_->queueRender();
+}
+
+ExternalWrenchDisplay::~ExternalWrenchDisplay()
+{
+    // The arrows use the material of the display.
+    clearSlots();
+}
 
 void ExternalWrenchDisplay::reset()
 {
     MFDClass::reset();
-    visuals_.clear();
+    visibilityGate().clear();
+    clearSlots();
+    prewarmSlots();
+    clearTimeline();
 }
 
-void ExternalWrenchDisplay::updateWrenchVisuals()
+void ExternalWrenchDisplay::update(float wall_dt, float ros_dt)
 {
-    float alpha = alpha_property_->getFloat();
+    MFDClass::update(wall_dt, ros_dt);
+    visibilityGate().update(wall_dt);
+    updateTimeline(wall_dt);
+    followFrameBudget();
+}
+
+void ExternalWrenchDisplay::updateArrowMaterial()
+{
+    RVIZ_LEGGED_TRACE_SCOPE("updateArrowMaterial", "ExternalWrench");
+
+    // Every style property is a parameter of the material, hence its cost does not depend on the
+    // number of arrows.
     float force_scale = force_scale_property_->getFloat();
     float torque_scale = torque_scale_property_->getFloat();
-    float width = width_property_->getFloat();
+    float alpha = alpha_property_->getFloat();
     Ogre::ColourValue force_color = force_color_property_->getOgreColor();
     Ogre::ColourValue torque_color = torque_color_property_->getOgreColor();
-
-    for (const auto & visual : visuals_) {
-        visual->setForceColor(force_color.r, force_color.g, force_color.b, alpha);
-        visual->setTorqueColor(torque_color.r, torque_color.g, torque_color.b, alpha);
-        visual->setForceScale(force_scale);
-        visual->setTorqueScale(torque_scale);
-        visual->setWidth(width);
+    force_color.a = alpha;
+    torque_color.a = alpha;
+    arrow_material_->setScales(force_scale, torque_scale);
+    arrow_material_->setArrowHeadAsReference(arrow_head_as_reference_->getBool());
+    arrow_material_->setColors(force_color, torque_color);
+    arrow_material_->setAlpha(alpha);
+    arrow_material_->setColorMode(
+        static_cast<common::WrenchArrowMaterial::ColorMode>(force_color_mode_property_->getOptionInt()));
+    arrow_material_->setColormap(static_cast<common::Colormap>(colormap_property_->getOptionInt()));
+    arrow_material_->setRange(
+        auto_range_property_->getBool(), range_min_property_->getFloat(), range_max_property_->getFloat());
+
+    if (force_scale > bounds_force_scale_ || torque_scale > bounds_torque_scale_) {
+        bounds_force_scale_ = 2.0f * std::max(force_scale, bounds_force_scale_);
+        bounds_torque_scale_ = 2.0f * std::max(torque_scale, bounds_torque_scale_);
+        forEachSlotNewestFirst(
+            [this](Slot & slot) {
+                for (size_t i = 0; i < slot.size; i++) {
+                    auto & instance = *slot.instances[i];
+                    instance.manual_object->setBoundingBox(
+                        common::WrenchArrowMaterial::bounds(
+                            instance.position, instance.sample, bounds_force_scale_, bounds_torque_scale_));
+                }
+                return true;
+            });
     }
+    context_->queueRender();
+}
+
+void ExternalWrenchDisplay::readStyle(Style & style) const
+{
+    style.accept_nan = accept_nan_values_->getBool();
+}
+
+std::unique_ptr<ExternalWrenchDisplay::Instance> ExternalWrenchDisplay::createInstance(
+    Ogre::SceneNode * parent)
+{
+    RVIZ_LEGGED_TRACE_SCOPE("createWrenchVisual", "ExternalWrench");
+    auto * manual_object = context_->getSceneManager()->createManualObject();
+    manual_object->setDynamic(true);
+    parent->attachObject(manual_object);
+    return std::make_unique<Instance>(manual_object);
+}
+
+void ExternalWrenchDisplay::prewarmInstance(Instance & instance)
+{
+    // The vertex buffer is sized by a first section, emptied by setVisible() next.
+    drawWrench(instance, common::WrenchArrowMaterial::Ranges());
 }
 
 void ExternalWrenchDisplay::updateHistoryLength()
 {
-    while (visuals_.size() > static_cast<size_t>(history_length_property_->getInt()) * n_wrenches_) {
-        visuals_.pop_front();
-    }
+    RVIZ_LEGGED_TRACE_SCOPE("updateHistoryLength", "ExternalWrench");
+
+    setHistoryLength(static_cast<size_t>(history_length_property_->getInt()));
 }
 
-bool validateFloats(const geometry_msgs::msg::WrenchStamped & msg)
+void ExternalWrenchDisplay::updateColorMode()
 {
-    return rviz_common::validateFloats(msg.wrench.force) &&
-           rviz_common::validateFloats(msg.wrench.torque);
+    bool flat = force_color_mode_property_->getOptionInt() == common::WrenchArrowMaterial::FLAT;
+    bool auto_range = auto_range_property_->getBool();
+    force_color_property_->setHidden(!flat);
+    colormap_property_->setHidden(flat);
+    auto_range_property_->setHidden(flat);
+    range_min_property_->setHidden(flat || auto_range);
+    range_max_property_->setHidden(flat || auto_range);
+
+    updateArrowMaterial();
 }
 
 void ExternalWrenchDisplay::processMessage(rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg)
 {
-    n_wrenches_ = msg->wrenches_stamped.size();
+    if (!admitMessage(&ExternalWrenchDisplay::processMessage, msg)) {
+        return;
+    }
 
-    for (int i = 0; i < n_wrenches_; i++) {
-        auto wrench_stamped_msg = msg->wrenches_stamped[i];
+    RVIZ_LEGGED_TRACE_SCOPE("processMessage", "ExternalWrench");
 
-        geometry_msgs::msg::WrenchStamped adjusted_msg;
-        bool accept_nan = accept_nan_values_->getBool();
-        bool arrow_head_as_reference = arrow_head_as_reference_->getBool();
+    traceMessageAge(msg->header.stamp);
 
-        if (!accept_nan) {
-            if (!validateFloats(wrench_stamped_msg)) {
-            setStatus(
-                rviz_common::properties::StatusProperty::Error, "Topic",
-                "Message contained invalid floating point values (nans or infs)");
-            return;
-            }
-        } else {
-            adjusted_msg.wrench.force.x = (std::isnan(wrench_stamped_msg.wrench.force.x)) ? 0.0 : wrench_stamped_msg.wrench.force.x;
-            adjusted_msg.wrench.force.y = (std::isnan(wrench_stamped_msg.wrench.force.y)) ? 0.0 : wrench_stamped_msg.wrench.force.y;
-            adjusted_msg.wrench.force.z = (std::isnan(wrench_stamped_msg.wrench.force.z)) ? 0.0 : wrench_stamped_msg.wrench.force.z;
-
-            adjusted_msg.wrench.torque.x = (std::isnan(wrench_stamped_msg.wrench.torque.x)) ? 0.0 :
-            wrench_stamped_msg.wrench.torque.x;
-            adjusted_msg.wrench.torque.y = (std::isnan(wrench_stamped_msg.wrench.torque.y)) ? 0.0 :
-            wrench_stamped_msg.wrench.torque.y;
-            adjusted_msg.wrench.torque.z = (std::isnan(wrench_stamped_msg.wrench.torque.z)) ? 0.0 :
-            wrench_stamped_msg.wrench.torque.z;
-
-            if (!validateFloats(wrench_stamped_msg)) {
-            setStatus(
-                rviz_common::properties::StatusProperty::Error, "Topic",
-                "Message contained invalid floating point values (nans or infs)");
-            return;
-            }
-        }
+    auto error = common::readWrenches(*msg, style().accept_nan, message_samples_);
+    if (error != common::MessageError::NONE) {
+        setStatus(rviz_common::properties::StatusProperty::Error, "Topic", common::describe(error));
+        return;
+    }
 
-        Ogre::Quaternion orientation;
-        Ogre::Vector3 position;
-        if (!context_->getFrameManager()->getTransform(
-            wrench_stamped_msg.header.frame_id, wrench_stamped_msg.header.stamp, position, orientation))
-        {
-            setMissingTransformToFixedFrame(wrench_stamped_msg.header.frame_id);
+    // The wrenches sharing a frame and a stamp, e.g. all of them, share a single lookup.
+    message_positions_.clear();
+    beginFrameBatch();
+    for (const auto & wrench_stamped_msg : msg->wrenches_stamped) {
+        FrameTransform frame;
+        if (!lookupFrame(wrench_stamped_msg.header, frame)) {
             return;
         }
+        message_positions_.push_back(frame.position);
+    }
+
+    recordAndDrawWrenches(msg->header.stamp);
+}
+
+void ExternalWrenchDisplay::processPackedMessage(
+    rviz_legged_msgs::msg::WrenchesPacked::ConstSharedPtr msg)
+{
+    if (!admitMessage(&ExternalWrenchDisplay::processPackedMessage, msg)) {
+        return;
+    }
+
+    RVIZ_LEGGED_TRACE_SCOPE("processPackedMessage", "ExternalWrench");
+
+    traceMessageAge(msg->header.stamp);
+
+    auto error = common::readPackedWrenches(*msg, style().accept_nan, message_samples_);
+    if (error != common::MessageError::NONE) {
+        setStatus(rviz_common::properties::StatusProperty::Error, "Packed Topic", common::describe(error));
+        return;
+    }
+
+    setStatus(
+        rviz_common::properties::StatusProperty::Ok, "Packed Topic",
+        QString::number(++packed_messages_received_) + " messages received");
+
+    // All the contacts share the stamp, hence each frame of the table is looked up once.
+    if (!resolveFrames(msg->frame_ids, msg->header.stamp)) {
+        return;
+    }
+    message_positions_.clear();
+    for (auto frame_index : msg->frame_indices) {
+        message_positions_.push_back(resolvedFrame(frame_index).position);
+    }
+
+    recordAndDrawWrenches(msg->header.stamp);
+    context_->queueRender();
+}
+
+void ExternalWrenchDisplay::processAdaptedMessage(
+    std::shared_ptr<const type_adapters::EigenWrenches> msg)
+{
+    if (!admitMessage(&ExternalWrenchDisplay::processAdaptedMessage, msg)) {
+        return;
+    }
+
+    RVIZ_LEGGED_TRACE_SCOPE("processAdaptedMessage", "ExternalWrench");
+
+    traceMessageAge(msg->header.stamp);
 
-        if (position.isNaN()) {
-            RVIZ_COMMON_LOG_ERROR(
-            "Wrench position contains NaNs. Skipping render as long as the position is invalid");
+    const auto n_contacts = msg->wrenches.cols();
+    if (static_cast<size_t>(n_contacts) != msg->frame_ids.size()) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Intra-process Topic",
+            "The number of frames does not match the number of wrenches");
+        return;
+    }
+
+    setStatus(
+        rviz_common::properties::StatusProperty::Ok, "Intra-process Topic",
+        QString::number(++adapted_messages_received_) + " messages received");
+
+    bool accept_nan = style().accept_nan;
+    message_samples_.clear();
+    message_positions_.clear();
+
+    for (Eigen::Index i = 0; i < n_contacts; i++) {
+        common::WrenchSample sample;
+        if (!common::wrenchToSample(msg->wrenches.col(i), accept_nan, sample)) {
+            setStatus(
+                rviz_common::properties::StatusProperty::Error, "Intra-process Topic",
+                "Message contained invalid floating point values (nans or infs)");
             return;
         }
+        message_samples_.push_back(sample);
+    }
 
-        if (visuals_.size() >= static_cast<size_t>(history_length_property_->getInt()) * n_wrenches_) {
-            visuals_.pop_front();
-        }
+    if (!resolveFrames(msg->frame_ids, msg->header.stamp)) {
+        return;
+    }
+    for (size_t i = 0; i < msg->frame_ids.size(); i++) {
+        message_positions_.push_back(resolvedFrame(i).position);
+    }
 
-        // Shift the position of the arrow.
+    recordAndDrawWrenches(msg->header.stamp);
+    context_->queueRender();
+}
 
-        float force_scale = force_scale_property_->getFloat();
-        Ogre::Vector3 force(
-            static_cast<float>(wrench_stamped_msg.wrench.force.x),
-            static_cast<float>(wrench_stamped_msg.wrench.force.y),
-            static_cast<float>(wrench_stamped_msg.wrench.force.z));
-        
-        if (arrow_head_as_reference == true) {
-            position -= force_scale * 1.25 * force;
+void ExternalWrenchDisplay::recordAndDrawWrenches(const builtin_interfaces::msg::Time & stamp)
+{
+    size_t n = message_samples_.size();
+    if (float * values = recordMessage(stamp, n)) {
+        for (size_t i = 0; i < n; i++) {
+            const auto & position = message_positions_[i];
+            const auto & sample = message_samples_[i];
+            float row[] = {
+                position.x, position.y, position.z,
+                sample.force.x, sample.force.y, sample.force.z,
+                sample.torque.x, sample.torque.y, sample.torque.z};
+            for (size_t column = 0; column < ExternalWrenchPolicy::kTimelineColumns; column++) {
+                values[column * n + i] = row[column];
+            }
         }
+    }
 
-        orientation = Ogre::Quaternion(1., 0., 0., 0.);
-
-        auto visual = (!accept_nan) ? createWrenchVisual(wrench_stamped_msg, orientation, position) :
-            createWrenchVisual(adjusted_msg, orientation, position);
+    // While scrubbing, the timeline keeps the drawn wrenches.
+    if (!isScrubbing()) {
+        addWrenchVisuals();
+    }
+}
 
-        visuals_.push_back(visual);
+void ExternalWrenchDisplay::renderRecord(const common::TimelineStore::Record & record)
+{
+    message_samples_.resize(record.rows);
+    message_positions_.resize(record.rows);
+    for (size_t i = 0; i < record.rows; i++) {
+        auto value = [&record, i](size_t column) {return record.column(column)[i];};
+        message_positions_[i] = Ogre::Vector3(value(0), value(1), value(2));
+        message_samples_[i].force = Ogre::Vector3(value(3), value(4), value(5));
+        message_samples_[i].torque = Ogre::Vector3(value(6), value(7), value(8));
     }
+    addWrenchVisuals();
 }
 
-std::shared_ptr<rviz_rendering::WrenchVisual> ExternalWrenchDisplay::createWrenchVisual(
-    const geometry_msgs::msg::WrenchStamped & msg,
-    const Ogre::Quaternion & orientation,
-    const Ogre::Vector3 & position)
-    {
-    std::shared_ptr<rviz_rendering::WrenchVisual> visual;
-    visual = std::make_shared<rviz_rendering::WrenchVisual>(context_->getSceneManager(), scene_node_);
-
-    Ogre::Vector3 force(
-        static_cast<float>(msg.wrench.force.x),
-        static_cast<float>(msg.wrench.force.y),
-        static_cast<float>(msg.wrench.force.z));
-    Ogre::Vector3 torque(
-        static_cast<float>(msg.wrench.torque.x),
-        static_cast<float>(msg.wrench.torque.y),
-        static_cast<float>(msg.wrench.torque.z));
-    visual->setWrench(force, torque);
-    visual->setFramePosition(position);
-    visual->setFrameOrientation(orientation);
+void ExternalWrenchDisplay::applyFrameBudgetLevel(common::FrameBudget::Level level)
+{
+    // Besides the history, only the update rate of the wrenches can be reduced.
+    visibilityGate().setMinPeriod(
+        level >= common::FrameBudget::REDUCED_UPDATE_RATE ? common::FrameBudget::kReducedUpdatePeriod : 0.0f);
+}
 
-    float alpha = alpha_property_->getFloat();
-    float force_scale = force_scale_property_->getFloat();
-    float torque_scale = torque_scale_property_->getFloat();
-    float width = width_property_->getFloat();
-    Ogre::ColourValue force_color = force_color_property_->getOgreColor();
-    Ogre::ColourValue torque_color = torque_color_property_->getOgreColor();
+void ExternalWrenchDisplay::addWrenchVisuals()
+{
+    RVIZ_LEGGED_TRACE_SCOPE("addWrenchVisuals", "ExternalWrench");
+
+    // The instances of the oldest message are reused, only the missing ones are created.
+    auto ranges = common::WrenchArrowMaterial::computeRanges(message_samples_);
+    auto & slot = claimSlot(message_samples_.size());
+    for (size_t i = 0; i < message_samples_.size(); i++) {
+        auto & instance = *slot.instances[i];
+        instance.position = message_positions_[i];
+        instance.sample = message_samples_[i];
+        drawWrench(instance, ranges);
+    }
+}
 
-    visual->setForceColor(force_color.r, force_color.g, force_color.b, alpha);
-    visual->setTorqueColor(torque_color.r, torque_color.g, torque_color.b, alpha);
-    visual->setForceScale(force_scale);
-    visual->setTorqueScale(torque_scale);
-    visual->setWidth(width);
+void ExternalWrenchDisplay::drawWrench(
+    Instance & instance, const common::WrenchArrowMaterial::Ranges & ranges)
+{
+    auto * manual_object = instance.manual_object;
+    if (manual_object->getNumSections() == 0) {
+        manual_object->estimateVertexCount(common::WrenchArrowMaterial::kWrenchVertexCount);
+        manual_object->begin(
+            arrow_material_->getName(), Ogre::RenderOperation::OT_LINE_LIST, "rviz_rendering");
+    } else {
+        manual_object->beginUpdate(0);
+    }
+    common::WrenchArrowMaterial::addWrench(*manual_object, instance.position, instance.sample, ranges);
+    manual_object->end();
 
-    return visual;
+    // The shader moves the vertices, hence the bounds are those of the arrows at larger scales.
+    manual_object->setBoundingBox(
+        common::WrenchArrowMaterial::bounds(
+            instance.position, instance.sample, bounds_force_scale_, bounds_torque_scale_));
 }
 
 }  // namespace displays
@@ -0,0 +1,155 @@
+#include "rviz_legged_plugins/displays/fleet_friction_cones_display.hpp"
+
+#include <cmath>
+#include <initializer_list>
+#include <string>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreManualObject.h>
+#include <OgreMath.h>
+
+#include "rviz_common/properties/color_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+
+#include "rviz_legged_plugins/common/cone_mesh.hpp"
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/message_stages.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+
+namespace
+{
+
+// Vertices of a cone: a side and a base triangle for each side.
+constexpr size_t kConeVertexCount = 6 * common::kCoarseConeSides;
+
+/**
+ * @brief Append a friction cone to a triangle list, with the extent of common::coarseConeMesh().
+ *
+ * The material being unlit, each face is shaded by its slope so that the cones keep their shape.
+ */
+void addCone(
+    Ogre::ManualObject & manual_object, const Ogre::Vector3 & position,
+    const common::ConeGeometry & geometry, const Ogre::ColourValue & color, Ogre::AxisAlignedBox & bounds)
+{
+    auto place = [&](const Ogre::Vector3 & vertex) {
+            return position + geometry.offset + geometry.orientation * (geometry.scale * vertex);
+        };
+    auto add_face = [&](const Ogre::Vector3 & a, const Ogre::Vector3 & b, const Ogre::Vector3 & c) {
+            auto normal = (b - a).crossProduct(c - a).normalisedCopy();
+            auto face_color = color * (0.6f + 0.4f * std::abs(normal.z));
+            face_color.a = color.a;
+            for (const auto & vertex : {a, b, c}) {
+                manual_object.position(vertex);
+                manual_object.colour(face_color);
+                bounds.merge(vertex);
+            }
+        };
+    auto rim = [&](unsigned int side) {
+            Ogre::Radian angle(Ogre::Math::TWO_PI * static_cast<float>(side) / common::kCoarseConeSides);
+            return place(Ogre::Vector3(0.5f * Ogre::Math::Cos(angle), -0.5f, 0.5f * Ogre::Math::Sin(angle)));
+        };
+
+    auto apex = place(Ogre::Vector3(0.0f, 0.5f, 0.0f));
+    auto base_center = place(Ogre::Vector3(0.0f, -0.5f, 0.0f));
+    for (unsigned int side = 0; side < common::kCoarseConeSides; side++) {
+        auto first = rim(side);
+        auto second = rim(side + 1);
+        add_face(apex, second, first);
+        add_face(base_center, first, second);
+    }
+}
+
+}  // namespace
+
+FleetFrictionConesDisplay::FleetFrictionConesDisplay()
+: FleetDisplay("/robot_*/friction_cones", "FleetFrictionCones")
+{
+    color_property_ = new rviz_common::properties::ColorProperty(
+        "Color", Qt::white, "Color to draw the cones.", this, SLOT(updateStyle()));
+
+    alpha_property_ = new rviz_common::properties::FloatProperty(
+        "Alpha", 0.5f, "0 is fully transparent, 1.0 is fully opaque.", this, SLOT(updateStyle()));
+    alpha_property_->setMin(0);
+    alpha_property_->setMax(1);
+
+    cone_height_property_ = new rviz_common::properties::FloatProperty(
+        "Height", 0.2f, "Height of the cones.", this, SLOT(updateStyle()));
+}
+
+void FleetFrictionConesDisplay::updateStyle()
+{
+    markDirty();
+}
+
+void FleetFrictionConesDisplay::processMessage(
+    const std::string & topic, FleetFrictionCones & robot,
+    rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg)
+{
+    // The buffers of the robot are reused across its messages.
+    robot.clear();
+    auto error = common::validateCones(*msg);
+    if (error != common::MessageError::NONE) {
+        setRobotStatus(rviz_common::properties::StatusProperty::Error, topic, common::describe(error));
+        return;
+    }
+
+    for (const auto & cone : msg->friction_cones) {
+        Ogre::Vector3 position;
+        Ogre::Quaternion orientation;
+        if (!context_->getFrameManager()->getTransform(
+            cone.header.frame_id, cone.header.stamp, position, orientation) ||
+            position.isNaN())
+        {
+            setRobotStatus(
+                rviz_common::properties::StatusProperty::Warn, topic,
+                "No transform from [" + cone.header.frame_id + "]");
+            robot.clear();
+            return;
+        }
+        robot.positions.push_back(position);
+    }
+    common::readCones(*msg, robot.normals, robot.friction_coefficients);
+    deleteRobotStatus(topic);
+}
+
+void FleetFrictionConesDisplay::redraw()
+{
+    size_t n_cones = 0;
+    for (const auto & [topic, robot] : robots_) {
+        n_cones += robot.data.positions.size();
+    }
+    if (n_cones == 0) {
+        clearDraw();
+        return;
+    }
+
+    float alpha = alpha_property_->getFloat();
+    float height = cone_height_property_->getFloat();
+    Ogre::ColourValue color = color_property_->getOgreColor();
+    color.a = alpha;
+    material_ = common::MaterialCache::instance().vertexColorMaterial(
+        common::MaterialCache::isTransparent(alpha));
+
+    beginDraw((*material_)->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST, kConeVertexCount * n_cones);
+
+    Ogre::AxisAlignedBox bounds;
+    size_t robot_index = 0;
+    for (const auto & [topic, robot] : robots_) {
+        auto robot_color = robotColor(robot_index++, color);
+        const auto & cones = robot.data;
+        for (size_t i = 0; i < cones.positions.size(); i++) {
+            auto geometry = common::computeConeGeometry(
+                cones.normals[i], cones.friction_coefficients[i], height);
+            addCone(*manual_object_, cones.positions[i], geometry, robot_color, bounds);
+        }
+    }
+
+    endDraw(bounds);
+}
+
+}  // namespace rviz_legged_plugins::displays
+
+#include <pluginlib/class_list_macros.hpp>  // NOLINT
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::FleetFrictionConesDisplay, rviz_common::Display)
@@ -0,0 +1,119 @@
+#include "rviz_legged_plugins/displays/fleet_paths_display.hpp"
+
+#include <string>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreManualObject.h>
+#include <OgreMatrix4.h>
+
+#include "rviz_common/properties/color_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/message_stages.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+
+FleetPathsDisplay::FleetPathsDisplay()
+: FleetDisplay("/robot_*/paths", "FleetPaths")
+{
+    color_property_ = new rviz_common::properties::ColorProperty(
+        "Color", QColor(25, 255, 0), "Color to draw the paths.", this, SLOT(updateStyle()));
+
+    alpha_property_ = new rviz_common::properties::FloatProperty(
+        "Alpha", 1.0f, "0 is fully transparent, 1.0 is fully opaque.", this, SLOT(updateStyle()));
+    alpha_property_->setMin(0);
+    alpha_property_->setMax(1);
+}
+
+void FleetPathsDisplay::updateStyle()
+{
+    markDirty();
+}
+
+void FleetPathsDisplay::processMessage(
+    const std::string & topic, FleetPaths & robot, rviz_legged_msgs::msg::Paths::ConstSharedPtr msg)
+{
+    // The buffers of the robot are reused across its messages.
+    robot.clear();
+    auto error = common::validatePaths(*msg);
+    if (error != common::MessageError::NONE) {
+        setRobotStatus(rviz_common::properties::StatusProperty::Error, topic, common::describe(error));
+        return;
+    }
+
+    // All the paths share the header, hence the transform is looked up once.
+    Ogre::Vector3 position;
+    Ogre::Quaternion orientation;
+    if (!context_->getFrameManager()->getTransform(msg->header, position, orientation) ||
+        position.isNaN())
+    {
+        setRobotStatus(
+            rviz_common::properties::StatusProperty::Warn, topic,
+            "No transform from [" + msg->header.frame_id + "]");
+        return;
+    }
+    Ogre::Matrix4 transform;
+    transform.makeTransform(position, Ogre::Vector3::UNIT_SCALE, orientation);
+
+    for (const auto & path : msg->paths) {
+        common::transformPathPositions(path, transform, path_positions_);
+        robot.positions.insert(robot.positions.end(), path_positions_.begin(), path_positions_.end());
+        robot.path_ends.push_back(robot.positions.size());
+    }
+    deleteRobotStatus(topic);
+}
+
+void FleetPathsDisplay::redraw()
+{
+    // The paths are drawn as a line list, so that they all fit in one section.
+    size_t n_vertices = 0;
+    for (const auto & [topic, robot] : robots_) {
+        size_t begin = 0;
+        for (auto end : robot.data.path_ends) {
+            n_vertices += end > begin ? 2 * (end - begin - 1) : 0;
+            begin = end;
+        }
+    }
+    if (n_vertices == 0) {
+        clearDraw();
+        return;
+    }
+
+    float alpha = alpha_property_->getFloat();
+    Ogre::ColourValue color = color_property_->getOgreColor();
+    color.a = alpha;
+    material_ = common::MaterialCache::instance().vertexColorMaterial(
+        common::MaterialCache::isTransparent(alpha));
+
+    beginDraw((*material_)->getName(), Ogre::RenderOperation::OT_LINE_LIST, n_vertices);
+
+    Ogre::AxisAlignedBox bounds;
+    size_t robot_index = 0;
+    for (const auto & [topic, robot] : robots_) {
+        auto robot_color = robotColor(robot_index++, color);
+        const auto & positions = robot.data.positions;
+        size_t begin = 0;
+        for (auto end : robot.data.path_ends) {
+            for (size_t k = begin + 1; k < end; k++) {
+                manual_object_->position(positions[k - 1]);
+                manual_object_->colour(robot_color);
+                manual_object_->position(positions[k]);
+                manual_object_->colour(robot_color);
+                bounds.merge(positions[k]);
+            }
+            if (end > begin) {
+                bounds.merge(positions[begin]);
+            }
+            begin = end;
+        }
+    }
+
+    endDraw(bounds);
+}
+
+}  // namespace rviz_legged_plugins::displays
+
+#include <pluginlib/class_list_macros.hpp>  // NOLINT
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::FleetPathsDisplay, rviz_common::Display)
@@ -0,0 +1,159 @@
+#include "rviz_legged_plugins/displays/fleet_wrenches_display.hpp"
+
+#include <string>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreManualObject.h>
+
+#include "rviz_common/properties/color_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+
+namespace
+{
+
+/** @brief Append an arrow made of line segments to a ManualObject section, growing bounds. */
+void addArrow(
+    Ogre::ManualObject & manual_object, const Ogre::Vector3 & tail, const Ogre::Vector3 & vector,
+    const Ogre::ColourValue & color, Ogre::AxisAlignedBox & bounds)
+{
+    float length = vector.length();
+    if (length < 1e-6f) {
+        return;
+    }
+
+    Ogre::Vector3 tip = tail + vector;
+    Ogre::Vector3 direction = vector / length;
+    Ogre::Vector3 side = direction.perpendicular();
+    Ogre::Vector3 up = direction.crossProduct(side);
+    Ogre::Vector3 head_base = tip - 0.2f * vector;
+    float head_radius = 0.08f * length;
+
+    manual_object.position(tail);
+    manual_object.colour(color);
+    manual_object.position(tip);
+    manual_object.colour(color);
+
+    for (const auto & barb : {side, -side, up, -up}) {
+        manual_object.position(tip);
+        manual_object.colour(color);
+        manual_object.position(head_base + head_radius * barb);
+        manual_object.colour(color);
+    }
+
+    // The barbs lie within the head radius of the tip.
+    bounds.merge(tail);
+    bounds.merge(Ogre::AxisAlignedBox(tip - Ogre::Vector3(head_radius), tip + Ogre::Vector3(head_radius)));
+}
+
+// Vertices of an arrow: the shaft and four barbs.
+constexpr size_t kArrowVertexCount = 10;
+
+}  // namespace
+
+FleetWrenchesDisplay::FleetWrenchesDisplay()
+: FleetDisplay("/robot_*/contact_wrenches", "FleetWrenches")
+{
+    force_color_property_ = new rviz_common::properties::ColorProperty(
+        "Force Color", QColor(204, 51, 51), "Color to draw the force arrows.",
+        this, SLOT(updateStyle()));
+
+    torque_color_property_ = new rviz_common::properties::ColorProperty(
+        "Torque Color", QColor(204, 204, 51), "Color to draw the torque arrows.",
+        this, SLOT(updateStyle()));
+
+    alpha_property_ = new rviz_common::properties::FloatProperty(
+        "Alpha", 1.0f, "0 is fully transparent, 1.0 is fully opaque.",
+        this, SLOT(updateStyle()));
+    alpha_property_->setMin(0);
+    alpha_property_->setMax(1);
+
+    force_scale_property_ = new rviz_common::properties::FloatProperty(
+        "Force Arrow Scale", 0.002f, "force arrow scale", this, SLOT(updateStyle()));
+
+    torque_scale_property_ = new rviz_common::properties::FloatProperty(
+        "Torque Arrow Scale", 0.002f, "torque arrow scale", this, SLOT(updateStyle()));
+}
+
+void FleetWrenchesDisplay::updateStyle()
+{
+    markDirty();
+}
+
+void FleetWrenchesDisplay::processMessage(
+    const std::string & topic, FleetWrenches & robot,
+    rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg)
+{
+    // The buffers of the robot are reused across its messages.
+    robot.clear();
+    for (const auto & wrench_stamped : msg->wrenches_stamped) {
+        common::WrenchSample sample;
+        if (!common::wrenchToSample(wrench_stamped.wrench, false, sample)) {
+            continue;
+        }
+
+        Ogre::Vector3 position;
+        Ogre::Quaternion orientation;
+        if (!context_->getFrameManager()->getTransform(
+            wrench_stamped.header.frame_id, wrench_stamped.header.stamp, position, orientation) ||
+            position.isNaN())
+        {
+            setRobotStatus(
+                rviz_common::properties::StatusProperty::Warn, topic,
+                "No transform from [" + wrench_stamped.header.frame_id + "]");
+            continue;
+        }
+
+        robot.positions.push_back(position);
+        robot.wrenches.push_back(sample);
+    }
+    if (robot.positions.size() == msg->wrenches_stamped.size()) {
+        deleteRobotStatus(topic);
+    }
+}
+
+void FleetWrenchesDisplay::redraw()
+{
+    size_t n_wrenches = 0;
+    for (const auto & [topic, robot] : robots_) {
+        n_wrenches += robot.data.wrenches.size();
+    }
+    if (n_wrenches == 0) {
+        clearDraw();
+        return;
+    }
+
+    float alpha = alpha_property_->getFloat();
+    float force_scale = force_scale_property_->getFloat();
+    float torque_scale = torque_scale_property_->getFloat();
+    Ogre::ColourValue force_color = force_color_property_->getOgreColor();
+    Ogre::ColourValue torque_color = torque_color_property_->getOgreColor();
+    force_color.a = alpha;
+    torque_color.a = alpha;
+    material_ = common::MaterialCache::instance().vertexColorMaterial(
+        common::MaterialCache::isTransparent(alpha));
+
+    beginDraw(
+        (*material_)->getName(), Ogre::RenderOperation::OT_LINE_LIST, 2 * kArrowVertexCount * n_wrenches);
+
+    Ogre::AxisAlignedBox bounds;
+    size_t robot_index = 0;
+    for (const auto & [topic, robot] : robots_) {
+        auto robot_force_color = robotColor(robot_index++, force_color);
+        const auto & wrenches = robot.data.wrenches;
+        for (size_t i = 0; i < wrenches.size(); i++) {
+            const auto & position = robot.data.positions[i];
+            addArrow(*manual_object_, position, force_scale * wrenches[i].force, robot_force_color, bounds);
+            addArrow(*manual_object_, position, torque_scale * wrenches[i].torque, torque_color, bounds);
+        }
+    }
+
+    endDraw(bounds);
+}
+
+}  // namespace rviz_legged_plugins::displays
+
+#include <pluginlib/class_list_macros.hpp>  // NOLINT
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::FleetWrenchesDisplay, rviz_common::Display)
@@ -29,17 +29,25 @@
 
 #include "rviz_legged_plugins/displays/friction_cones_display.hpp"
 
-#include <limits>
+#include <algorithm>
 #include <memory>
+#include <string>
 
-#include "rviz_rendering/objects/shape.hpp"
+#include <OgreEntity.h>
+
+#include "rviz_common/display_context.hpp"
+#include "rviz_common/properties/bool_property.hpp"
 #include "rviz_common/properties/color_property.hpp"
 #include "rviz_common/properties/float_property.hpp"
 #include "rviz_common/properties/int_property.hpp"
 #include "rviz_common/properties/parse_color.hpp"
+#include "rviz_common/properties/ros_topic_property.hpp"
 
-#include <Eigen/Core>
-#include <Eigen/Geometry>
+#include "rviz_legged_plugins/common/cone_mesh.hpp"
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/content_hash.hpp"
+#include "rviz_legged_plugins/common/message_stages.hpp"
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
 
 
 
@@ -48,6 +56,46 @@ namespace rviz_legged_plugins
 namespace displays
 {
 
+namespace
+{
+
+uint64_t hashMessage(const rviz_legged_msgs::msg::FrictionCones & msg, bool include_stamps)
+{
+    common::ContentHash hash;
+    hash.add(std::string("FrictionCones"));
+    if (include_stamps) {
+        hash.add(msg.header.stamp);
+    }
+    hash.add(msg.friction_cones.size());
+    for (const auto & cone : msg.friction_cones) {
+        hash.add(cone.header.frame_id);
+        if (include_stamps) {
+            hash.add(cone.header.stamp);
+        }
+        hash.add(cone.normal_direction.x);
+        hash.add(cone.normal_direction.y);
+        hash.add(cone.normal_direction.z);
+        hash.add(cone.friction_coefficient);
+    }
+    return hash.value();
+}
+
+uint64_t hashMessage(const rviz_legged_msgs::msg::FrictionConesPacked & msg, bool include_stamps)
+{
+    common::ContentHash hash;
+    hash.add(std::string("FrictionConesPacked"));
+    if (include_stamps) {
+        hash.add(msg.header.stamp);
+    }
+    hash.add(msg.frame_ids);
+    hash.add(msg.frame_indices);
+    hash.add(msg.normal_directions);
+    hash.add(msg.friction_coefficients);
+    return hash.value();
+}
+
+}  // namespace
+
 FrictionConesDisplay::FrictionConesDisplay(rviz_common::DisplayContext * display_context)
 : FrictionConesDisplay()
 {
@@ -58,11 +106,14 @@ FrictionConesDisplay::FrictionConesDisplay(rviz_common::DisplayContext * display
 }
 
 FrictionConesDisplay::FrictionConesDisplay()
+: packed_filter_([this](rviz_legged_msgs::msg::FrictionConesPacked::ConstSharedPtr msg) {
+        processPackedMessage(msg);
+    })
 {
     height_property_ = new rviz_common::properties::FloatProperty(
         "Height", 0.2f,
         "Height of the cone.",
-        this, SLOT(updateColorAndAlpha()));
+        this, SLOT(resetDuplicateDetection()));
 
     color_property_ = new rviz_common::properties::ColorProperty(
         "Color", Qt::white,
@@ -79,110 +130,420 @@ FrictionConesDisplay::FrictionConesDisplay()
         "Number of prior measurements to display.",
         this, SLOT(updateBufferLength()));
     buffer_length_property_->setMin(1);
+
+    fade_duration_property_ = new rviz_common::properties::FloatProperty(
+        "Fade Duration", 0.0f,
+        "Age, in seconds, at which the buffered cones become fully transparent. 0 disables fading.",
+        this, SLOT(updateFadeDuration()));
+    fade_duration_property_->setMin(0.0f);
+
+    packed_topic_property_ = new rviz_common::properties::RosTopicProperty(
+        "Packed Topic", "",
+        QString::fromStdString(
+            rosidl_generator_traits::name<rviz_legged_msgs::msg::FrictionConesPacked>()),
+        "rviz_legged_msgs/FrictionConesPacked topic to subscribe to, in addition to Topic.",
+        this, SLOT(updatePackedTopic()));
+
+    skip_duplicates_property_ = new rviz_common::properties::BoolProperty(
+        "Skip Duplicates", true,
+        "When a message has the same content as the previous one, only look up the transforms "
+        "of its frames instead of rebuilding the cones.",
+        this, SLOT(resetDuplicateDetection()));
+
+    ignore_stamps_property_ = new rviz_common::properties::BoolProperty(
+        "Ignore Stamps", true,
+        "Compare the messages without their stamps.",
+        skip_duplicates_property_, SLOT(resetDuplicateDetection()), this);
+
+    watchStyle(height_property_);
 }
 
 void FrictionConesDisplay::onInitialize()
 {
     MFDClass::onInitialize();
+    visibilityGate().initialize(context_, scene_node_);
+    frame_monitor_ = common::FrameMonitor::acquire();
+    packed_topic_property_->initialize(rviz_ros_node_);
+    initializeTimeline();
     updateBufferLength();
     updateColorAndAlpha();
 }
 
-FrictionConesDisplay::~FrictionConesDisplay() = default;
+void FrictionConesDisplay::subscribe()
+{
+    BufferedContactDisplay::subscribe();
+    subscribePacked();
+}
+
+void FrictionConesDisplay::unsubscribe()
+{
+    MFDClass::unsubscribe();
+    packed_subscription_.reset();
+    packed_filter_.clear();
+}
+
+void FrictionConesDisplay::fixedFrameChanged()
+{
+    packed_filter_.setTargetFrame(fixed_frame_.toStdString());
+    MFDClass::fixedFrameChanged();
+}
+
+void FrictionConesDisplay::subscribePacked()
+{
+    if (!isEnabled() || packed_topic_property_->isEmpty()) {
+        deleteStatus("Packed Topic");
+        return;
+    }
+
+    resetTransformFilter(packed_filter_);
+    try {
+        packed_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<rviz_legged_msgs::msg::FrictionConesPacked>(
+                packed_topic_property_->getTopicStd(), qos_profile,
+                [this](rviz_legged_msgs::msg::FrictionConesPacked::ConstSharedPtr msg) {
+                    packed_filter_.add(msg);
+                });
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Packed Topic", "OK");
+    } catch (const rclcpp::exceptions::InvalidTopicNameError & e) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Packed Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
+
+void FrictionConesDisplay::updatePackedTopic()
+{
+    packed_subscription_.reset();
+    packed_filter_.clear();
+    packed_messages_received_ = 0;
+    subscribePacked();
+    context_->queueRender();
+}
+
+FrictionConesDisplay::~FrictionConesDisplay()
+{
+    // The cones are destroyed before their material.
+    clearSlots();
+}
 
 void FrictionConesDisplay::reset()
 {
     MFDClass::reset();
-    updateBufferLength();
+    visibilityGate().clear();
+    clearSlots();
+    prewarmSlots();
+    clearTimeline();
+    resetDuplicateDetection();
+}
+
+void FrictionConesDisplay::update(float wall_dt, float ros_dt)
+{
+    MFDClass::update(wall_dt, ros_dt);
+    visibilityGate().update(wall_dt);
+    updateTimeline(wall_dt);
+    followFrameBudget();
+
+    // The only per-frame work of fading, whatever the number of buffered cones.
+    if (isFading()) {
+        fade_material_->setNow(context_->getClock()->now());
+    }
 }
 
 void FrictionConesDisplay::updateColorAndAlpha()
 {
+    RVIZ_LEGGED_TRACE_SCOPE("updateColorAndAlpha", "FrictionCones");
+
     auto color = color_property_->getOgreColor();
-    float alpha = alpha_property_->getFloat();
-    for (const auto & cone : cones_) {
-        cone->setColor(color.r, color.g, color.b, alpha);
+    color.a = alpha_property_->getFloat();
+
+    if (fade_material_) {
+        fade_material_->setColor(color);
+    }
+    // The cones are rebound only when the material was shared with another display.
+    if (!common::MaterialCache::instance().restyleSolidColor(cone_material_, color) && !isFading()) {
+        bindConeMaterial();
     }
     context_->queueRender();
 }
 
+void FrictionConesDisplay::updateFadeDuration()
+{
+    float fade_duration = fade_duration_property_->getFloat();
+    if (fade_duration > 0.0f && !fade_material_) {
+        fade_material_ = std::make_unique<common::AgeFadeMaterial>(common::AgeFadeMaterial::SOLID_COLOR);
+        auto color = color_property_->getOgreColor();
+        color.a = alpha_property_->getFloat();
+        fade_material_->setColor(color);
+    }
+    if (fade_material_) {
+        fade_material_->setFadeDuration(fade_duration);
+        bindConeMaterial();
+    }
+    resetDuplicateDetection();
+    context_->queueRender();
+}
+
+bool FrictionConesDisplay::isFading() const
+{
+    return fade_material_ && fade_duration_property_->getFloat() > 0.0f;
+}
+
+const Ogre::MaterialPtr & FrictionConesDisplay::coneMaterial() const
+{
+    return isFading() ? fade_material_->getMaterial() : *cone_material_;
+}
+
+void FrictionConesDisplay::bindConeMaterial()
+{
+    bool fading = isFading();
+    forEachSlotNewestFirst(
+        [this, fading](Slot & slot) {
+            for (auto & instance : slot.instances) {
+                instance->entity->setMaterial(coneMaterial());
+                if (instance->coarse_entity) {
+                    instance->coarse_entity->setMaterial(coneMaterial());
+                }
+                if (fading) {
+                    stampCone(*instance);
+                }
+            }
+            return true;
+        });
+}
+
+void FrictionConesDisplay::resetDuplicateDetection()
+{
+    last_message_hash_.reset();
+}
+
+bool FrictionConesDisplay::isDuplicate(uint64_t hash) const
+{
+    // Fading cones are stamped by their message, hence always rebuilt.
+    return skip_duplicates_property_->getBool() && !isFading() && last_message_hash_ == hash;
+}
+
 void FrictionConesDisplay::updateBufferLength()
 {
-    int buffer_length = number_cones_ * buffer_length_property_->getInt();
-    auto color = color_property_->getOgreColor();
-    cones_.resize(buffer_length);
+    RVIZ_LEGGED_TRACE_SCOPE("updateBufferLength", "FrictionCones");
 
-    for (auto & cone : cones_) {
-        cone.reset(
-        new rviz_rendering::Shape(
-            rviz_rendering::Shape::Cone, context_->getSceneManager(), scene_node_));
+    setHistoryLength(static_cast<size_t>(buffer_length_property_->getInt()));
+}
 
-        cone->setScale(Ogre::Vector3(0, 0, 0));
-        cone->setColor(color.r, color.g, color.b, 0);
+std::unique_ptr<FrictionConesDisplay::Instance> FrictionConesDisplay::createInstance(
+    Ogre::SceneNode * parent)
+{
+    if (!cone_material_) {
+        auto color = color_property_->getOgreColor();
+        color.a = alpha_property_->getFloat();
+        cone_material_ = common::MaterialCache::instance().solidColorMaterial(color);
     }
+
+    auto instance = std::make_unique<Instance>(context_->getSceneManager(), parent);
+    instance->entity->setMaterial(coneMaterial());
+    if (frameBudgetLevel() >= common::FrameBudget::REDUCED_CONE_DETAIL) {
+        setConeDetail(*instance, true);
+    }
+    return instance;
+}
+
+void FrictionConesDisplay::readStyle(Style & style) const
+{
+    style.height = height_property_->getFloat();
 }
 
 void FrictionConesDisplay::processMessage(const rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg)
 {
-    number_cones_ = msg->friction_cones.size();
-    updateBufferLength();
+    if (!admitMessage(&FrictionConesDisplay::processMessage, msg)) {
+        return;
+    }
 
-    for (int i = 0; i < number_cones_; i++) {
-        auto friction_cone_msg = msg->friction_cones[i];
+    RVIZ_LEGGED_TRACE_SCOPE("processMessage", "FrictionCones");
 
-        auto cone = cones_[i];
+    traceMessageAge(msg->header.stamp);
 
-        Ogre::Vector3 position;
-        Ogre::Quaternion orientation;
-        float displayed_range = height_property_->getFloat();
-        auto pose = getPose();
+    auto error = common::validateCones(*msg);
+    if (error != common::MessageError::NONE) {
+        setStatus(rviz_common::properties::StatusProperty::Error, "Topic", common::describe(error));
+        return;
+    }
 
-        if (!context_->getFrameManager()->transform(
-            friction_cone_msg.header.frame_id, friction_cone_msg.header.stamp, pose, position, orientation))
-        {
-            setMissingTransformToFixedFrame(friction_cone_msg.header.frame_id);
+    // The cones sharing a frame and a stamp share a single lookup.
+    message_positions_.clear();
+    beginFrameBatch();
+    for (const auto & friction_cone_msg : msg->friction_cones) {
+        FrameTransform frame;
+        if (!lookupFrame(friction_cone_msg.header, frame)) {
             return;
         }
-        setTransformOk();
-
-        position.x += friction_cone_msg.normal_direction.x * displayed_range/2;
-        position.y += friction_cone_msg.normal_direction.y * displayed_range/2;
-        position.z += friction_cone_msg.normal_direction.z * displayed_range/2;
-        cone->setPosition(position);
-
-        Eigen::Vector3d a;
-        a << 0, -1, 0;
-        Eigen::Vector3d b;
-        b[0] = friction_cone_msg.normal_direction.x;
-        b[1] = friction_cone_msg.normal_direction.y;
-        b[2] = friction_cone_msg.normal_direction.z;
-        Eigen::Quaterniond quat = Eigen::Quaterniond::FromTwoVectors(a, b);
-        orientation.x = quat.x();
-        orientation.y = quat.y();
-        orientation.z = quat.z();
-        orientation.w = quat.w();
-        cone->setOrientation(orientation);
-
-        float cone_width = 2.0f * displayed_range * friction_cone_msg.friction_coefficient;
-        Ogre::Vector3 scale(cone_width, displayed_range, cone_width);
-        cone->setScale(scale);
+        message_positions_.push_back(frame.position);
+    }
 
-        auto color = color_property_->getOgreColor();
-        cone->setColor(color.r, color.g, color.b, alpha_property_->getFloat());
+    common::readCones(*msg, message_normals_, message_friction_coefficients_);
+
+    addCones(msg->header.stamp, hashMessage(*msg, !ignore_stamps_property_->getBool()));
+}
+
+void FrictionConesDisplay::processPackedMessage(
+    rviz_legged_msgs::msg::FrictionConesPacked::ConstSharedPtr msg)
+{
+    if (!admitMessage(&FrictionConesDisplay::processPackedMessage, msg)) {
+        return;
+    }
+
+    RVIZ_LEGGED_TRACE_SCOPE("processPackedMessage", "FrictionCones");
+
+    traceMessageAge(msg->header.stamp);
+
+    // A message identical to the previous one was already validated.
+    uint64_t hash = hashMessage(*msg, !ignore_stamps_property_->getBool());
+    bool duplicate = isDuplicate(hash);
+
+    auto error = duplicate ? common::MessageError::NONE : common::validatePackedCones(*msg);
+    if (error != common::MessageError::NONE) {
+        setStatus(rviz_common::properties::StatusProperty::Error, "Packed Topic", common::describe(error));
+        return;
+    }
+
+    setStatus(
+        rviz_common::properties::StatusProperty::Ok, "Packed Topic",
+        QString::number(++packed_messages_received_) + " messages received");
+
+    // Resolve all the frames in one batch at the shared stamp, before touching the cones.
+    if (!resolveFrames(msg->frame_ids, msg->header.stamp)) {
+        return;
+    }
+    message_positions_.clear();
+    for (auto frame_index : msg->frame_indices) {
+        message_positions_.push_back(resolvedFrame(frame_index).position);
+    }
+
+    common::readPackedCones(*msg, message_normals_, message_friction_coefficients_);
+
+    addCones(msg->header.stamp, hash);
+}
+
+void FrictionConesDisplay::addCones(const builtin_interfaces::msg::Time & stamp, uint64_t hash)
+{
+    size_t n = message_positions_.size();
+    if (float * values = recordMessage(stamp, n)) {
+        for (size_t i = 0; i < n; i++) {
+            const auto & position = message_positions_[i];
+            const auto & normal = message_normals_[i];
+            float row[] = {
+                position.x, position.y, position.z, normal.x, normal.y, normal.z,
+                message_friction_coefficients_[i]};
+            for (size_t column = 0; column < FrictionConesPolicy::kTimelineColumns; column++) {
+                values[column * n + i] = row[column];
+            }
+        }
     }
+
+    // While scrubbing, the timeline keeps the drawn cones.
+    if (isScrubbing()) {
+        return;
+    }
+
+    // A message identical to the previous one only moves the cones with their frames.
+    if (isDuplicate(hash)) {
+        placeNewestCones();
+        return;
+    }
+
+    drawCones(rclcpp::Time(stamp));
+    last_message_hash_ = hash;
 }
 
-geometry_msgs::msg::Pose FrictionConesDisplay::getPose(/*float displayed_range*/)
+void FrictionConesDisplay::drawCones(const rclcpp::Time & stamp)
 {
-    // float fudge_factor = 0.008824f;  // fudge factor measured, must be inaccuracy of cone model.
-    geometry_msgs::msg::Pose pose;
+    auto & slot = claimSlot(message_positions_.size());
+    bool fading = isFading();
+    for (size_t i = 0; i < message_positions_.size(); i++) {
+        auto & instance = *slot.instances[i];
+        updateCone(instance, message_positions_[i], message_normals_[i], message_friction_coefficients_[i]);
+        instance.stamp = stamp;
+        if (fading) {
+            stampCone(instance);
+        }
+    }
+}
+
+void FrictionConesDisplay::stampCone(Instance & instance)
+{
+    float stamp = fade_material_->toShaderTime(instance.stamp);
+    common::AgeFadeMaterial::setStamp(*instance.entity, stamp);
+    if (instance.coarse_entity) {
+        common::AgeFadeMaterial::setStamp(*instance.coarse_entity, stamp);
+    }
+}
+
+void FrictionConesDisplay::renderRecord(const common::TimelineStore::Record & record)
+{
+    message_positions_.resize(record.rows);
+    message_normals_.resize(record.rows);
+    message_friction_coefficients_.resize(record.rows);
+    for (size_t i = 0; i < record.rows; i++) {
+        auto value = [&record, i](size_t column) {return record.column(column)[i];};
+        message_positions_[i] = Ogre::Vector3(value(0), value(1), value(2));
+        message_normals_[i] = Ogre::Vector3(value(3), value(4), value(5));
+        message_friction_coefficients_[i] = value(6);
+    }
+    drawCones(rclcpp::Time(record.stamp_ns));
 
-    // pose.position.x = displayed_range / 2 - fudge_factor * displayed_range;
-    // pose.orientation.z = 0.707f;
-    // pose.orientation.w = 0.707f;
-    pose.orientation.w = 1.f;
+    // The newest cones are those of the record.
+    resetDuplicateDetection();
+}
+
+void FrictionConesDisplay::updateCone(
+    Instance & instance, const Ogre::Vector3 & position,
+    const Ogre::Vector3 & normal_direction, double friction_coefficient)
+{
+    auto geometry = common::computeConeGeometry(
+        normal_direction, friction_coefficient, style().height);
+
+    instance.node->setPosition(position + geometry.offset);
+    instance.node->setOrientation(geometry.orientation);
+    instance.node->setScale(geometry.scale);
+    instance.offset = geometry.offset;
+}
+
+void FrictionConesDisplay::placeNewestCones()
+{
+    auto * slot = newestSlot();
+    for (size_t i = 0; slot && i < std::min(slot->size, message_positions_.size()); i++) {
+        auto & instance = *slot->instances[i];
+        instance.node->setPosition(message_positions_[i] + instance.offset);
+    }
+}
+
+void FrictionConesDisplay::applyFrameBudgetLevel(common::FrameBudget::Level level)
+{
+    bool coarse = level >= common::FrameBudget::REDUCED_CONE_DETAIL;
+    forEachSlotNewestFirst(
+        [this, coarse](Slot & slot) {
+            for (auto & instance : slot.instances) {
+                setConeDetail(*instance, coarse);
+            }
+            return true;
+        });
+
+    visibilityGate().setMinPeriod(
+        level >= common::FrameBudget::REDUCED_UPDATE_RATE ? common::FrameBudget::kReducedUpdatePeriod : 0.0f);
+}
+
+void FrictionConesDisplay::setConeDetail(Instance & instance, bool coarse)
+{
+    if (coarse && !instance.coarse_entity) {
+        instance.coarse_entity = scene_manager_->createEntity(common::coarseConeMesh(scene_manager_));
+        instance.coarse_entity->setMaterial(coneMaterial());
+        if (isFading()) {
+            stampCone(instance);
+        }
+        instance.node->attachObject(instance.coarse_entity);
+    }
 
-    return pose;
+    // Hidden instances stay hidden.
+    instance.coarse = coarse;
+    FrictionConesPolicy::setVisible(instance, instance.visible);
 }
 
 }  // namespace displays
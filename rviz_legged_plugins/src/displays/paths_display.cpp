@@ -31,48 +31,231 @@
 #include "rviz_legged_plugins/displays/paths_display.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include <OgreAxisAlignedBox.h>
 #include <OgreBillboardSet.h>
+#include <OgreEntity.h>
 #include <OgreManualObject.h>
 #include <OgreMaterialManager.h>
 #include <OgreTechnique.h>
 
+#include "rviz_common/display_context.hpp"
 #include "rviz_common/logging.hpp"
 #include "rviz_common/msg_conversions.hpp"
+#include "rviz_common/properties/bool_property.hpp"
 #include "rviz_common/properties/enum_property.hpp"
 #include "rviz_common/properties/color_property.hpp"
 #include "rviz_common/properties/float_property.hpp"
 #include "rviz_common/properties/int_property.hpp"
+#include "rviz_common/properties/ros_topic_property.hpp"
+#include "rviz_common/properties/tf_frame_property.hpp"
 #include "rviz_common/properties/vector_property.hpp"
 #include "rviz_common/uniform_string_stream.hpp"
-#include "rviz_common/validate_floats.hpp"
+#include "rviz_rendering/objects/shape.hpp"
 
-#include "rviz_rendering/material_manager.hpp"
+#include "rviz_legged_plugins/common/cdr_reader.hpp"
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/content_hash.hpp"
+#include "rviz_legged_plugins/common/message_stages.hpp"
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
 
 namespace rviz_legged_plugins::displays
 {
 
+namespace
+{
+
+uint64_t hashMessage(const rviz_legged_msgs::msg::Paths & msg, bool include_stamps)
+{
+    common::ContentHash hash;
+    hash.add(std::string("Paths"));
+    hash.add(msg.header.frame_id);
+    if (include_stamps) {
+        hash.add(msg.header.stamp);
+    }
+    hash.add(msg.paths.size());
+    for (const auto & path : msg.paths) {
+        hash.add(path.poses.size());
+        for (const auto & pose_stamped : path.poses) {
+            const auto & pose = pose_stamped.pose;
+            hash.add(pose.position.x);
+            hash.add(pose.position.y);
+            hash.add(pose.position.z);
+            hash.add(pose.orientation.x);
+            hash.add(pose.orientation.y);
+            hash.add(pose.orientation.z);
+            hash.add(pose.orientation.w);
+            // The colors along the horizon only depend on the stamps relative to the first pose.
+            if (include_stamps) {
+                hash.add(pose_stamped.header.stamp);
+            } else {
+                hash.add(
+                    (rclcpp::Time(pose_stamped.header.stamp) -
+                    rclcpp::Time(path.poses.front().header.stamp)).nanoseconds());
+            }
+        }
+    }
+    return hash.value();
+}
+
+uint64_t hashMessage(const type_adapters::EigenPaths & msg, bool include_stamps)
+{
+    common::ContentHash hash;
+    hash.add(std::string("EigenPaths"));
+    hash.add(msg.header.frame_id);
+    if (include_stamps) {
+        hash.add(msg.header.stamp);
+    }
+    hash.add(msg.paths.size());
+    for (const auto & path : msg.paths) {
+        hash.add(path.cols());
+        hash.add(path.data(), static_cast<size_t>(path.size()) * sizeof(double));
+    }
+    return hash.value();
+}
+
+// Hash of decoded paths, whose times along the horizon are relative to the first pose of each path.
+uint64_t hashMessage(
+    const std_msgs::msg::Header & header, const float * values, size_t rows, bool include_stamps)
+{
+    common::ContentHash hash;
+    hash.add(std::string("SerializedPaths"));
+    hash.add(header.frame_id);
+    if (include_stamps) {
+        hash.add(header.stamp);
+    }
+    hash.add(rows);
+    // The first row, the pose of the frame, is not part of the message.
+    for (size_t column = 0; column < PathsPolicy::kTimelineColumns; column++) {
+        hash.add(values + column * rows + 1, (rows - 1) * sizeof(float));
+    }
+    return hash.value();
+}
+
+// Smallest serialized pose: a stamp, an empty frame_id and seven doubles. A path also has a
+// header and the length of its poses.
+constexpr size_t kMinSerializedPoseSize = 8 + 5 + 7 * 8;
+constexpr size_t kMinSerializedPathSize = 8 + 5 + 4;
+
+// Poses per pose marker from the REDUCED_POSE_MARKERS level of the frame budget on.
+constexpr size_t kReducedPoseStride = 4;
+
+/** Read the header of a serialized message, reusing the capacity of the frame_id of header. */
+bool readSerializedHeader(common::CdrReader & reader, std_msgs::msg::Header & header)
+{
+    std::string_view frame_id;
+    if (!reader.read(header.stamp.sec) || !reader.read(header.stamp.nanosec) || !reader.read(frame_id)) {
+        return false;
+    }
+    header.frame_id.assign(frame_id.data(), frame_id.size());
+    return true;
+}
+
+struct SerializedPose
+{
+    int32_t sec;
+    uint32_t nanosec;
+    // Position and orientation, in the order of the fields of geometry_msgs/Pose.
+    double values[7];
+};
+
+/**
+ * Read the paths of a serialized Paths message, the reader being past its header. on_path is
+ * called with the index and the number of poses of every path, before on_pose is called with the
+ * indices of each of its poses.
+ */
+template<typename PathF, typename PoseF>
+bool readSerializedPaths(common::CdrReader & reader, PathF on_path, PoseF on_pose)
+{
+    uint32_t path_count;
+    if (!reader.readSequenceLength(path_count, kMinSerializedPathSize)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < path_count; i++) {
+        // The header of the path is that of the message.
+        int32_t sec;
+        uint32_t nanosec;
+        uint32_t pose_count;
+        if (!reader.read(sec) || !reader.read(nanosec) || !reader.skipString() ||
+            !reader.readSequenceLength(pose_count, kMinSerializedPoseSize))
+        {
+            return false;
+        }
+        on_path(i, pose_count);
+
+        for (uint32_t k = 0; k < pose_count; k++) {
+            SerializedPose pose;
+            if (!reader.read(pose.sec) || !reader.read(pose.nanosec) || !reader.skipString()) {
+                return false;
+            }
+            for (auto & value : pose.values) {
+                if (!reader.read(value)) {
+                    return false;
+                }
+            }
+            on_pose(i, k, pose);
+        }
+    }
+    return true;
+}
+
+void writeRecordRow(
+    float * values, size_t rows, size_t row, const Ogre::Vector3 & position,
+    const Ogre::Quaternion & orientation, float time, float path_index)
+{
+    float row_values[] = {
+        position.x, position.y, position.z, orientation.x, orientation.y, orientation.z,
+        orientation.w, time, path_index};
+    for (size_t column = 0; column < PathsPolicy::kTimelineColumns; column++) {
+        values[column * rows + row] = row_values[column];
+    }
+}
+
+// Empty the section of a manual object, keeping its vertex buffer for the next paths.
+void emptySection(Ogre::ManualObject * manual_object)
+{
+    if (manual_object && manual_object->getNumSections() > 0) {
+        manual_object->beginUpdate(0);
+        manual_object->end();
+        manual_object->setBoundingBox(Ogre::AxisAlignedBox::BOX_NULL);
+    }
+}
+
+}  // namespace
+
 PathsDisplay::PathsDisplay(rviz_common::DisplayContext * context)
 : PathsDisplay()
 {
     context_ = context;
     scene_manager_ = context->getSceneManager();
     scene_node_ = scene_manager_->getRootSceneNode()->createChildSceneNode();
+    createPoseMarkerMaterial();
     updateBufferLength();
 }
 
 PathsDisplay::PathsDisplay()
+: adapted_filter_([this](std::shared_ptr<const type_adapters::EigenPaths> msg) {
+        processAdaptedMessage(msg);
+    }),
+  serialized_filter_([this](std::shared_ptr<const SerializedPaths> paths) {
+        processSerializedMessage(paths->message);
+    })
 {
     style_property_ = std::make_unique<rviz_common::properties::EnumProperty>(
         "Line Style", "Lines",
         "The rendering operation to use to draw the grid lines.",
         this, SLOT(updateStyle()));
 
-    style_property_->addOption("Lines", LINES);
-    style_property_->addOption("Billboards", BILLBOARDS);
+    style_property_->addOption("Lines", PathsPolicy::LINES);
+    style_property_->addOption("Billboards", PathsPolicy::BILLBOARDS);
 
     line_width_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
         "Line Width", 0.03F,
@@ -82,13 +265,41 @@ PathsDisplay::PathsDisplay()
     line_width_property_->setMin(0.001F);
     line_width_property_->hide();
 
+    color_mode_property_ = std::make_unique<rviz_common::properties::EnumProperty>(
+        "Color Mode", "Flat",
+        "Color the paths with the Color, or with a colormap of the time along the horizon (the "
+        "stamps of the poses, or their index when the poses are not stamped) or of the speed.",
+        this, SLOT(updateColorMode()));
+    color_mode_property_->addOption("Flat", PathsPolicy::FLAT);
+    color_mode_property_->addOption("Time Along Horizon", PathsPolicy::TIME_ALONG_HORIZON);
+    color_mode_property_->addOption("Speed", PathsPolicy::SPEED);
+
+    colormap_property_ = std::make_unique<rviz_common::properties::EnumProperty>(
+        "Colormap", "Viridis", "Colormap of the paths.", color_mode_property_.get(),
+        SLOT(resetDuplicateDetection()), this);
+    colormap_property_->addOption("Viridis", static_cast<int>(common::Colormap::VIRIDIS));
+    colormap_property_->addOption("Jet", static_cast<int>(common::Colormap::JET));
+
+    auto_range_property_ = std::make_unique<rviz_common::properties::BoolProperty>(
+        "Auto Range", true,
+        "Map the range of the values of each message to the colormap, instead of Min and Max.",
+        color_mode_property_.get(), SLOT(updateColorMode()), this);
+
+    range_min_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
+        "Min", 0.0F, "Value mapped to the start of the colormap.", color_mode_property_.get(),
+        SLOT(resetDuplicateDetection()), this);
+
+    range_max_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
+        "Max", 1.0F, "Value mapped to the end of the colormap.", color_mode_property_.get(),
+        SLOT(resetDuplicateDetection()), this);
+
     color_property_ = std::make_unique<rviz_common::properties::ColorProperty>(
         "Color", QColor(25, 255, 0),
-        "Color to draw the path.", this);
+        "Color to draw the path.", this, SLOT(resetDuplicateDetection()));
 
     alpha_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
         "Alpha", 1.0,
-        "Amount of transparency to apply to the path.", this);
+        "Amount of transparency to apply to the path.", this, SLOT(resetDuplicateDetection()));
 
     buffer_length_property_ = std::make_unique<rviz_common::properties::IntProperty>(
         "Buffer Length", 1,
@@ -96,6 +307,20 @@ PathsDisplay::PathsDisplay()
         this, SLOT(updateBufferLength()));
     buffer_length_property_->setMin(1);
 
+    expected_path_length_property_ = std::make_unique<rviz_common::properties::IntProperty>(
+        "Expected Path Length", 0,
+        "Number of poses expected in a path. The line buffers of the paths created ahead of the "
+        "messages are allocated for that many poses.",
+        expectedContactsProperty(), SLOT(updateExpectedPathLength()), this);
+    expected_path_length_property_->setMin(0);
+
+    fade_duration_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
+        "Fade Duration", 0.0F,
+        "Age, in seconds, at which the buffered paths become fully transparent. 0 disables fading. "
+        "Only works with the 'Lines' style.",
+        this, SLOT(updateFadeDuration()));
+    fade_duration_property_->setMin(0.0F);
+
     offset_property_ = std::make_unique<rviz_common::properties::VectorProperty>(
         "Offset", Ogre::Vector3::ZERO,
         "Allows you to offset the path from the origin of the reference frame.  In meters.",
@@ -105,9 +330,9 @@ PathsDisplay::PathsDisplay()
         "Pose Style", "None",
         "Shape to display the pose as.",
         this, SLOT(updatePoseStyle()));
-    pose_style_property_->addOption("None", NONE);
-    pose_style_property_->addOption("Axes", AXES);
-    pose_style_property_->addOption("Arrows", ARROWS);
+    pose_style_property_->addOption("None", PathsPolicy::NONE);
+    pose_style_property_->addOption("Axes", PathsPolicy::AXES);
+    pose_style_property_->addOption("Arrows", PathsPolicy::ARROWS);
 
     pose_axes_length_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
         "Length", 0.3F,
@@ -154,102 +379,430 @@ PathsDisplay::PathsDisplay()
     pose_arrow_shaft_diameter_property_->hide();
     pose_arrow_head_diameter_property_->hide();
 
-    static int count = 0;
-    std::string material_name = "PathsLinesMaterial" + std::to_string(count++);
-    lines_material_ = rviz_rendering::MaterialManager::createMaterialWithNoLighting(material_name);
+    serialized_topic_property_ = std::make_unique<rviz_common::properties::RosTopicProperty>(
+        "Serialized Topic", "",
+        QString::fromStdString(rosidl_generator_traits::name<rviz_legged_msgs::msg::Paths>()),
+        "Paths topic received serialized, and decoded straight into the buffers of the display: "
+        "no message, nor string per pose, is built.",
+        this, SLOT(updateSerializedTopic()));
+
+    adapted_topic_property_ = std::make_unique<rviz_common::properties::RosTopicProperty>(
+        "Intra-process Topic", "",
+        QString::fromStdString(rosidl_generator_traits::name<rviz_legged_msgs::msg::Paths>()),
+        "Paths topic subscribed through the EigenPaths type adapter with intra-process "
+        "communication. EigenPaths published in the same process are received without conversion.",
+        this, SLOT(updateAdaptedTopic()));
+
+    skip_duplicates_property_ = std::make_unique<rviz_common::properties::BoolProperty>(
+        "Skip Duplicates", true,
+        "When a message has the same content as the previous one, only move the newest paths "
+        "with its frame instead of rebuilding them. Disabled while fading.",
+        this, SLOT(resetDuplicateDetection()));
+
+    ignore_stamps_property_ = std::make_unique<rviz_common::properties::BoolProperty>(
+        "Ignore Stamps", true,
+        "Compare the messages without their stamps.",
+        skip_duplicates_property_.get(), SLOT(resetDuplicateDetection()), this);
+
+    executed_property_ = std::make_unique<rviz_common::properties::BoolProperty>(
+        "Executed Trajectory", false,
+        "Accumulate the first pose of every path, where the feet actually went, into one line per "
+        "path over the whole run. The new points take the current Color.",
+        this, SLOT(updateExecutedTrajectory()));
+
+    executed_max_points_property_ = std::make_unique<rviz_common::properties::IntProperty>(
+        "Max Points", 0,
+        "Number of the newest points kept by each executed trajectory. 0 keeps all the points.",
+        executed_property_.get(), SLOT(updateExecutedTrajectory()), this);
+    executed_max_points_property_->setMin(0);
+    executed_max_points_property_->hide();
+
+    terrain_shadow_property_ = std::make_unique<rviz_common::properties::BoolProperty>(
+        "Terrain Shadow", false,
+        "Draw the paths a second time projected on the terrain plane, by the GPU, as their shadow on "
+        "the ground. Only works with the 'Lines' style, without fading.",
+        this, SLOT(updateTerrainShadow()));
+
+    terrain_topic_property_ = std::make_unique<rviz_common::properties::RosTopicProperty>(
+        "Terrain Topic", "/state_estimator/terrain",
+        QString::fromStdString(rosidl_generator_traits::name<std_msgs::msg::Float64MultiArray>()),
+        "Coefficients [a, b, c] of the terrain plane z = a x + b y + c. Without message, the plane "
+        "is z = 0.",
+        terrain_shadow_property_.get(), SLOT(updateTerrainTopic()), this);
+
+    terrain_frame_property_ = std::make_unique<rviz_common::properties::TfFrameProperty>(
+        "Terrain Frame", rviz_common::properties::TfFrameProperty::FIXED_FRAME_STRING,
+        "Frame in which the terrain plane is expressed.",
+        terrain_shadow_property_.get(), nullptr, true);
+
+    shadow_alpha_property_ = std::make_unique<rviz_common::properties::FloatProperty>(
+        "Shadow Alpha", 0.4F,
+        "Alpha of the shadows, relative to that of the paths.",
+        terrain_shadow_property_.get(), SLOT(updateShadowAlpha()), this);
+    shadow_alpha_property_->setMin(0.0F);
+    shadow_alpha_property_->setMax(1.0F);
+
+    terrain_topic_property_->hide();
+    terrain_frame_property_->hide();
+    shadow_alpha_property_->hide();
+
+    // Shared by all the paths displays; each path keeps the material of the alpha it was drawn with.
+    opaque_lines_material_ = common::MaterialCache::instance().vertexColorMaterial(false);
+    transparent_lines_material_ = common::MaterialCache::instance().vertexColorMaterial(true);
+
+    for (auto * property : std::initializer_list<rviz_common::properties::Property *>{
+            style_property_.get(), line_width_property_.get(), color_mode_property_.get(),
+            colormap_property_.get(), auto_range_property_.get(), range_min_property_.get(),
+            range_max_property_.get(), color_property_.get(), alpha_property_.get(),
+            pose_style_property_.get(), pose_axes_length_property_.get(),
+            pose_axes_radius_property_.get(), pose_arrow_shaft_length_property_.get(),
+            pose_arrow_head_length_property_.get(), pose_arrow_shaft_diameter_property_.get(),
+            pose_arrow_head_diameter_property_.get()})
+    {
+        watchStyle(property);
+    }
 }
 
 PathsDisplay::~PathsDisplay()
 {
-    destroyObjects();
-    destroyPoseAxesChain();
-    destroyPoseArrowChain();
+    // The paths use the materials released with the members.
+    clearSlots();
+    executed_trails_.clear();
+}
+
+PathsPolicy::Instance::~Instance()
+{
+    for (auto * object : {manual_object, markers}) {
+        if (object) {
+            object->_getManager()->destroyManualObject(object);
+        }
+    }
+}
+
+void PathsPolicy::setVisible(Instance & instance, bool visible)
+{
+    if (visible) {
+        return;
+    }
+    emptySection(instance.manual_object);
+    if (instance.billboard_line) {
+        instance.billboard_line->clear();
+    }
+    emptySection(instance.markers);
+}
+
+template<typename F>
+void PathsDisplay::forEachInstance(F f)
+{
+    forEachSlotNewestFirst(
+        [&f](Slot & slot) {
+            for (auto & instance : slot.instances) {
+                f(*instance);
+            }
+            return true;
+        });
 }
 
 void PathsDisplay::onInitialize()
 {
     MFDClass::onInitialize();
+    visibilityGate().initialize(context_, scene_node_);
+    frame_monitor_ = common::FrameMonitor::acquire();
+    adapted_topic_property_->initialize(rviz_ros_node_);
+    serialized_topic_property_->initialize(rviz_ros_node_);
+    terrain_topic_property_->initialize(rviz_ros_node_);
+    terrain_frame_property_->setFrameManager(context_->getFrameManager());
+    initializeTimeline();
+    executed_node_ = scene_node_->createChildSceneNode();
+    createPoseMarkerMaterial();
     updateBufferLength();
+    updateColorMode();
+}
+
+void PathsDisplay::updateColorMode()
+{
+    bool flat = color_mode_property_->getOptionInt() == PathsPolicy::FLAT;
+    bool auto_range = auto_range_property_->getBool();
+    color_property_->setHidden(!flat);
+    colormap_property_->setHidden(flat);
+    auto_range_property_->setHidden(flat);
+    range_min_property_->setHidden(flat || auto_range);
+    range_max_property_->setHidden(flat || auto_range);
+    resetDuplicateDetection();
+}
+
+void PathsDisplay::updateExecutedTrajectory()
+{
+    executed_max_points_property_->setHidden(!executed_property_->getBool());
+    clearExecuted();
+    context_->queueRender();
+}
+
+void PathsDisplay::updateTerrainShadow()
+{
+    bool enabled = terrain_shadow_property_->getBool();
+    terrain_topic_property_->setHidden(!enabled);
+    terrain_frame_property_->setHidden(!enabled);
+    shadow_alpha_property_->setHidden(!enabled);
+
+    if (enabled && !terrain_shadow_material_) {
+        terrain_shadow_material_ = std::make_unique<common::TerrainShadowMaterial>();
+        updateShadowAlpha();
+    }
+    updateTerrainTopic();
+    // The lines already drawn switch material at once, and the next paths are drawn in full.
+    bindLineMaterials();
+    resetDuplicateDetection();
+}
+
+void PathsDisplay::updateTerrainTopic()
+{
+    terrain_subscription_.reset();
+    terrain_plane_ = common::TerrainPlane();
+    subscribeTerrain();
+    context_->queueRender();
+}
+
+void PathsDisplay::updateShadowAlpha()
+{
+    if (terrain_shadow_material_) {
+        terrain_shadow_material_->setShadowAlpha(shadow_alpha_property_->getFloat());
+    }
+    context_->queueRender();
+}
+
+bool PathsDisplay::isShadowing() const
+{
+    return terrain_shadow_material_ && terrain_shadow_property_->getBool() &&
+           static_cast<PathsPolicy::LineStyle>(style_property_->getOptionInt()) == PathsPolicy::LINES &&
+           !isFading();
+}
+
+void PathsDisplay::subscribeTerrain()
+{
+    if (!isEnabled() || !terrain_shadow_property_->getBool() || terrain_topic_property_->isEmpty()) {
+        deleteStatus("Terrain Topic");
+        return;
+    }
+
+    try {
+        terrain_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<std_msgs::msg::Float64MultiArray>(
+                terrain_topic_property_->getTopicStd(), qos_profile,
+                [this](std_msgs::msg::Float64MultiArray::ConstSharedPtr msg) {
+                    processTerrain(msg);
+                });
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Terrain Topic", "OK");
+    } catch (const rclcpp::exceptions::InvalidTopicNameError & e) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Terrain Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
+
+void PathsDisplay::processTerrain(std_msgs::msg::Float64MultiArray::ConstSharedPtr msg)
+{
+    if (msg->data.size() != 3) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Terrain Topic",
+            "The terrain message must contain the three coefficients of the plane");
+        return;
+    }
+    if (!std::isfinite(msg->data[0]) || !std::isfinite(msg->data[1]) || !std::isfinite(msg->data[2])) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Terrain Topic",
+            "Message contained invalid floating point values (nans or infs)");
+        return;
+    }
+
+    terrain_plane_ = common::TerrainPlane::fromCoefficients(msg->data[0], msg->data[1], msg->data[2]);
+    setStatus(rviz_common::properties::StatusProperty::Ok, "Terrain Topic", "OK");
+    context_->queueRender();
+}
+
+void PathsDisplay::applyFrameBudgetLevel(common::FrameBudget::Level level)
+{
+    // The pose markers follow the style, read again with the new level.
+    visibilityGate().setMinPeriod(
+        level >= common::FrameBudget::REDUCED_UPDATE_RATE ? common::FrameBudget::kReducedUpdatePeriod : 0.0f);
+    resetDuplicateDetection();
+}
+
+void PathsDisplay::resetDuplicateDetection()
+{
+    last_message_hash_.reset();
+}
+
+bool PathsDisplay::isDuplicate(uint64_t hash) const
+{
+    // The fading paths carry their stamp, which must be refreshed.
+    return skip_duplicates_property_->getBool() && !isFading() && last_message_hash_ == hash;
 }
 
 void PathsDisplay::reset()
 {
     MFDClass::reset();
-    updateBufferLength();
+    visibilityGate().clear();
+    clearSlots();
+    prewarmSlots();
+    clearTimeline();
+    clearExecuted();
+    resetDuplicateDetection();
 }
 
-
-void PathsDisplay::allocateAxesVector(std::vector<std::unique_ptr<rviz_rendering::Axes>> & axes_vect, size_t num)
+void PathsDisplay::update(float wall_dt, float ros_dt)
 {
-    auto vector_size = axes_vect.size();
-    if (num > vector_size) {
-        axes_vect.reserve(num);
-        for (auto i = vector_size; i < num; ++i) {
-        axes_vect.push_back(
-            std::make_unique<rviz_rendering::Axes>(
-            scene_manager_, scene_node_,
-            pose_axes_length_property_->getFloat(),
-            pose_axes_radius_property_->getFloat()));
-        }
-    } else if (num < vector_size) {
-        axes_vect.resize(num);
+    MFDClass::update(wall_dt, ros_dt);
+    visibilityGate().update(wall_dt);
+    updateTimeline(wall_dt);
+    followFrameBudget();
+
+    // The only per-frame work of fading, whatever the number of buffered paths.
+    if (isFading()) {
+        fade_material_->setNow(context_->getClock()->now());
+    }
+
+    // Likewise, the shadows follow the terrain by a parameter update.
+    Ogre::Vector3 terrain_position;
+    Ogre::Quaternion terrain_orientation;
+    if (isShadowing() &&
+        context_->getFrameManager()->getTransform(
+            terrain_frame_property_->getFrameStd(), terrain_position, terrain_orientation))
+    {
+        terrain_shadow_material_->setPlane(
+            terrain_plane_.transformed(terrain_position, terrain_orientation));
     }
 }
 
-void PathsDisplay::allocateArrowVector(std::vector<std::unique_ptr<rviz_rendering::Arrow>> & arrow_vect, size_t num)
+void PathsDisplay::updateFadeDuration()
 {
-    auto vector_size = arrow_vect.size();
-    if (num > vector_size) {
-        arrow_vect.reserve(num);
-        for (auto i = vector_size; i < num; ++i) {
-        arrow_vect.push_back(std::make_unique<rviz_rendering::Arrow>(scene_manager_, scene_node_));
-        }
-    } else if (num < vector_size) {
-        arrow_vect.resize(num);
+    bool was_fading = isFading();
+    if (fade_duration_property_->getFloat() > 0.0F && !fade_material_) {
+        fade_material_ = std::make_unique<common::AgeFadeMaterial>();
+    }
+    if (fade_material_) {
+        fade_material_->setFadeDuration(fade_duration_property_->getFloat());
+    }
+    // The paths drawn before carry no stamp, or the stamps of a material no longer used.
+    if (isFading() != was_fading) {
+        clearSlots();
+        prewarmSlots();
     }
+    resetDuplicateDetection();
+    context_->queueRender();
+}
+
+bool PathsDisplay::isFading() const
+{
+    return fade_material_ && fade_duration_property_->getFloat() > 0.0F &&
+           static_cast<PathsPolicy::LineStyle>(style_property_->getOptionInt()) == PathsPolicy::LINES;
 }
 
-void PathsDisplay::destroyPoseAxesChain()
+std::unique_ptr<PathsDisplay::Instance> PathsDisplay::createInstance(Ogre::SceneNode * parent)
 {
-    for (auto & axes_vect : axes_chain_) {
-        allocateAxesVector(axes_vect, 0);
+    auto instance = std::make_unique<Instance>(parent);
+    switch (style().line_style) {
+        case PathsPolicy::LINES:  // simple lines with fixed width of 1px
+        instance->manual_object = scene_manager_->createManualObject();
+        instance->manual_object->setDynamic(true);
+        parent->attachObject(instance->manual_object);
+        break;
+
+        case PathsPolicy::BILLBOARDS:  // billboards with configurable width
+        instance->billboard_line = std::make_unique<rviz_rendering::BillboardLine>(scene_manager_, parent);
+        break;
     }
-    axes_chain_.clear();
+    return instance;
 }
 
-void PathsDisplay::destroyPoseArrowChain()
+void PathsDisplay::prewarmInstance(Instance & instance)
 {
-    for (auto & arrow_vect : arrow_chain_) {
-        allocateArrowVector(arrow_vect, 0);
+    auto length = static_cast<size_t>(expected_path_length_property_->getInt());
+    if (length == 0) {
+        return;
+    }
+
+    if (instance.manual_object) {
+        // The vertex buffer is sized by a first section, emptied by setVisible() next.
+        auto * manual_object = instance.manual_object;
+        manual_object->estimateVertexCount(length);
+        manual_object->begin(
+            (*opaque_lines_material_)->getName(), Ogre::RenderOperation::OT_LINE_STRIP, "rviz_rendering");
+        for (size_t k = 0; k < length; k++) {
+            manual_object->position(Ogre::Vector3::ZERO);
+            manual_object->colour(Ogre::ColourValue::White);
+            manual_object->textureCoord(0.0f);
+        }
+        manual_object->end();
+    }
+    if (instance.billboard_line) {
+        instance.billboard_line->setNumLines(1);
+        instance.billboard_line->setMaxPointsPerLine(static_cast<uint32_t>(length));
     }
-    arrow_chain_.clear();
 }
 
-void PathsDisplay::updateStyle()
+void PathsDisplay::readStyle(Style & style) const
 {
-    auto style = static_cast<LineStyle>(style_property_->getOptionInt());
+    style.line_style = static_cast<PathsPolicy::LineStyle>(style_property_->getOptionInt());
+    style.line_width = line_width_property_->getFloat();
+    style.color_mode = static_cast<PathsPolicy::ColorMode>(color_mode_property_->getOptionInt());
+    style.colormap = static_cast<common::Colormap>(colormap_property_->getOptionInt());
+    style.auto_range = auto_range_property_->getBool();
+    style.range_min = range_min_property_->getFloat();
+    style.range_max = range_max_property_->getFloat();
+    style.color = color_property_->getOgreColor();
+    style.color.a = alpha_property_->getFloat();
+    style.pose_style = static_cast<PathsPolicy::PoseStyle>(pose_style_property_->getOptionInt());
+    style.pose_stride = frameBudgetLevel() >= common::FrameBudget::REDUCED_POSE_MARKERS ?
+        kReducedPoseStride : 1;
+    style.axes_length = pose_axes_length_property_->getFloat();
+    style.axes_radius = pose_axes_radius_property_->getFloat();
+    style.arrow_shaft_length = pose_arrow_shaft_length_property_->getFloat();
+    style.arrow_head_length = pose_arrow_head_length_property_->getFloat();
+    style.arrow_shaft_diameter = pose_arrow_shaft_diameter_property_->getFloat();
+    style.arrow_head_diameter = pose_arrow_head_diameter_property_->getFloat();
+}
+
+Ogre::ColourValue PathsDisplay::getPoseArrowColor() const
+{
+    auto color = pose_arrow_color_property_->getOgreColor();
+    color.a = 1.0f;
+    return color;
+}
 
-    if (style == BILLBOARDS) {
+void PathsDisplay::updateStyle()
+{
+    if (style().line_style == PathsPolicy::BILLBOARDS) {
         line_width_property_->show();
     } else {
         line_width_property_->hide();
     }
 
-    updateBufferLength();
+    // The instances are created for a Line Style.
+    clearSlots();
+    prewarmSlots();
+    resetDuplicateDetection();
+    context_->queueRender();
 }
 
-void PathsDisplay::updateLineWidth()
+void PathsDisplay::updateExpectedPathLength()
 {
-    auto style = static_cast<LineStyle>(style_property_->getOptionInt());
-    float line_width = line_width_property_->getFloat();
+    // The paths are created again, for the new length.
+    clearSlots();
+    prewarmSlots();
+    resetDuplicateDetection();
+    context_->queueRender();
+}
 
-    if (style == BILLBOARDS) {
-        for (auto& billboard_line : billboard_lines_) {
-        if (billboard_line) {
-            billboard_line->setLineWidth(line_width);
-        }
-        }
-    }
+void PathsDisplay::updateLineWidth()
+{
+    float line_width = style().line_width;
+    forEachInstance(
+        [line_width](Instance & instance) {
+            if (instance.billboard_line) {
+                instance.billboard_line->setLineWidth(line_width);
+            }
+        });
     context_->queueRender();
 }
 
@@ -261,9 +814,8 @@ void PathsDisplay::updateOffset()
 
 void PathsDisplay::updatePoseStyle()
 {
-    auto pose_style = static_cast<PoseStyle>(pose_style_property_->getOptionInt());
-    switch (pose_style) {
-        case AXES:
+    switch (style().pose_style) {
+        case PathsPolicy::AXES:
         pose_axes_length_property_->show();
         pose_axes_radius_property_->show();
         pose_arrow_color_property_->hide();
@@ -272,7 +824,7 @@ void PathsDisplay::updatePoseStyle()
         pose_arrow_shaft_diameter_property_->hide();
         pose_arrow_head_diameter_property_->hide();
         break;
-        case ARROWS:
+        case PathsPolicy::ARROWS:
         pose_axes_length_property_->hide();
         pose_axes_radius_property_->hide();
         pose_arrow_color_property_->show();
@@ -290,266 +842,938 @@ void PathsDisplay::updatePoseStyle()
         pose_arrow_shaft_diameter_property_->hide();
         pose_arrow_head_diameter_property_->hide();
     }
-    updateBufferLength();
+
+    // The markers of the new style are drawn from the next message on.
+    forEachInstance([](Instance & instance) {emptySection(instance.markers);});
+    resetDuplicateDetection();
+    context_->queueRender();
 }
 
 void PathsDisplay::updatePoseAxisGeometry()
 {
-    for (auto & axes_vect : axes_chain_) {
-        for (auto & axes : axes_vect) {
-        axes->set(
-            pose_axes_length_property_->getFloat(),
-            pose_axes_radius_property_->getFloat() );
-        }
-    }
+    // The sizes of the markers are parameters of their material.
+    const auto & current_style = style();
+    pose_marker_material_->setAxesGeometry(current_style.axes_length, current_style.axes_radius);
+    updateMarkerBounds();
     context_->queueRender();
 }
 
 void PathsDisplay::updatePoseArrowColor()
 {
-    QColor color = pose_arrow_color_property_->getColor();
+    pose_marker_material_->setArrowColor(getPoseArrowColor());
+    context_->queueRender();
+}
 
-    for (auto & arrow_vect : arrow_chain_) {
-        for (auto & arrow : arrow_vect) {
-        arrow->setColor(color.redF(), color.greenF(), color.blueF(), 1.0F);
-        }
+void PathsDisplay::updatePoseArrowGeometry()
+{
+    const auto & current_style = style();
+    pose_marker_material_->setArrowGeometry(
+        current_style.arrow_shaft_length, current_style.arrow_shaft_diameter,
+        current_style.arrow_head_length, current_style.arrow_head_diameter);
+    updateMarkerBounds();
+    context_->queueRender();
+}
+
+void PathsDisplay::createPoseMarkerMaterial()
+{
+    pose_marker_material_ = std::make_unique<common::PoseMarkerMaterial>();
+    updatePoseAxisGeometry();
+    updatePoseArrowGeometry();
+    updatePoseArrowColor();
+}
+
+void PathsDisplay::updateMarkerBounds()
+{
+    float extent = pose_marker_material_->extent();
+    if (extent <= marker_bounds_extent_) {
+        return;
+    }
+    marker_bounds_extent_ = 2.0f * extent;
+    forEachInstance([this](Instance & instance) {setMarkerBounds(instance);});
+}
+
+void PathsDisplay::setMarkerBounds(Instance & instance)
+{
+    if (!instance.markers) {
+        return;
+    }
+    if (instance.marker_positions.isNull()) {
+        instance.markers->setBoundingBox(Ogre::AxisAlignedBox::BOX_NULL);
+        return;
     }
+    // The shader moves the vertices away from the poses, by up to the marker extent.
+    Ogre::Vector3 padding(marker_bounds_extent_);
+    instance.markers->setBoundingBox(
+        Ogre::AxisAlignedBox(
+            instance.marker_positions.getMinimum() - padding,
+            instance.marker_positions.getMaximum() + padding));
+}
+
+void PathsDisplay::updateBufferLength()
+{
+    setHistoryLength(static_cast<size_t>(buffer_length_property_->getInt()));
+    resetDuplicateDetection();
     context_->queueRender();
 }
 
-void PathsDisplay::updatePoseArrowGeometry()
+void PathsDisplay::processMessage(rviz_legged_msgs::msg::Paths::ConstSharedPtr msg)
 {
-    for (auto & arrow_vect : arrow_chain_) {
-        for (auto & arrow : arrow_vect) {
-        arrow->set(
-            pose_arrow_shaft_length_property_->getFloat(),
-            pose_arrow_shaft_diameter_property_->getFloat(),
-            pose_arrow_head_length_property_->getFloat(),
-            pose_arrow_head_diameter_property_->getFloat());
+    if (!visibilityGate().isReplaying()) {
+        accumulateExecuted(*msg);
+    }
+
+    if (!admitMessage(&PathsDisplay::processMessage, msg)) {
+        return;
+    }
+
+    RVIZ_LEGGED_TRACE_SCOPE("processMessage", "Paths");
+
+    traceMessageAge(msg->header.stamp);
+
+    // All the paths share the header, hence the transform into the fixed frame is looked up once
+    // and applied to the node of their slot.
+    FrameTransform frame;
+    beginFrameBatch();
+    if (!lookupFrame(msg->header, frame)) {
+        return;
+    }
+
+    // A message identical to the previous one was already validated.
+    uint64_t hash = hashMessage(*msg, !ignore_stamps_property_->getBool());
+    bool duplicate = isDuplicate(hash);
+
+    auto error = duplicate ? common::MessageError::NONE : common::validatePaths(*msg);
+    if (error != common::MessageError::NONE) {
+        setStatus(rviz_common::properties::StatusProperty::Error, "Topic", common::describe(error));
+        return;
+    }
+
+    // While scrubbing, the timeline keeps the drawn paths.
+    recordPaths(*msg, frame);
+    if (isScrubbing()) {
+        return;
+    }
+
+    // A message identical to the previous one only moves the newest paths with its frame.
+    if (duplicate) {
+        newestSlot()->node->setPosition(frame.position);
+        newestSlot()->node->setOrientation(frame.orientation);
+        context_->queueRender();
+        return;
+    }
+    resetDuplicateDetection();
+
+    addPaths(*msg, frame);
+    last_message_hash_ = hash;
+
+    context_->queueRender();
+}
+
+void PathsDisplay::processAdaptedMessage(std::shared_ptr<const type_adapters::EigenPaths> msg)
+{
+    if (!visibilityGate().isReplaying()) {
+        accumulateExecuted(*msg);
+    }
+
+    if (!admitMessage(&PathsDisplay::processAdaptedMessage, msg)) {
+        return;
+    }
+
+    RVIZ_LEGGED_TRACE_SCOPE("processAdaptedMessage", "Paths");
+
+    traceMessageAge(msg->header.stamp);
+
+    setStatus(
+        rviz_common::properties::StatusProperty::Ok, "Intra-process Topic",
+        QString::number(++adapted_messages_received_) + " messages received");
+
+    FrameTransform frame;
+    beginFrameBatch();
+    if (!lookupFrame(msg->header, frame)) {
+        return;
+    }
+
+    uint64_t hash = hashMessage(*msg, !ignore_stamps_property_->getBool());
+    bool duplicate = isDuplicate(hash);
+
+    for (size_t i = 0; i < msg->paths.size() && !duplicate; i++) {
+        if (!msg->paths[i].allFinite()) {
+            setStatus(
+                rviz_common::properties::StatusProperty::Error, "Intra-process Topic",
+                "Message contained invalid floating point values (nans or infs)");
+            return;
         }
     }
+
+    recordPaths(*msg, frame);
+    if (isScrubbing()) {
+        return;
+    }
+
+    if (duplicate) {
+        newestSlot()->node->setPosition(frame.position);
+        newestSlot()->node->setOrientation(frame.orientation);
+        context_->queueRender();
+        return;
+    }
+    resetDuplicateDetection();
+
+    addPaths(*msg, frame);
+    last_message_hash_ = hash;
+
     context_->queueRender();
 }
 
-void PathsDisplay::destroyObjects()
+void PathsDisplay::subscribe()
+{
+    BufferedContactDisplay::subscribe();
+    subscribeAdapted();
+    subscribeSerialized();
+    subscribeTerrain();
+}
+
+void PathsDisplay::unsubscribe()
 {
-    // Destroy all simple lines, if any
-    for (auto * manual_object : manual_objects_) {
-        manual_object->clear();
-        scene_manager_->destroyManualObject(manual_object);
+    MFDClass::unsubscribe();
+    adapted_subscription_.reset();
+    serialized_subscription_.reset();
+    terrain_subscription_.reset();
+    adapted_filter_.clear();
+    serialized_filter_.clear();
+}
+
+void PathsDisplay::fixedFrameChanged()
+{
+    adapted_filter_.setTargetFrame(fixed_frame_.toStdString());
+    serialized_filter_.setTargetFrame(fixed_frame_.toStdString());
+    MFDClass::fixedFrameChanged();
+}
+
+void PathsDisplay::subscribeAdapted()
+{
+    if (!isEnabled() || adapted_topic_property_->isEmpty()) {
+        deleteStatus("Intra-process Topic");
+        return;
     }
-    manual_objects_.clear();
 
-    // Destroy all billboards, if any
-    billboard_lines_.clear();
+    // Publishers of EigenPaths in the same process deliver their messages without any conversion.
+    rclcpp::SubscriptionOptions options;
+    options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+
+    resetTransformFilter(adapted_filter_);
+    try {
+        adapted_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<type_adapters::EigenPaths>(
+                adapted_topic_property_->getTopicStd(), qos_profile,
+                [this](std::shared_ptr<const type_adapters::EigenPaths> msg) {
+                    adapted_filter_.add(msg);
+                },
+                options);
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Intra-process Topic", "OK");
+    } catch (const std::exception & e) {
+        // Intra-process communication also rejects QoS profiles with transient local durability.
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Intra-process Topic",
+            QString("Error subscribing: ") + e.what());
+    }
 }
 
-void PathsDisplay::updateBufferLength()
+void PathsDisplay::updateAdaptedTopic()
+{
+    adapted_subscription_.reset();
+    adapted_filter_.clear();
+    adapted_messages_received_ = 0;
+    subscribeAdapted();
+    context_->queueRender();
+}
+
+void PathsDisplay::subscribeSerialized()
 {
-    // Destroy all path objects
-    destroyObjects();
+    if (!isEnabled() || serialized_topic_property_->isEmpty()) {
+        deleteStatus("Serialized Topic");
+        return;
+    }
 
-    // Destroy all axes and arrows
-    destroyPoseAxesChain();
-    destroyPoseArrowChain();
+    resetTransformFilter(serialized_filter_);
+    try {
+        // The subscription hands over the bytes received, which are decoded by the display once
+        // the transform of their header is available.
+        serialized_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<rviz_legged_msgs::msg::Paths>(
+                serialized_topic_property_->getTopicStd(), qos_profile,
+                [this](std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+                    addSerializedMessage(msg);
+                });
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Serialized Topic", "OK");
+    } catch (const std::exception & e) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Serialized Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
 
-    // Read options
-    auto buffer_length = number_paths_ * static_cast<size_t>(buffer_length_property_->getInt());
-    auto style = static_cast<LineStyle>(style_property_->getOptionInt());
+void PathsDisplay::updateSerializedTopic()
+{
+    serialized_subscription_.reset();
+    serialized_filter_.clear();
+    serialized_messages_received_ = 0;
+    subscribeSerialized();
+    context_->queueRender();
+}
 
-    // Create new path objects
-    switch (style) {
-        case LINES:  // simple lines with fixed width of 1px
-        manual_objects_.reserve(buffer_length);
-        for (size_t i = 0; i < buffer_length; i++) {
-            auto * manual_object = scene_manager_->createManualObject();
-            manual_object->setDynamic(true);
-            scene_node_->attachObject(manual_object);
+void PathsDisplay::addSerializedMessage(std::shared_ptr<const rclcpp::SerializedMessage> msg)
+{
+    auto paths = std::make_shared<SerializedPaths>();
+    const auto & serialized = msg->get_rcl_serialized_message();
+    common::CdrReader reader(serialized.buffer, serialized.buffer_length);
+    if (!readSerializedHeader(reader, paths->header)) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Serialized Topic",
+            "Message was malformed");
+        return;
+    }
+    paths->message = std::move(msg);
+    serialized_filter_.add(paths);
+}
 
-            manual_objects_.push_back(manual_object);
-        }
-        break;
+void PathsDisplay::processSerializedMessage(std::shared_ptr<const rclcpp::SerializedMessage> msg)
+{
+    if (!visibilityGate().isReplaying()) {
+        accumulateExecuted(*msg);
+    }
 
-        case BILLBOARDS:  // billboards with configurable width
-        billboard_lines_.reserve(buffer_length);
-        for (size_t i = 0; i < buffer_length; i++) {
-            billboard_lines_.push_back(
-                std::make_unique<rviz_rendering::BillboardLine>(scene_manager_, scene_node_)
-            );
-        }
-        break;
+    if (!admitMessage(&PathsDisplay::processSerializedMessage, msg)) {
+        return;
+    }
+
+    RVIZ_LEGGED_TRACE_SCOPE("processSerializedMessage", "Paths");
+
+    if (!decodePaths(msg->get_rcl_serialized_message())) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Serialized Topic",
+            "Message was malformed or contained invalid floating point values (nans or infs)");
+        return;
+    }
+    setStatus(
+        rviz_common::properties::StatusProperty::Ok, "Serialized Topic",
+        QString::number(++serialized_messages_received_) + " messages received");
+
+    const auto & header = decoded_paths_.header;
+    traceMessageAge(header.stamp);
+
+    FrameTransform frame;
+    beginFrameBatch();
+    if (!lookupFrame(header, frame)) {
+        return;
+    }
+
+    // The decoded paths were validated while decoded.
+    uint64_t hash = hashMessage(
+        header, decoded_paths_.record.values, decoded_paths_.record.rows,
+        !ignore_stamps_property_->getBool());
+    bool duplicate = isDuplicate(hash);
+
+    recordPaths(decoded_paths_, frame);
+    if (isScrubbing()) {
+        return;
     }
-    axes_chain_.resize(buffer_length);
-    arrow_chain_.resize(buffer_length);
+
+    if (duplicate) {
+        newestSlot()->node->setPosition(frame.position);
+        newestSlot()->node->setOrientation(frame.orientation);
+        context_->queueRender();
+        return;
+    }
+    resetDuplicateDetection();
+
+    addPaths(decoded_paths_, frame);
+    last_message_hash_ = hash;
+
+    context_->queueRender();
 }
 
-bool validateFloats(const nav_msgs::msg::Path & msg)
+bool PathsDisplay::decodePaths(const rcl_serialized_message_t & serialized)
 {
-    bool valid = true;
-    valid = valid && rviz_common::validateFloats(msg.poses);
+    common::CdrReader reader(serialized.buffer, serialized.buffer_length);
+    if (!readSerializedHeader(reader, decoded_paths_.header)) {
+        return false;
+    }
+
+    // A first pass sizes the columns, by the rows of every path.
+    auto poses_reader = reader;
+    auto & paths = decoded_paths_.paths;
+    paths.clear();
+    size_t rows = 1;
+    bool valid = readSerializedPaths(
+        reader,
+        [&paths, &rows](uint32_t, uint32_t pose_count) {
+            paths.push_back({rows, rows + pose_count});
+            rows += pose_count;
+        },
+        [](uint32_t, uint32_t, const SerializedPose &) {});
+    if (!valid) {
+        return false;
+    }
+
+    decoded_values_.assign(rows * PathsPolicy::kTimelineColumns, 0.0f);
+    float * values = decoded_values_.data();
+    int64_t first_stamp_ns = 0;
+    readSerializedPaths(
+        poses_reader, [](uint32_t, uint32_t) {},
+        [&](uint32_t path_index, uint32_t pose_index, const SerializedPose & pose) {
+            size_t row = paths[path_index].begin + pose_index;
+            for (size_t column = 0; column < 7; column++) {
+                valid = valid && std::isfinite(pose.values[column]);
+                values[column * rows + row] = static_cast<float>(pose.values[column]);
+            }
+            // The time along the horizon is relative to the first pose of the path.
+            int64_t stamp_ns = static_cast<int64_t>(pose.sec) * 1000000000 + pose.nanosec;
+            if (pose_index == 0) {
+                first_stamp_ns = stamp_ns;
+            }
+            values[7 * rows + row] = 1e-9f * static_cast<float>(stamp_ns - first_stamp_ns);
+            values[8 * rows + row] = static_cast<float>(path_index);
+        });
+
+    decoded_paths_.record = {rclcpp::Time(header.stamp).nanoseconds(), rows, values};
     return valid;
 }
 
-void PathsDisplay::processMessage(rviz_legged_msgs::msg::Paths::ConstSharedPtr msg)
+bool PathsDisplay::readFirstPosition(
+    const rviz_legged_msgs::msg::Paths & msg, size_t path_index, Ogre::Vector3 & position)
 {
-    number_paths_ = static_cast<int>(msg->paths.size());
-    updateBufferLength();
+    const auto & poses = msg.paths[path_index].poses;
+    if (poses.empty()) {
+        return false;
+    }
+    position = rviz_common::pointMsgToOgre(poses.front().pose.position);
+    return true;
+}
 
-    for (int i = 0; i < number_paths_; i++) {
-        auto path_msg = msg->paths[i];
+bool PathsDisplay::readFirstPosition(
+    const type_adapters::EigenPaths & msg, size_t path_index, Ogre::Vector3 & position)
+{
+    const auto & path = msg.paths[path_index];
+    if (path.cols() == 0) {
+        return false;
+    }
+    position = Ogre::Vector3(
+        static_cast<float>(path(0, 0)), static_cast<float>(path(1, 0)), static_cast<float>(path(2, 0)));
+    return true;
+}
 
-        auto style = static_cast<LineStyle>(style_property_->getOptionInt());
-        Ogre::ManualObject * manual_object = nullptr;
-        rviz_rendering::BillboardLine * billboard_line = nullptr;
 
-        // Delete oldest element
-        switch (style) {
-            case LINES:
-            manual_object = manual_objects_[i];
-            manual_object->clear();
-            break;
+template<typename PathsMessage>
+void PathsDisplay::accumulateExecuted(const PathsMessage & msg)
+{
+    if (!executed_property_->getBool() || !executed_node_) {
+        return;
+    }
 
-            case BILLBOARDS:
-            billboard_line = billboard_lines_[i].get();
-            billboard_line->clear();
-            break;
+    first_positions_.resize(msg.paths.size());
+    for (size_t i = 0; i < msg.paths.size(); i++) {
+        if (!readFirstPosition(msg, i, first_positions_[i])) {
+            first_positions_[i] = Ogre::Vector3(std::numeric_limits<float>::quiet_NaN());
         }
+    }
+    appendExecuted(msg.header);
+}
 
-        // Check if path contains invalid coordinate values
-        if (!validateFloats(path_msg)) {
-            setStatus(
-            rviz_common::properties::StatusProperty::Error, "Topic", "Message contained invalid "
-            "floating point "
-            "values (nans or infs)");
-            return;
+void PathsDisplay::accumulateExecuted(const rclcpp::SerializedMessage & msg)
+{
+    if (!executed_property_->getBool() || !executed_node_) {
+        return;
+    }
+
+    // Only the first pose of every path is kept, the message being decoded once admitted.
+    const auto & serialized = msg.get_rcl_serialized_message();
+    common::CdrReader reader(serialized.buffer, serialized.buffer_length);
+    first_positions_.clear();
+    bool valid = readSerializedHeader(reader, executed_header_) && readSerializedPaths(
+        reader,
+        [this](uint32_t, uint32_t) {
+            first_positions_.emplace_back(std::numeric_limits<float>::quiet_NaN());
+        },
+        [this](uint32_t path_index, uint32_t pose_index, const SerializedPose & pose) {
+            if (pose_index == 0) {
+                first_positions_[path_index] = Ogre::Vector3(
+                    static_cast<float>(pose.values[0]), static_cast<float>(pose.values[1]),
+                    static_cast<float>(pose.values[2]));
+            }
+        });
+    // A malformed message is reported once decoded.
+    if (valid) {
+        appendExecuted(executed_header_);
+    }
+}
+
+void PathsDisplay::appendExecuted(const std_msgs::msg::Header & header)
+{
+    FrameTransform frame;
+    beginFrameBatch();
+    if (!lookupFrame(header, frame)) {
+        return;
+    }
+
+    // The points keep the color they were appended with, hence the trails stay transparent once
+    // they hold a transparent point.
+    const auto & color = style().color;
+    if (common::MaterialCache::isTransparent(color.a) && !executed_transparent_) {
+        executed_transparent_ = true;
+        for (auto & trail : executed_trails_) {
+            trail->setMaterial(*transparent_lines_material_);
         }
+    }
+    while (executed_trails_.size() < first_positions_.size()) {
+        auto trail = std::make_unique<common::TrailBuffer>();
+        trail->setMaxPoints(static_cast<size_t>(executed_max_points_property_->getInt()));
+        trail->setMaterial(executed_transparent_ ? *transparent_lines_material_ : *opaque_lines_material_);
+        executed_node_->attachObject(trail.get());
+        executed_trails_.push_back(std::move(trail));
+    }
 
-        // Lookup transform into fixed frame
-        Ogre::Vector3 position;
-        Ogre::Quaternion orientation;
-        if (!context_->getFrameManager()->getTransform(msg->header, position, orientation)) {
-            setMissingTransformToFixedFrame(msg->header.frame_id);
-            return;
+    for (size_t i = 0; i < first_positions_.size(); i++) {
+        const auto & first_position = first_positions_[i];
+        if (!std::isfinite(first_position.x) || !std::isfinite(first_position.y) ||
+            !std::isfinite(first_position.z))
+        {
+            continue;
         }
-        setTransformOk();
+        auto position = frame.position + frame.orientation * first_position;
+        // A standing foot adds no point.
+        auto & trail = *executed_trails_[i];
+        if (trail.empty() || trail.back() != position) {
+            trail.append(position, color);
+        }
+    }
+}
 
-        Ogre::Matrix4 transform(orientation);
-        transform.setTrans(position);
+void PathsDisplay::clearExecuted()
+{
+    executed_trails_.clear();
+    executed_transparent_ = false;
+}
 
-        switch (style) {
-            case LINES:
-            updateManualObject(manual_object, path_msg, transform);
-            break;
+void PathsDisplay::recordPaths(const rviz_legged_msgs::msg::Paths & msg, const FrameTransform & frame)
+{
+    size_t rows = 1;
+    for (const auto & path_msg : msg.paths) {
+        rows += path_msg.poses.size();
+    }
+    float * values = recordMessage(msg.header.stamp, rows);
+    if (!values) {
+        return;
+    }
 
-            case BILLBOARDS:
-            updateBillBoardLine(billboard_line, path_msg, transform);
-            break;
+    writeRecordRow(values, rows, 0, frame.position, frame.orientation, 0.0f, -1.0f);
+    size_t row = 1;
+    for (size_t i = 0; i < msg.paths.size(); i++) {
+        const auto & poses = msg.paths[i].poses;
+        for (const auto & pose_stamped : poses) {
+            // The time along the horizon is relative to the first pose of the path.
+            auto time = rclcpp::Time(pose_stamped.header.stamp) - rclcpp::Time(poses.front().header.stamp);
+            writeRecordRow(
+                values, rows, row++, rviz_common::pointMsgToOgre(pose_stamped.pose.position),
+                rviz_common::quaternionMsgToOgre(pose_stamped.pose.orientation),
+                static_cast<float>(time.seconds()), static_cast<float>(i));
         }
-        updatePoseMarkers(i, path_msg, transform);
+    }
+}
 
-        context_->queueRender();
+void PathsDisplay::recordPaths(const type_adapters::EigenPaths & msg, const FrameTransform & frame)
+{
+    size_t rows = 1;
+    for (const auto & path : msg.paths) {
+        rows += static_cast<size_t>(path.cols());
+    }
+    float * values = recordMessage(msg.header.stamp, rows);
+    if (!values) {
+        return;
+    }
+
+    // The rows of the path matrices are the first columns of the record.
+    writeRecordRow(values, rows, 0, frame.position, frame.orientation, 0.0f, -1.0f);
+    size_t row = 1;
+    for (size_t i = 0; i < msg.paths.size(); i++) {
+        const auto & path = msg.paths[i];
+        for (Eigen::Index k = 0; k < path.cols(); k++, row++) {
+            for (Eigen::Index column = 0; column < path.rows(); column++) {
+                values[static_cast<size_t>(column) * rows + row] = static_cast<float>(path(column, k));
+            }
+            values[7 * rows + row] = 0.0f;
+            values[8 * rows + row] = static_cast<float>(i);
+        }
     }
 }
 
-void PathsDisplay::updateManualObject(
-    Ogre::ManualObject * manual_object, nav_msgs::msg::Path& msg,
-    const Ogre::Matrix4 & transform)
+void PathsDisplay::recordPaths(const RecordedPaths & msg, const FrameTransform & frame)
 {
-    auto color = color_property_->getOgreColor();
-    color.a = alpha_property_->getFloat();
+    const auto & record = msg.record;
+    float * values = recordMessage(msg.header.stamp, record.rows);
+    if (!values) {
+        return;
+    }
 
-    manual_object->estimateVertexCount(msg.poses.size());
-    manual_object->begin(
-        lines_material_->getName(), Ogre::RenderOperation::OT_LINE_STRIP, "rviz_rendering");
+    std::copy(record.values, record.values + record.rows * PathsPolicy::kTimelineColumns, values);
+    writeRecordRow(values, record.rows, 0, frame.position, frame.orientation, 0.0f, -1.0f);
+}
 
-    for (const auto & pose_stamped : msg.poses) {
-        manual_object->position(transform * rviz_common::pointMsgToOgre(pose_stamped.pose.position));
-        rviz_rendering::MaterialManager::enableAlphaBlending(lines_material_, color.a);
-        manual_object->colour(color);
+void PathsDisplay::renderRecord(const common::TimelineStore::Record & record)
+{
+    if (record.rows == 0) {
+        return;
     }
 
-    manual_object->end();
+    RecordedPaths recorded;
+    recorded.header.stamp = rclcpp::Time(record.stamp_ns);
+    recorded.record = record;
+    const float * path_indices = record.column(8);
+    for (size_t row = 1; row < record.rows; row++) {
+        auto path_index = static_cast<size_t>(path_indices[row]);
+        if (path_index >= recorded.paths.size()) {
+            recorded.paths.resize(path_index + 1, {row, row});
+        }
+        recorded.paths[path_index].end = row + 1;
+    }
+
+    auto value = [&record](size_t column) {return record.column(column)[0];};
+    FrameTransform frame;
+    frame.position = Ogre::Vector3(value(0), value(1), value(2));
+    frame.orientation = Ogre::Quaternion(value(6), value(3), value(4), value(5));
+    addPaths(recorded, frame);
+
+    // The newest paths are those of the record.
+    resetDuplicateDetection();
 }
 
-void PathsDisplay::updateBillBoardLine(
-    rviz_rendering::BillboardLine * billboard_line, nav_msgs::msg::Path& msg,
-    const Ogre::Matrix4 & transform)
+template<typename PathsMessage>
+void PathsDisplay::addPaths(const PathsMessage & msg, const FrameTransform & frame)
 {
-    auto color = color_property_->getOgreColor();
-    color.a = alpha_property_->getFloat();
+    // Once the buffer is full, the objects of the oldest message are reused.
+    auto & slot = claimSlot(msg.paths.size());
+    slot.node->setPosition(frame.position);
+    slot.node->setOrientation(frame.orientation);
 
-    billboard_line->setNumLines(1);
-    billboard_line->setMaxPointsPerLine(static_cast<uint32_t>(msg.poses.size()));
-    billboard_line->setLineWidth(line_width_property_->getFloat());
+    if (isFading()) {
+        path_stamp_ = fade_material_->toShaderTime(rclcpp::Time(msg.header.stamp));
+    }
+    computePathScalars(msg);
+
+    switch (style().line_style) {
+        case PathsPolicy::LINES:
+        dispatchPoseStyle<PathsPolicy::LINES>(msg, slot);
+        break;
 
-    for (const auto & pose_stamped : msg.poses) {
-        Ogre::Vector3 xpos = transform * rviz_common::pointMsgToOgre(pose_stamped.pose.position);
-        billboard_line->addPoint(xpos, color);
+        case PathsPolicy::BILLBOARDS:
+        dispatchPoseStyle<PathsPolicy::BILLBOARDS>(msg, slot);
+        break;
+    }
+}
+
+template<PathsPolicy::LineStyle kLineStyle, typename PathsMessage>
+void PathsDisplay::dispatchPoseStyle(const PathsMessage & msg, Slot & slot)
+{
+    switch (style().pose_style) {
+        case PathsPolicy::AXES:
+        renderPaths<kLineStyle, PathsPolicy::AXES>(msg, slot);
+        break;
+
+        case PathsPolicy::ARROWS:
+        renderPaths<kLineStyle, PathsPolicy::ARROWS>(msg, slot);
+        break;
+
+        default:
+        renderPaths<kLineStyle, PathsPolicy::NONE>(msg, slot);
     }
 }
 
-void PathsDisplay::updatePoseMarkers(
-    size_t buffer_index, nav_msgs::msg::Path& msg, const Ogre::Matrix4 & transform)
+template<PathsPolicy::LineStyle kLineStyle, PathsPolicy::PoseStyle kPoseStyle, typename PathsMessage>
+void PathsDisplay::renderPaths(const PathsMessage & msg, Slot & slot)
 {
-    auto pose_style = static_cast<PoseStyle>(pose_style_property_->getOptionInt());
-    auto & arrow_vect = arrow_chain_[buffer_index];
-    auto & axes_vect = axes_chain_[buffer_index];
+    RVIZ_LEGGED_TRACE_SCOPE("renderPaths", "Paths");
+
+    for (size_t i = 0; i < slot.size; i++) {
+        auto & instance = *slot.instances[i];
+
+        readPathPoses(msg, i, kPoseStyle != PathsPolicy::NONE);
+        updatePathColors(i);
 
-    if (pose_style == AXES) {
-        updateAxesMarkers(axes_vect, msg, transform);
+        if constexpr (kLineStyle == PathsPolicy::LINES) {
+            updateManualObject(instance.manual_object);
+        } else {
+            updateBillBoardLine(instance.billboard_line.get());
+        }
+
+        if constexpr (kPoseStyle != PathsPolicy::NONE) {
+            updatePoseMarkers(instance, kPoseStyle);
+        }
     }
-    if (pose_style == ARROWS) {
-        updateArrowMarkers(arrow_vect, msg, transform);
+}
+
+void PathsDisplay::readPathPoses(
+    const rviz_legged_msgs::msg::Paths & msg, size_t path_index, bool orientations)
+{
+    const auto & path_msg = msg.paths[path_index];
+    common::transformPathPositions(path_msg, Ogre::Matrix4::IDENTITY, path_positions_);
+    if (orientations) {
+        common::transformPathOrientations(path_msg, Ogre::Quaternion::IDENTITY, path_orientations_);
     }
 }
 
-void PathsDisplay::updateAxesMarkers(
-    std::vector<std::unique_ptr<rviz_rendering::Axes>> & axes_vect, nav_msgs::msg::Path& msg,
-    const Ogre::Matrix4 & transform)
+void PathsDisplay::readPathPoses(
+    const type_adapters::EigenPaths & msg, size_t path_index, bool orientations)
 {
-    auto num_points = msg.poses.size();
-    allocateAxesVector(axes_vect, num_points);
-    for (size_t i = 0; i < num_points; ++i) {
-        const geometry_msgs::msg::Point & pos = msg.poses[i].pose.position;
-        axes_vect[i]->setPosition(transform * rviz_common::pointMsgToOgre(pos));
-        Ogre::Quaternion orientation(rviz_common::quaternionMsgToOgre(msg.poses[i].pose.orientation));
+    const auto & path = msg.paths[path_index];
+    common::transformPathPositions(path, Ogre::Matrix4::IDENTITY, path_positions_);
+    if (orientations) {
+        common::transformPathOrientations(path, Ogre::Quaternion::IDENTITY, path_orientations_);
+    }
+}
 
-        // Extract the rotation part of the transformation matrix as a quaternion
-        Ogre::Quaternion transform_orientation = transform.linear();
+void PathsDisplay::readPathPoses(const RecordedPaths & msg, size_t path_index, bool orientations)
+{
+    const auto & path = msg.paths[path_index];
+    auto column = [&msg, &path](size_t index) {return msg.record.column(index) + path.begin;};
+    size_t n = path.end - path.begin;
 
-        axes_vect[i]->setOrientation(transform_orientation * orientation);
+    path_positions_.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        path_positions_[k] = Ogre::Vector3(column(0)[k], column(1)[k], column(2)[k]);
+    }
+    if (orientations) {
+        path_orientations_.resize(n);
+        for (size_t k = 0; k < n; k++) {
+            path_orientations_[k] = Ogre::Quaternion(column(6)[k], column(3)[k], column(4)[k], column(5)[k]);
+        }
     }
 }
 
-void PathsDisplay::updateArrowMarkers(
-    std::vector<std::unique_ptr<rviz_rendering::Arrow>> & arrow_vect, nav_msgs::msg::Path& msg,
-    const Ogre::Matrix4 & transform)
+void PathsDisplay::computePathScalars(const rviz_legged_msgs::msg::Paths & msg)
 {
-    auto num_points = msg.poses.size();
-    allocateArrowVector(arrow_vect, num_points);
-    for (size_t i = 0; i < num_points; ++i) {
-        QColor color = pose_arrow_color_property_->getColor();
-        arrow_vect[i]->setColor(color.redF(), color.greenF(), color.blueF(), 1.0F);
+    auto mode = style().color_mode;
+    path_scalars_.resize(mode == PathsPolicy::FLAT ? 0 : msg.paths.size());
+    path_scalar_range_ = common::ScalarRange();
+
+    for (size_t i = 0; i < path_scalars_.size(); i++) {
+        const auto & poses = msg.paths[i].poses;
+        scalar_positions_.resize(poses.size());
+        scalar_stamps_.resize(poses.size());
+        for (size_t k = 0; k < poses.size(); k++) {
+            scalar_positions_[k] = rviz_common::pointMsgToOgre(poses[k].pose.position);
+            scalar_stamps_[k] = rclcpp::Time(poses[k].header.stamp).seconds();
+        }
+        computePathScalars(mode, path_scalars_[i]);
+    }
+    finishPathScalars();
+}
 
-        arrow_vect[i]->set(
-        pose_arrow_shaft_length_property_->getFloat(),
-        pose_arrow_shaft_diameter_property_->getFloat(),
-        pose_arrow_head_length_property_->getFloat(),
-        pose_arrow_head_diameter_property_->getFloat());
-        const geometry_msgs::msg::Point & pos = msg.poses[i].pose.position;
-        arrow_vect[i]->setPosition(transform * rviz_common::pointMsgToOgre(pos));
-        Ogre::Quaternion orientation(rviz_common::quaternionMsgToOgre(msg.poses[i].pose.orientation));
+void PathsDisplay::computePathScalars(const type_adapters::EigenPaths & msg)
+{
+    auto mode = style().color_mode;
+    path_scalars_.resize(mode == PathsPolicy::FLAT ? 0 : msg.paths.size());
+    path_scalar_range_ = common::ScalarRange();
+
+    // The adapted paths carry no stamps: the time along the horizon is the pose index.
+    for (size_t i = 0; i < path_scalars_.size(); i++) {
+        const auto & path = msg.paths[i];
+        scalar_positions_.resize(static_cast<size_t>(path.cols()));
+        scalar_stamps_.assign(static_cast<size_t>(path.cols()), 0.0);
+        for (Eigen::Index k = 0; k < path.cols(); k++) {
+            scalar_positions_[static_cast<size_t>(k)] = Ogre::Vector3(
+                static_cast<float>(path(0, k)), static_cast<float>(path(1, k)),
+                static_cast<float>(path(2, k)));
+        }
+        computePathScalars(mode, path_scalars_[i]);
+    }
+    finishPathScalars();
+}
 
-        // Extract the rotation part of the transformation matrix as a quaternion
-        Ogre::Quaternion transform_orientation = transform.linear();
+void PathsDisplay::computePathScalars(const RecordedPaths & msg)
+{
+    auto mode = style().color_mode;
+    path_scalars_.resize(mode == PathsPolicy::FLAT ? 0 : msg.paths.size());
+    path_scalar_range_ = common::ScalarRange();
+
+    for (size_t i = 0; i < path_scalars_.size(); i++) {
+        const auto & path = msg.paths[i];
+        scalar_positions_.resize(path.end - path.begin);
+        scalar_stamps_.resize(path.end - path.begin);
+        for (size_t row = path.begin; row < path.end; row++) {
+            scalar_positions_[row - path.begin] = Ogre::Vector3(
+                msg.record.column(0)[row], msg.record.column(1)[row], msg.record.column(2)[row]);
+            scalar_stamps_[row - path.begin] = msg.record.column(7)[row];
+        }
+        computePathScalars(mode, path_scalars_[i]);
+    }
+    finishPathScalars();
+}
 
-        Ogre::Vector3 dir(1, 0, 0);
-        dir = transform_orientation * orientation * dir;
-        arrow_vect[i]->setDirection(dir);
+void PathsDisplay::computePathScalars(PathsPolicy::ColorMode mode, std::vector<float> & scalars)
+{
+    // Rigid transforms preserve distances, hence the scalars are computed in the message frame.
+    size_t n = scalar_positions_.size();
+    bool stamped = n >= 2 && scalar_stamps_[n - 1] > scalar_stamps_[0];
+
+    scalars.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        if (mode == PathsPolicy::TIME_ALONG_HORIZON) {
+            scalars[k] = stamped ?
+                static_cast<float>(scalar_stamps_[k] - scalar_stamps_[0]) : static_cast<float>(k);
+        } else if (n < 2) {
+            scalars[k] = 0.0F;
+        } else {
+            // Speed of the segment starting at the pose, or ending at it for the last pose.
+            size_t a = std::min(k, n - 2);
+            float distance = scalar_positions_[a].distance(scalar_positions_[a + 1]);
+            double dt = scalar_stamps_[a + 1] - scalar_stamps_[a];
+            scalars[k] = (stamped && dt > 0.0) ? static_cast<float>(distance / dt) : distance;
+        }
+        path_scalar_range_.include(scalars[k]);
+    }
+}
+
+void PathsDisplay::finishPathScalars()
+{
+    const auto & current_style = style();
+    if (!current_style.auto_range) {
+        path_scalar_range_.min = current_style.range_min;
+        path_scalar_range_.max = current_style.range_max;
+    }
+}
+
+void PathsDisplay::updatePathColors(size_t path_index)
+{
+    path_colors_.clear();
+    if (path_index >= path_scalars_.size()) {
+        return;
+    }
+
+    const auto & current_style = style();
+    for (float value : path_scalars_[path_index]) {
+        auto color = common::sampleColormap(current_style.colormap, path_scalar_range_.normalize(value));
+        color.a = current_style.color.a;
+        path_colors_.push_back(color);
+    }
+}
+
+void PathsDisplay::updateManualObject(Ogre::ManualObject * manual_object)
+{
+    RVIZ_LEGGED_TRACE_SCOPE("updateManualObject", "Paths");
+
+    const auto & color = style().color;
+
+    bool fading = isFading();
+    const auto & material_name = lineMaterialName();
+
+    // The section is updated in place, reusing its vertex buffer when it is large enough.
+    manual_object->estimateVertexCount(path_positions_.size());
+    if (manual_object->getNumSections() == 0) {
+        manual_object->begin(material_name, Ogre::RenderOperation::OT_LINE_STRIP, "rviz_rendering");
+    } else {
+        manual_object->getSection(0)->setMaterialName(material_name, "rviz_rendering");
+        manual_object->beginUpdate(0);
+    }
+
+    // An update only grows the bounds of the manual object, hence they are set from its poses.
+    Ogre::AxisAlignedBox bounds;
+    for (size_t k = 0; k < path_positions_.size(); k++) {
+        manual_object->position(path_positions_[k]);
+        manual_object->colour(path_colors_.empty() ? color : path_colors_[k]);
+        // Every section has the stamp, read by the fade material only, so that beginUpdate() keeps
+        // a vertex declaration fitting both materials.
+        manual_object->textureCoord(fading ? path_stamp_ : 0.0f);
+        bounds.merge(path_positions_[k]);
+    }
+
+    manual_object->end();
+    manual_object->setBoundingBox(bounds);
+}
+
+const std::string & PathsDisplay::lineMaterialName()
+{
+    bool transparent = common::MaterialCache::isTransparent(style().color.a);
+    if (isFading()) {
+        return fade_material_->getName();
+    }
+    if (isShadowing()) {
+        return terrain_shadow_material_->getName(transparent);
+    }
+    return (transparent ? *transparent_lines_material_ : *opaque_lines_material_)->getName();
+}
+
+void PathsDisplay::bindLineMaterials()
+{
+    // The fading lines keep the fade material, the only one reading their stamps.
+    if (isFading()) {
+        return;
+    }
+
+    const auto & material_name = lineMaterialName();
+    forEachSlotNewestFirst(
+        [&material_name](Slot & slot) {
+            for (auto & instance : slot.instances) {
+                if (instance->manual_object && instance->manual_object->getNumSections() > 0) {
+                    instance->manual_object->getSection(0)->setMaterialName(material_name, "rviz_rendering");
+                }
+            }
+            return true;
+        });
+    context_->queueRender();
+}
+
+void PathsDisplay::updateBillBoardLine(rviz_rendering::BillboardLine * billboard_line)
+{
+    RVIZ_LEGGED_TRACE_SCOPE("updateBillBoardLine", "Paths");
+
+    const auto & current_style = style();
+
+    billboard_line->clear();
+    billboard_line->setNumLines(1);
+    billboard_line->setMaxPointsPerLine(static_cast<uint32_t>(path_positions_.size()));
+    billboard_line->setLineWidth(current_style.line_width);
+
+    for (size_t k = 0; k < path_positions_.size(); k++) {
+        billboard_line->addPoint(
+            path_positions_[k], path_colors_.empty() ? current_style.color : path_colors_[k]);
+    }
+}
+
+void PathsDisplay::updatePoseMarkers(Instance & instance, PathsPolicy::PoseStyle pose_style)
+{
+    auto stride = style().pose_stride;
+    auto count = (path_positions_.size() + stride - 1) / stride;
+    bool arrows = pose_style == PathsPolicy::ARROWS;
+
+    if (!instance.markers) {
+        instance.markers = scene_manager_->createManualObject();
+        instance.markers->setDynamic(true);
+        instance.parent->attachObject(instance.markers);
+    }
+    auto * markers = instance.markers;
+    if (markers->getNumSections() == 0) {
+        markers->estimateVertexCount(
+            count * (arrows ? common::PoseMarkerMaterial::kArrowVertexCount :
+            common::PoseMarkerMaterial::kAxesVertexCount));
+        markers->begin(
+            pose_marker_material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST, "rviz_rendering");
+    } else {
+        markers->beginUpdate(0);
+    }
+
+    instance.marker_positions.setNull();
+    for (size_t i = 0; i < path_positions_.size(); i += stride) {
+        if (arrows) {
+            common::PoseMarkerMaterial::addArrow(*markers, path_positions_[i], path_orientations_[i]);
+        } else {
+            common::PoseMarkerMaterial::addAxes(*markers, path_positions_[i], path_orientations_[i]);
+        }
+        instance.marker_positions.merge(path_positions_[i]);
     }
+    markers->end();
+    setMarkerBounds(instance);
 }
 
 }  // namespace rviz_legged_plugins
 
 #include <pluginlib/class_list_macros.hpp>  // NOLINT
-PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::PathsDisplay, rviz_common::Display)
\ No newline at end of file
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::PathsDisplay, rviz_common::Display)
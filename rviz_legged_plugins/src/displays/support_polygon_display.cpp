@@ -0,0 +1,368 @@
+#include "rviz_legged_plugins/displays/support_polygon_display.hpp"
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreManualObject.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+
+#include "rviz_common/display_context.hpp"
+#include "rviz_common/frame_manager_iface.hpp"
+#include "rviz_common/properties/bool_property.hpp"
+#include "rviz_common/properties/color_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+#include "rviz_common/properties/int_property.hpp"
+#include "rviz_common/properties/ros_topic_property.hpp"
+#include "rviz_common/validate_floats.hpp"
+
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+
+SupportPolygonDisplay::SupportPolygonDisplay()
+: cones_filter_([this](rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg) {
+        processCones(msg);
+    })
+{
+    force_threshold_property_ = new rviz_common::properties::FloatProperty(
+        "Force Threshold", 5.0f,
+        "Minimum norm of the contact force, in N, for the contact to be active.",
+        this);
+    force_threshold_property_->setMin(0);
+
+    cones_topic_property_ = new rviz_common::properties::RosTopicProperty(
+        "Friction Cones Topic", "",
+        QString::fromStdString(rosidl_generator_traits::name<rviz_legged_msgs::msg::FrictionCones>()),
+        "When set, the active contacts are the apexes of the friction cones instead of the wrenches.",
+        this, SLOT(updateConesTopic()));
+
+    tolerance_property_ = new rviz_common::properties::FloatProperty(
+        "Position Tolerance", 0.001f,
+        "Displacement, in m, below which a contact is considered still.",
+        this, SLOT(updateTolerance()));
+    tolerance_property_->setMin(0);
+
+    color_property_ = new rviz_common::properties::ColorProperty(
+        "Color", QColor(255, 170, 0),
+        "Color to draw the support polygon.",
+        this, SLOT(updateManualObject()));
+
+    alpha_property_ = new rviz_common::properties::FloatProperty(
+        "Alpha", 1.0f,
+        "0 is fully transparent, 1.0 is fully opaque.",
+        this, SLOT(updateManualObject()));
+    alpha_property_->setMin(0);
+    alpha_property_->setMax(1);
+
+    fill_property_ = new rviz_common::properties::BoolProperty(
+        "Fill", true,
+        "Fill the current support polygon.",
+        this, SLOT(updateManualObject()));
+
+    history_length_property_ = new rviz_common::properties::IntProperty(
+        "History Length", 1,
+        "Number of support polygons to display, the older ones being more transparent.",
+        this, SLOT(updateHistoryLength()));
+    history_length_property_->setMin(1);
+    history_length_property_->setMax(1000);
+
+    fade_duration_property_ = new rviz_common::properties::FloatProperty(
+        "Fade Duration", 0.0f,
+        "Age, in s, at which the previous support polygons become fully transparent. When 0, their "
+        "transparency depends on their rank in the history instead.",
+        this, SLOT(updateFadeDuration()));
+    fade_duration_property_->setMin(0);
+}
+
+SupportPolygonDisplay::~SupportPolygonDisplay()
+{
+    if (manual_object_) {
+        scene_manager_->destroyManualObject(manual_object_);
+    }
+}
+
+void SupportPolygonDisplay::onInitialize()
+{
+    MFDClass::onInitialize();
+    cones_topic_property_->initialize(rviz_ros_node_);
+
+    manual_object_ = scene_manager_->createManualObject();
+    manual_object_->setDynamic(true);
+    scene_node_->attachObject(manual_object_);
+
+    // The outlines (section 0) and the fill (section 1) are created once, with a placeholder
+    // vertex, then updated in place, keeping their vertex buffers. The fill, drawn at half the
+    // alpha, is always transparent.
+    fill_material_ = common::MaterialCache::instance().vertexColorMaterial(true, true);
+    for (auto operation : {Ogre::RenderOperation::OT_LINE_LIST, Ogre::RenderOperation::OT_TRIANGLE_LIST}) {
+        manual_object_->begin((*fill_material_)->getName(), operation, "rviz_rendering");
+        manual_object_->position(Ogre::Vector3::ZERO);
+        manual_object_->colour(Ogre::ColourValue::White);
+        manual_object_->textureCoord(0.0f);
+        manual_object_->end();
+    }
+
+    updateTolerance();
+    updateManualObject();
+}
+
+void SupportPolygonDisplay::reset()
+{
+    MFDClass::reset();
+    hull_.clear();
+    history_.clear();
+    updateManualObject();
+}
+
+void SupportPolygonDisplay::update(float wall_dt, float ros_dt)
+{
+    MFDClass::update(wall_dt, ros_dt);
+
+    if (isFading()) {
+        fade_material_->setNow(context_->getClock()->now());
+    }
+}
+
+void SupportPolygonDisplay::updateFadeDuration()
+{
+    if (fade_duration_property_->getFloat() > 0.0f && !fade_material_) {
+        fade_material_ = std::make_unique<common::AgeFadeMaterial>();
+    }
+    if (fade_material_) {
+        fade_material_->setFadeDuration(fade_duration_property_->getFloat());
+    }
+    updateManualObject();
+}
+
+bool SupportPolygonDisplay::isFading() const
+{
+    return fade_material_ && fade_duration_property_->getFloat() > 0.0f;
+}
+
+void SupportPolygonDisplay::subscribe()
+{
+    MFDClass::subscribe();
+    subscribeCones();
+}
+
+void SupportPolygonDisplay::unsubscribe()
+{
+    MFDClass::unsubscribe();
+    cones_subscription_.reset();
+    cones_filter_.clear();
+}
+
+void SupportPolygonDisplay::fixedFrameChanged()
+{
+    cones_filter_.setTargetFrame(fixed_frame_.toStdString());
+    MFDClass::fixedFrameChanged();
+}
+
+void SupportPolygonDisplay::subscribeCones()
+{
+    if (!isEnabled() || cones_topic_property_->isEmpty()) {
+        deleteStatus("Friction Cones Topic");
+        return;
+    }
+
+    // Like the wrenches, the cones wait for the transform at their stamp.
+    cones_filter_.reset(
+        *context_->getFrameManager()->getTransformer(), fixed_frame_.toStdString(),
+        static_cast<uint32_t>(message_queue_property_->getInt()), rviz_ros_node_.lock()->get_raw_node());
+    try {
+        cones_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<rviz_legged_msgs::msg::FrictionCones>(
+                cones_topic_property_->getTopicStd(), qos_profile,
+                [this](rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg) {
+                    cones_filter_.add(msg);
+                });
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Friction Cones Topic", "OK");
+    } catch (const rclcpp::exceptions::InvalidTopicNameError & e) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Friction Cones Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
+
+void SupportPolygonDisplay::updateConesTopic()
+{
+    cones_subscription_.reset();
+    cones_filter_.clear();
+    subscribeCones();
+    context_->queueRender();
+}
+
+void SupportPolygonDisplay::updateTolerance()
+{
+    hull_.setTolerance(tolerance_property_->getFloat());
+}
+
+void SupportPolygonDisplay::updateHistoryLength()
+{
+    while (history_.size() > static_cast<size_t>(history_length_property_->getInt())) {
+        history_.pop_front();
+    }
+    updateManualObject();
+}
+
+void SupportPolygonDisplay::processMessage(rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg)
+{
+    RVIZ_LEGGED_TRACE_SCOPE("processMessage", "SupportPolygon");
+
+    // The friction cones, when subscribed, define the contacts.
+    if (cones_subscription_) {
+        return;
+    }
+
+    float force_threshold = force_threshold_property_->getFloat();
+
+    contact_ids_.clear();
+    contact_positions_.clear();
+    for (const auto & wrench_stamped : msg->wrenches_stamped) {
+        const auto & force = wrench_stamped.wrench.force;
+        if (!rviz_common::validateFloats(force) ||
+            force.x * force.x + force.y * force.y + force.z * force.z <
+            force_threshold * force_threshold)
+        {
+            continue;
+        }
+
+        Ogre::Vector3 position;
+        Ogre::Quaternion orientation;
+        if (!context_->getFrameManager()->getTransform(
+            wrench_stamped.header.frame_id, wrench_stamped.header.stamp, position, orientation))
+        {
+            setMissingTransformToFixedFrame(wrench_stamped.header.frame_id);
+            return;
+        }
+
+        contact_ids_.push_back(wrench_stamped.header.frame_id);
+        contact_positions_.push_back(position);
+    }
+    setTransformOk();
+
+    updateContacts(msg->header.stamp);
+}
+
+void SupportPolygonDisplay::processCones(rviz_legged_msgs::msg::FrictionCones::ConstSharedPtr msg)
+{
+    RVIZ_LEGGED_TRACE_SCOPE("processCones", "SupportPolygon");
+
+    contact_ids_.clear();
+    contact_positions_.clear();
+    for (const auto & cone : msg->friction_cones) {
+        Ogre::Vector3 position;
+        Ogre::Quaternion orientation;
+        if (!context_->getFrameManager()->getTransform(
+            cone.header.frame_id, cone.header.stamp, position, orientation))
+        {
+            setMissingTransformToFixedFrame(cone.header.frame_id);
+            return;
+        }
+
+        contact_ids_.push_back(cone.header.frame_id);
+        contact_positions_.push_back(position);
+    }
+    setTransformOk();
+
+    updateContacts(msg->header.stamp);
+}
+
+void SupportPolygonDisplay::updateContacts(const rclcpp::Time & stamp)
+{
+    // Nothing is redrawn while the contacts are still.
+    if (!hull_.setContacts(contact_ids_, contact_positions_)) {
+        return;
+    }
+
+    if (history_.size() >= static_cast<size_t>(history_length_property_->getInt())) {
+        history_.pop_front();
+    }
+    history_.push_back({hull_.vertices(), stamp});
+
+    updateManualObject();
+}
+
+void SupportPolygonDisplay::updateManualObject()
+{
+    RVIZ_LEGGED_TRACE_SCOPE("updateManualObject", "SupportPolygon");
+
+    if (!manual_object_) {
+        return;
+    }
+
+    auto color = color_property_->getOgreColor();
+    float alpha = alpha_property_->getFloat();
+    bool fading = isFading();
+    // Unless fading, the previous outlines are drawn more transparent than the current one.
+    material_ = common::MaterialCache::instance().vertexColorMaterial(
+        common::MaterialCache::isTransparent(alpha) || (!fading && history_.size() > 1), true);
+
+    size_t n_edges = 0;
+    for (const auto & polygon : history_) {
+        n_edges += (polygon.vertices.size() >= 2) ? polygon.vertices.size() : 0;
+    }
+
+    // An update only grows the bounds of the manual object, hence they are set from the vertices.
+    Ogre::AxisAlignedBox bounds;
+
+    // Outlines of the current and of the previous support polygons. When fading, the alpha of each
+    // outline is computed on the GPU from its stamp.
+    manual_object_->getSection(0)->setMaterialName(
+        fading ? fade_material_->getName() : (*material_)->getName(), "rviz_rendering");
+    manual_object_->estimateVertexCount(2 * n_edges);
+    manual_object_->beginUpdate(0);
+    for (size_t h = 0; h < history_.size(); h++) {
+        const auto & polygon = history_[h].vertices;
+        if (polygon.size() < 2) {
+            continue;
+        }
+
+        float stamp = 0.0f;
+        if (fading) {
+            color.a = alpha;
+            stamp = fade_material_->toShaderTime(history_[h].stamp);
+        } else {
+            color.a = alpha * static_cast<float>(h + 1) / static_cast<float>(history_.size());
+        }
+        for (size_t i = 0; i < polygon.size(); i++) {
+            manual_object_->position(polygon[i]);
+            manual_object_->colour(color);
+            manual_object_->textureCoord(stamp);
+            manual_object_->position(polygon[(i + 1) % polygon.size()]);
+            manual_object_->colour(color);
+            manual_object_->textureCoord(stamp);
+            bounds.merge(polygon[i]);
+        }
+    }
+    manual_object_->end();
+
+    // Fill of the current support polygon, as a triangle fan.
+    manual_object_->beginUpdate(1);
+    if (fill_property_->getBool() && !history_.empty() && history_.back().vertices.size() >= 3) {
+        const auto & polygon = history_.back().vertices;
+        color.a = 0.5f * alpha;
+
+        for (size_t i = 1; i + 1 < polygon.size(); i++) {
+            for (size_t k : {size_t{0}, i, i + 1}) {
+                manual_object_->position(polygon[k]);
+                manual_object_->colour(color);
+                manual_object_->textureCoord(0.0f);
+            }
+        }
+    }
+    manual_object_->end();
+    manual_object_->setBoundingBox(bounds);
+
+    context_->queueRender();
+}
+
+}  // namespace rviz_legged_plugins::displays
+
+#include <pluginlib/class_list_macros.hpp>  // NOLINT
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::SupportPolygonDisplay, rviz_common::Display)
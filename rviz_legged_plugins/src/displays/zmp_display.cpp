@@ -0,0 +1,241 @@
+#include "rviz_legged_plugins/displays/zmp_display.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "rviz_common/display_context.hpp"
+#include "rviz_common/frame_manager_iface.hpp"
+#include "rviz_common/properties/color_property.hpp"
+#include "rviz_common/properties/float_property.hpp"
+#include "rviz_common/properties/ros_topic_property.hpp"
+#include "rviz_common/properties/tf_frame_property.hpp"
+#include "rviz_rendering/objects/shape.hpp"
+
+#include "rviz_legged_plugins/common/trace_recorder.hpp"
+
+namespace rviz_legged_plugins::displays
+{
+
+ZmpDisplay::ZmpDisplay()
+{
+    com_frame_property_ = new rviz_common::properties::TfFrameProperty(
+        "CoM Frame", "base_link",
+        "Frame whose origin is the center of mass of the robot.",
+        this, nullptr, false);
+
+    terrain_topic_property_ = new rviz_common::properties::RosTopicProperty(
+        "Terrain Topic", "/state_estimator/terrain",
+        QString::fromStdString(rosidl_generator_traits::name<std_msgs::msg::Float64MultiArray>()),
+        "Coefficients [a, b, c] of the terrain plane z = a x + b y + c.",
+        this, SLOT(updateTerrainTopic()));
+
+    terrain_frame_property_ = new rviz_common::properties::TfFrameProperty(
+        "Terrain Frame", rviz_common::properties::TfFrameProperty::FIXED_FRAME_STRING,
+        "Frame in which the terrain plane is expressed.",
+        this, nullptr, true);
+
+    zmp_color_property_ = new rviz_common::properties::ColorProperty(
+        "ZMP Color", QColor(255, 25, 0),
+        "Color to draw the zero moment point.",
+        this, SLOT(updateShapes()));
+
+    com_color_property_ = new rviz_common::properties::ColorProperty(
+        "CoM Color", QColor(25, 0, 255),
+        "Color to draw the projection of the center of mass.",
+        this, SLOT(updateShapes()));
+
+    alpha_property_ = new rviz_common::properties::FloatProperty(
+        "Alpha", 1.0f,
+        "0 is fully transparent, 1.0 is fully opaque.",
+        this, SLOT(updateShapes()));
+    alpha_property_->setMin(0);
+    alpha_property_->setMax(1);
+
+    radius_property_ = new rviz_common::properties::FloatProperty(
+        "Radius", 0.03f,
+        "Radius of the spheres.",
+        this, SLOT(updateShapes()));
+    radius_property_->setMin(0);
+}
+
+ZmpDisplay::~ZmpDisplay() = default;
+
+void ZmpDisplay::onInitialize()
+{
+    MFDClass::onInitialize();
+
+    com_frame_property_->setFrameManager(context_->getFrameManager());
+    terrain_frame_property_->setFrameManager(context_->getFrameManager());
+    terrain_topic_property_->initialize(rviz_ros_node_);
+
+    zmp_shape_ = std::make_unique<rviz_rendering::Shape>(
+        rviz_rendering::Shape::Sphere, scene_manager_, scene_node_);
+    com_shape_ = std::make_unique<rviz_rendering::Shape>(
+        rviz_rendering::Shape::Sphere, scene_manager_, scene_node_);
+
+    updateShapes();
+    reset();
+}
+
+void ZmpDisplay::reset()
+{
+    MFDClass::reset();
+
+    if (zmp_shape_) {
+        zmp_shape_->getRootNode()->setVisible(false);
+        com_shape_->getRootNode()->setVisible(false);
+    }
+}
+
+void ZmpDisplay::subscribe()
+{
+    MFDClass::subscribe();
+    subscribeTerrain();
+}
+
+void ZmpDisplay::unsubscribe()
+{
+    MFDClass::unsubscribe();
+    terrain_subscription_.reset();
+}
+
+void ZmpDisplay::subscribeTerrain()
+{
+    if (!isEnabled() || terrain_topic_property_->isEmpty()) {
+        deleteStatus("Terrain Topic");
+        return;
+    }
+
+    try {
+        terrain_subscription_ = rviz_ros_node_.lock()->get_raw_node()->
+            create_subscription<std_msgs::msg::Float64MultiArray>(
+                terrain_topic_property_->getTopicStd(), qos_profile,
+                [this](std_msgs::msg::Float64MultiArray::ConstSharedPtr msg) {
+                    processTerrain(msg);
+                });
+        setStatus(rviz_common::properties::StatusProperty::Ok, "Terrain Topic", "OK");
+    } catch (const rclcpp::exceptions::InvalidTopicNameError & e) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Terrain Topic",
+            QString("Error subscribing: ") + e.what());
+    }
+}
+
+void ZmpDisplay::updateTerrainTopic()
+{
+    terrain_subscription_.reset();
+    terrain_plane_ = common::TerrainPlane();
+    subscribeTerrain();
+    context_->queueRender();
+}
+
+void ZmpDisplay::processTerrain(std_msgs::msg::Float64MultiArray::ConstSharedPtr msg)
+{
+    if (msg->data.size() != 3) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Terrain Topic",
+            "The terrain message must contain the three coefficients of the plane");
+        return;
+    }
+    if (!std::isfinite(msg->data[0]) || !std::isfinite(msg->data[1]) || !std::isfinite(msg->data[2])) {
+        setStatus(
+            rviz_common::properties::StatusProperty::Error, "Terrain Topic",
+            "Message contained invalid floating point values (nans or infs)");
+        return;
+    }
+
+    terrain_plane_ = common::TerrainPlane::fromCoefficients(msg->data[0], msg->data[1], msg->data[2]);
+    setStatus(rviz_common::properties::StatusProperty::Ok, "Terrain Topic", "OK");
+}
+
+void ZmpDisplay::updateShapes()
+{
+    if (!zmp_shape_) {
+        return;
+    }
+
+    float alpha = alpha_property_->getFloat();
+    auto zmp_color = zmp_color_property_->getOgreColor();
+    auto com_color = com_color_property_->getOgreColor();
+    Ogre::Vector3 scale(2 * radius_property_->getFloat());
+
+    zmp_shape_->setColor(zmp_color.r, zmp_color.g, zmp_color.b, alpha);
+    zmp_shape_->setScale(scale);
+    com_shape_->setColor(com_color.r, com_color.g, com_color.b, alpha);
+    com_shape_->setScale(scale);
+
+    context_->queueRender();
+}
+
+void ZmpDisplay::processMessage(rviz_legged_msgs::msg::WrenchesStamped::ConstSharedPtr msg)
+{
+    RVIZ_LEGGED_TRACE_SCOPE("processMessage", "Zmp");
+
+    auto * frame_manager = context_->getFrameManager();
+
+    contact_positions_.clear();
+    contact_wrenches_.clear();
+    for (const auto & wrench_stamped : msg->wrenches_stamped) {
+        common::WrenchSample sample;
+        if (!common::wrenchToSample(wrench_stamped.wrench, false, sample)) {
+            setStatus(
+                rviz_common::properties::StatusProperty::Error, "Topic",
+                "Message contained invalid floating point values (nans or infs)");
+            return;
+        }
+
+        Ogre::Vector3 position;
+        Ogre::Quaternion orientation;
+        if (!frame_manager->getTransform(
+            wrench_stamped.header.frame_id, wrench_stamped.header.stamp, position, orientation))
+        {
+            setMissingTransformToFixedFrame(wrench_stamped.header.frame_id);
+            return;
+        }
+
+        contact_positions_.push_back(position);
+        contact_wrenches_.push_back(sample);
+    }
+
+    Ogre::Vector3 com_position;
+    Ogre::Quaternion com_orientation;
+    std::string com_frame = com_frame_property_->getFrameStd();
+    if (!frame_manager->getTransform(com_frame, msg->header.stamp, com_position, com_orientation)) {
+        setMissingTransformToFixedFrame(com_frame, "CoM Frame");
+        return;
+    }
+
+    Ogre::Vector3 terrain_position;
+    Ogre::Quaternion terrain_orientation;
+    std::string terrain_frame = terrain_frame_property_->getFrameStd();
+    if (!frame_manager->getTransform(
+        terrain_frame, msg->header.stamp, terrain_position, terrain_orientation))
+    {
+        setMissingTransformToFixedFrame(terrain_frame, "Terrain Frame");
+        return;
+    }
+    setTransformOk();
+
+    auto terrain = terrain_plane_.transformed(terrain_position, terrain_orientation);
+    Ogre::Vector3 projected_com = terrain.project(com_position);
+
+    com_shape_->setPosition(projected_com);
+    com_shape_->getRootNode()->setVisible(true);
+
+    // Without contact forces, e.g. during a flight phase, the ZMP is not defined.
+    Ogre::Vector3 zmp;
+    bool has_zmp = common::computeZmp(
+        contact_positions_, contact_wrenches_, projected_com, terrain.normal, zmp);
+    if (has_zmp) {
+        zmp_shape_->setPosition(zmp);
+    }
+    zmp_shape_->getRootNode()->setVisible(has_zmp);
+
+    context_->queueRender();
+}
+
+}  // namespace rviz_legged_plugins::displays
+
+#include <pluginlib/class_list_macros.hpp>  // NOLINT
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::displays::ZmpDisplay, rviz_common::Display)
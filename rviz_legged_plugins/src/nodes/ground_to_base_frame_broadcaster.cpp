@@ -0,0 +1,129 @@
+/*
+ * Composable counterpart of ground_to_base_frame_broadcaster_node.py.
+ *
+ * For every entity of /gazebo/link_states (except the ignored ones), the pose of its first link is
+ * broadcast as the transform from the world frame to that link. All the transforms of a message are
+ * published in a single TFMessage, optionally rate limited.
+ *
+ * Parameters:
+ *   world_frame (string, "ground_plane_link"): parent frame of the transforms.
+ *   ignored_entities (string[], ["ground_plane"]): entities whose links are not broadcast.
+ *   max_rate (double, 0.0): maximum publishing rate in Hz, 0 for no limit.
+ */
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gazebo_msgs/msg/link_states.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_components/register_node_macro.hpp"
+#include "tf2_ros/transform_broadcaster.h"
+
+namespace rviz_legged_plugins::nodes
+{
+
+class GroundToBaseFrameBroadcaster : public rclcpp::Node
+{
+public:
+    explicit GroundToBaseFrameBroadcaster(const rclcpp::NodeOptions & options)
+    : rclcpp::Node("ground_to_base_frame_broadcaster", options)
+    {
+        world_frame_ = declare_parameter<std::string>("world_frame", "ground_plane_link");
+
+        auto ignored_entities = declare_parameter<std::vector<std::string>>(
+            "ignored_entities", std::vector<std::string>{"ground_plane"});
+        ignored_entities_.insert(ignored_entities.begin(), ignored_entities.end());
+
+        double max_rate = declare_parameter<double>("max_rate", 0.0);
+        if (max_rate > 0.0) {
+            min_period_ = rclcpp::Duration::from_seconds(1.0 / max_rate);
+        }
+
+        tf_broadcaster_ = std::make_unique<tf2_ros::TransformBroadcaster>(*this);
+
+        subscription_ = create_subscription<gazebo_msgs::msg::LinkStates>(
+            "/gazebo/link_states", 1,
+            [this](gazebo_msgs::msg::LinkStates::ConstSharedPtr msg) {handleLinkStates(*msg);});
+    }
+
+private:
+    void handleLinkStates(const gazebo_msgs::msg::LinkStates & msg)
+    {
+        auto now = this->now();
+        if (last_publish_time_ && now - *last_publish_time_ < min_period_) {
+            return;
+        }
+
+        // The links of Gazebo are listed in the same order in every message: the names are parsed
+        // again only when they change, e.g. when an entity is spawned. Every name is compared, a
+        // string comparison being far cheaper than parsing it again.
+        if (msg.name != cached_names_) {
+            updateCache(msg.name);
+        }
+
+        for (size_t i = 0; i < link_indices_.size(); i++) {
+            const auto & pose = msg.pose[link_indices_[i]];
+            auto & transform = transforms_[i];
+
+            transform.header.stamp = now;
+            transform.transform.translation.x = pose.position.x;
+            transform.transform.translation.y = pose.position.y;
+            transform.transform.translation.z = pose.position.z;
+            transform.transform.rotation = pose.orientation;
+        }
+
+        if (!transforms_.empty()) {
+            tf_broadcaster_->sendTransform(transforms_);
+            last_publish_time_ = now;
+        }
+    }
+
+    void updateCache(const std::vector<std::string> & names)
+    {
+        cached_names_ = names;
+        link_indices_.clear();
+        transforms_.clear();
+
+        std::unordered_set<std::string> entities(ignored_entities_);
+        for (size_t i = 0; i < names.size(); i++) {
+            auto separator = names[i].find("::");
+            if (separator == std::string::npos) {
+                continue;
+            }
+
+            // Only the first link of each entity is broadcast.
+            if (!entities.insert(names[i].substr(0, separator)).second) {
+                continue;
+            }
+
+            auto link_end = names[i].find("::", separator + 2);
+            geometry_msgs::msg::TransformStamped transform;
+            transform.header.frame_id = world_frame_;
+            transform.child_frame_id = names[i].substr(separator + 2, link_end - separator - 2);
+
+            link_indices_.push_back(i);
+            transforms_.push_back(transform);
+        }
+    }
+
+    std::string world_frame_;
+    std::unordered_set<std::string> ignored_entities_;
+    rclcpp::Duration min_period_{0, 0};
+    std::optional<rclcpp::Time> last_publish_time_;
+
+    // Link names of the last parsed message, indices of the broadcast links and their transforms.
+    std::vector<std::string> cached_names_;
+    std::vector<size_t> link_indices_;
+    std::vector<geometry_msgs::msg::TransformStamped> transforms_;
+
+    std::unique_ptr<tf2_ros::TransformBroadcaster> tf_broadcaster_;
+    rclcpp::Subscription<gazebo_msgs::msg::LinkStates>::SharedPtr subscription_;
+};
+
+}  // namespace rviz_legged_plugins::nodes
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rviz_legged_plugins::nodes::GroundToBaseFrameBroadcaster)
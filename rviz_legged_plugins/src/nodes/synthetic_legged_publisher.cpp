@@ -0,0 +1,317 @@
+/*
+ * Synthetic source of legged messages for load testing the displays without a robot or Gazebo.
+ *
+ * For every robot namespace, the node publishes at a fixed rate the Paths, WrenchesStamped and
+ * FrictionCones of a robot walking in a circle, and the TF of its base and feet. The motion is a
+ * function of the tick count only and the injected NaN values are drawn from a seeded generator:
+ * two runs with the same parameters publish the same content.
+ *
+ * Parameters:
+ *   namespaces (string[], [""]): robots, each publishing <ns>/paths, <ns>/contact_wrenches and
+ *       <ns>/friction_cones, with frames <ns>/base_link and <ns>/foot_<i>.
+ *   world_frame (string, "world"): parent frame of the bases.
+ *   rate (double, 100.0): publishing rate in Hz of every topic.
+ *   contacts (int, 4): number of feet, hence of wrenches, cones and paths per message.
+ *   path_length (int, 20): number of poses of every path.
+ *   nan_probability (double, 0.0): probability for a message to carry a NaN value.
+ *   seed (int, 0): seed of the NaN injection.
+ *   stamp_log (string, ""): CSV file recording every publication, empty for none.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_components/register_node_macro.hpp"
+#include "tf2_ros/transform_broadcaster.h"
+
+#include "rviz_legged_msgs/msg/friction_cones.hpp"
+#include "rviz_legged_msgs/msg/paths.hpp"
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+namespace rviz_legged_plugins::nodes
+{
+
+namespace
+{
+
+// Radius of the circle walked by the bases, and its period in ticks.
+constexpr double kWalkRadius = 2.0;
+constexpr double kWalkPeriod = 2000.0;
+// Distance of the feet from the base, and duration of the paths.
+constexpr double kFootDistance = 0.3;
+constexpr double kPathHorizon = 1.0;
+
+}  // namespace
+
+class SyntheticLeggedPublisher : public rclcpp::Node
+{
+public:
+    explicit SyntheticLeggedPublisher(const rclcpp::NodeOptions & options)
+    : rclcpp::Node("synthetic_legged_publisher", options)
+    {
+        auto namespaces = declare_parameter<std::vector<std::string>>(
+            "namespaces", std::vector<std::string>{""});
+        world_frame_ = declare_parameter<std::string>("world_frame", "world");
+        double rate = declare_parameter<double>("rate", 100.0);
+        contacts_ = static_cast<size_t>(
+            std::max<int64_t>(declare_parameter<int64_t>("contacts", 4), 0));
+        path_length_ = static_cast<size_t>(
+            std::max<int64_t>(declare_parameter<int64_t>("path_length", 20), 1));
+        nan_probability_ = declare_parameter<double>("nan_probability", 0.0);
+        random_engine_.seed(
+            static_cast<std::mt19937::result_type>(declare_parameter<int64_t>("seed", 0)));
+        auto stamp_log = declare_parameter<std::string>("stamp_log", "");
+
+        if (!stamp_log.empty()) {
+            stamp_log_ = std::fopen(stamp_log.c_str(), "w");
+            if (stamp_log_) {
+                std::fprintf(stamp_log_, "robot,topic,sequence,stamp_ns,publish_ns\n");
+            } else {
+                RCLCPP_ERROR(get_logger(), "Cannot open the stamp log %s", stamp_log.c_str());
+            }
+        }
+
+        tf_broadcaster_ = std::make_unique<tf2_ros::TransformBroadcaster>(*this);
+
+        for (size_t i = 0; i < namespaces.size(); i++) {
+            robots_.push_back(makeRobot(namespaces[i], i, namespaces.size()));
+        }
+
+        timer_ = create_wall_timer(
+            std::chrono::duration<double>(1.0 / std::max(rate, 1e-3)), [this]() {publish();});
+    }
+
+    ~SyntheticLeggedPublisher() override
+    {
+        if (stamp_log_) {
+            std::fclose(stamp_log_);
+        }
+        RCLCPP_INFO(
+            get_logger(), "Published %zu ticks, %zu of them with a NaN value", tick_, nan_messages_);
+    }
+
+private:
+    // Messages of a robot, allocated once and updated in place at every tick.
+    struct Robot
+    {
+        std::string name;
+        double phase;
+        rclcpp::Publisher<rviz_legged_msgs::msg::Paths>::SharedPtr paths_publisher;
+        rclcpp::Publisher<rviz_legged_msgs::msg::WrenchesStamped>::SharedPtr wrenches_publisher;
+        rclcpp::Publisher<rviz_legged_msgs::msg::FrictionCones>::SharedPtr cones_publisher;
+        rviz_legged_msgs::msg::Paths paths;
+        rviz_legged_msgs::msg::WrenchesStamped wrenches;
+        rviz_legged_msgs::msg::FrictionCones cones;
+        // The transform of the base, then those of the feet.
+        std::vector<geometry_msgs::msg::TransformStamped> transforms;
+    };
+
+    enum Topic
+    {
+        PATHS,
+        WRENCHES,
+        CONES,
+    };
+
+    Robot makeRobot(const std::string & name, size_t index, size_t count)
+    {
+        Robot robot;
+        robot.name = name;
+        robot.phase = 2.0 * M_PI * static_cast<double>(index) / static_cast<double>(count);
+
+        auto prefix = name.empty() ? std::string() : name + "/";
+        robot.paths_publisher = create_publisher<rviz_legged_msgs::msg::Paths>(prefix + "paths", 10);
+        robot.wrenches_publisher = create_publisher<rviz_legged_msgs::msg::WrenchesStamped>(
+            prefix + "contact_wrenches", 10);
+        robot.cones_publisher = create_publisher<rviz_legged_msgs::msg::FrictionCones>(
+            prefix + "friction_cones", 10);
+
+        auto base_frame = prefix + "base_link";
+        robot.paths.header.frame_id = base_frame;
+        robot.wrenches.header.frame_id = base_frame;
+        robot.cones.header.frame_id = base_frame;
+
+        geometry_msgs::msg::TransformStamped base_transform;
+        base_transform.header.frame_id = world_frame_;
+        base_transform.child_frame_id = base_frame;
+        robot.transforms.push_back(base_transform);
+
+        robot.paths.paths.resize(contacts_);
+        robot.wrenches.wrenches_stamped.resize(contacts_);
+        robot.cones.friction_cones.resize(contacts_);
+        for (size_t i = 0; i < contacts_; i++) {
+            auto foot_frame = prefix + "foot_" + std::to_string(i);
+
+            auto & path = robot.paths.paths[i];
+            path.header.frame_id = base_frame;
+            path.poses.resize(path_length_);
+            for (auto & pose : path.poses) {
+                pose.header.frame_id = base_frame;
+            }
+
+            robot.wrenches.wrenches_stamped[i].header.frame_id = foot_frame;
+
+            auto & cone = robot.cones.friction_cones[i];
+            cone.header.frame_id = foot_frame;
+            cone.normal_direction.z = 1.0;
+            cone.friction_coefficient = 0.6;
+
+            geometry_msgs::msg::TransformStamped foot_transform;
+            foot_transform.header.frame_id = base_frame;
+            foot_transform.child_frame_id = foot_frame;
+            foot_transform.transform.rotation.w = 1.0;
+            robot.transforms.push_back(foot_transform);
+        }
+
+        return robot;
+    }
+
+    void publish()
+    {
+        auto now = this->now();
+        transforms_.clear();
+
+        for (size_t r = 0; r < robots_.size(); r++) {
+            auto & robot = robots_[r];
+            updateRobot(robot, now);
+            transforms_.insert(transforms_.end(), robot.transforms.begin(), robot.transforms.end());
+
+            robot.paths_publisher->publish(robot.paths);
+            logStamp(r, PATHS, now);
+            robot.wrenches_publisher->publish(robot.wrenches);
+            logStamp(r, WRENCHES, now);
+            robot.cones_publisher->publish(robot.cones);
+            logStamp(r, CONES, now);
+        }
+
+        // The transforms are sent after the messages, so that the displays waiting for the transform
+        // of a message are loaded too.
+        tf_broadcaster_->sendTransform(transforms_);
+        tick_++;
+    }
+
+    void updateRobot(Robot & robot, const rclcpp::Time & now)
+    {
+        double angle = robot.phase + 2.0 * M_PI * static_cast<double>(tick_) / kWalkPeriod;
+
+        auto & base = robot.transforms[0];
+        base.header.stamp = now;
+        base.transform.translation.x = kWalkRadius * std::cos(angle);
+        base.transform.translation.y = kWalkRadius * std::sin(angle);
+        base.transform.translation.z = 0.5;
+        // Heading along the circle.
+        base.transform.rotation.z = std::sin(0.5 * (angle + M_PI_2));
+        base.transform.rotation.w = std::cos(0.5 * (angle + M_PI_2));
+
+        robot.paths.header.stamp = now;
+        robot.wrenches.header.stamp = now;
+        robot.cones.header.stamp = now;
+
+        for (size_t i = 0; i < contacts_; i++) {
+            // The feet around the base, in a trot: half of them in stance at a time.
+            double foot_angle =
+                2.0 * M_PI * (static_cast<double>(i) + 0.5) / static_cast<double>(contacts_);
+            double gait = angle * 20.0 + M_PI * static_cast<double>(i % 2);
+            double lift = std::max(0.0, std::sin(gait));
+            double stance = 1.0 - lift;
+
+            auto & foot = robot.transforms[i + 1];
+            foot.header.stamp = now;
+            foot.transform.translation.x = kFootDistance * std::cos(foot_angle);
+            foot.transform.translation.y = kFootDistance * std::sin(foot_angle);
+            foot.transform.translation.z = -0.5 + 0.1 * lift;
+
+            auto & path = robot.paths.paths[i];
+            path.header.stamp = now;
+            for (size_t k = 0; k < path_length_; k++) {
+                double t = kPathHorizon * static_cast<double>(k) / static_cast<double>(path_length_);
+                auto & pose = path.poses[k].pose;
+                path.poses[k].header.stamp = now + rclcpp::Duration::from_seconds(t);
+                pose.position.x = foot.transform.translation.x + 0.3 * t;
+                pose.position.y = foot.transform.translation.y;
+                pose.position.z = -0.5 + 0.1 * std::max(0.0, std::sin(gait + 2.0 * M_PI * t));
+                pose.orientation.w = 1.0;
+            }
+
+            auto & wrench = robot.wrenches.wrenches_stamped[i];
+            wrench.header.stamp = now;
+            wrench.wrench.force.x = 10.0 * stance * std::cos(gait);
+            wrench.wrench.force.y = 10.0 * stance * std::sin(gait);
+            wrench.wrench.force.z = 100.0 * stance;
+
+            auto & cone = robot.cones.friction_cones[i];
+            cone.header.stamp = now;
+            cone.normal_direction.z = 1.0;
+        }
+
+        injectNan(robot);
+    }
+
+    void injectNan(Robot & robot)
+    {
+        if (nan_probability_ <= 0.0 || contacts_ == 0 ||
+            std::uniform_real_distribution<double>(0.0, 1.0)(random_engine_) >= nan_probability_)
+        {
+            return;
+        }
+
+        // A value of one of the three messages, restored at the next tick by updateRobot.
+        constexpr double kNan = std::numeric_limits<double>::quiet_NaN();
+        auto contact = std::uniform_int_distribution<size_t>(0, contacts_ - 1)(random_engine_);
+        switch (std::uniform_int_distribution<int>(PATHS, CONES)(random_engine_)) {
+            case PATHS:
+                robot.paths.paths[contact].poses[path_length_ - 1].pose.position.z = kNan;
+                break;
+            case WRENCHES:
+                robot.wrenches.wrenches_stamped[contact].wrench.force.z = kNan;
+                break;
+            case CONES:
+                robot.cones.friction_cones[contact].normal_direction.z = kNan;
+                break;
+        }
+        nan_messages_++;
+    }
+
+    void logStamp(size_t robot, Topic topic, const rclcpp::Time & stamp)
+    {
+        if (!stamp_log_) {
+            return;
+        }
+        static constexpr const char * kTopicNames[] = {"paths", "contact_wrenches", "friction_cones"};
+        auto publish_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::fprintf(
+            stamp_log_, "%s,%s,%zu,%lld,%lld\n", robots_[robot].name.c_str(), kTopicNames[topic],
+            tick_, static_cast<long long>(stamp.nanoseconds()), static_cast<long long>(publish_time));
+    }
+
+    std::string world_frame_;
+    size_t contacts_;
+    size_t path_length_;
+    double nan_probability_;
+    std::mt19937 random_engine_;
+
+    std::vector<Robot> robots_;
+    // Transforms of all the robots, sent in a single TFMessage.
+    std::vector<geometry_msgs::msg::TransformStamped> transforms_;
+    size_t tick_ = 0;
+    size_t nan_messages_ = 0;
+
+    std::FILE * stamp_log_ = nullptr;
+
+    std::unique_ptr<tf2_ros::TransformBroadcaster> tf_broadcaster_;
+    rclcpp::TimerBase::SharedPtr timer_;
+};
+
+}  // namespace rviz_legged_plugins::nodes
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rviz_legged_plugins::nodes::SyntheticLeggedPublisher)
@@ -0,0 +1,128 @@
+#include "rviz_legged_plugins/panels/timeline_panel.hpp"
+
+#include <algorithm>
+
+#include <QCheckBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QSlider>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "rviz_legged_plugins/common/timeline.hpp"
+
+namespace rviz_legged_plugins::panels
+{
+
+TimelinePanel::TimelinePanel(QWidget * parent)
+: rviz_common::Panel(parent)
+{
+    slider_ = new QSlider(Qt::Horizontal);
+    slider_->setRange(0, kSliderSteps);
+    slider_->setValue(kSliderSteps);
+
+    live_check_box_ = new QCheckBox("Live");
+    live_check_box_->setChecked(true);
+
+    time_label_ = new QLabel();
+    memory_label_ = new QLabel();
+
+    auto * status_layout = new QHBoxLayout();
+    status_layout->addWidget(live_check_box_);
+    status_layout->addWidget(time_label_);
+    status_layout->addStretch();
+    status_layout->addWidget(memory_label_);
+
+    auto * layout = new QVBoxLayout();
+    layout->addWidget(slider_);
+    layout->addLayout(status_layout);
+    setLayout(layout);
+
+    connect(slider_, &QSlider::valueChanged, this, &TimelinePanel::scrub);
+    connect(live_check_box_, &QCheckBox::toggled, this, &TimelinePanel::setLive);
+
+    // The displays record at the rate of their messages; the panel follows at a lower rate.
+    refresh_timer_ = new QTimer(this);
+    connect(refresh_timer_, &QTimer::timeout, this, &TimelinePanel::refresh);
+    refresh_timer_->start(100);
+    refresh();
+}
+
+TimelinePanel::~TimelinePanel()
+{
+    common::Timeline::instance().goLive();
+}
+
+void TimelinePanel::scrub(int position)
+{
+    int64_t oldest_ns;
+    int64_t newest_ns;
+    if (!common::Timeline::instance().recordedRange(oldest_ns, newest_ns)) {
+        return;
+    }
+
+    auto stamp_ns = oldest_ns + (newest_ns - oldest_ns) * position / kSliderSteps;
+    common::Timeline::instance().scrubTo(stamp_ns);
+    live_check_box_->blockSignals(true);
+    live_check_box_->setChecked(false);
+    live_check_box_->blockSignals(false);
+    refresh();
+}
+
+void TimelinePanel::setLive(bool live)
+{
+    auto & timeline = common::Timeline::instance();
+    int64_t oldest_ns;
+    int64_t newest_ns;
+    if (live) {
+        timeline.goLive();
+    } else if (timeline.recordedRange(oldest_ns, newest_ns)) {
+        // Freeze on the newest recorded instant.
+        timeline.scrubTo(newest_ns);
+    }
+    refresh();
+}
+
+void TimelinePanel::refresh()
+{
+    const auto & timeline = common::Timeline::instance();
+    auto spilled_bytes = timeline.spilledBytes();
+    memory_label_->setText(
+        QString("%1 MiB").arg(static_cast<double>(timeline.memoryUsage()) / (1 << 20), 0, 'f', 1) +
+        (spilled_bytes > 0 ?
+        QString(", %1 MiB spilled").arg(static_cast<double>(spilled_bytes) / (1 << 20), 0, 'f', 1) :
+        QString()));
+
+    int64_t oldest_ns;
+    int64_t newest_ns;
+    bool recorded = timeline.recordedRange(oldest_ns, newest_ns);
+    slider_->setEnabled(recorded);
+    if (!recorded) {
+        time_label_->setText("No recorded message");
+        return;
+    }
+
+    // The slider is moved without scrubbing, the range shifting as messages are recorded.
+    int position = kSliderSteps;
+    if (timeline.isScrubbing() && newest_ns > oldest_ns) {
+        auto offset_ns = std::clamp(timeline.scrubTime(), oldest_ns, newest_ns) - oldest_ns;
+        position = static_cast<int>(offset_ns * kSliderSteps / (newest_ns - oldest_ns));
+    }
+    slider_->blockSignals(true);
+    slider_->setValue(position);
+    slider_->blockSignals(false);
+
+    live_check_box_->blockSignals(true);
+    live_check_box_->setChecked(!timeline.isScrubbing());
+    live_check_box_->blockSignals(false);
+
+    time_label_->setText(
+        timeline.isScrubbing() ?
+        QString("%1 s").arg(1e-9 * static_cast<double>(timeline.scrubTime() - newest_ns), 0, 'f', 2) :
+        QString("%1 s recorded").arg(1e-9 * static_cast<double>(newest_ns - oldest_ns), 0, 'f', 1));
+}
+
+}  // namespace rviz_legged_plugins::panels
+
+#include <pluginlib/class_list_macros.hpp>  // NOLINT
+PLUGINLIB_EXPORT_CLASS(rviz_legged_plugins::panels::TimelinePanel, rviz_common::Panel)
@@ -0,0 +1,469 @@
+/*
+ * Deterministic replay of a rosbag2 recording through the CPU stages of the legged displays.
+ *
+ * The messages of the Paths, WrenchesStamped, WrenchesPacked, FrictionCones and FrictionConesPacked
+ * topics are deserialized, validated and converted by the stages of common/message_stages.hpp, as
+ * in the displays, resolved against the TF recorded in the same bag and converted into the geometry
+ * the displays would upload to the scene graph. No render window is created, hence no GPU is
+ * required.
+ *
+ * Usage:
+ *   ros2 run rviz_legged_plugins legged_bag_replay <bag> [--rate N] [--fps F] [--fixed-frame FRAME]
+ *       [--cone-height H]
+ *
+ * --rate N            replay at N times real time (default: 0, as fast as possible)
+ * --fps F             frame rate used to group the messages into render frames (default: 60)
+ * --fixed-frame FRAME fixed frame of the transforms (default: the root of the recorded TF tree)
+ * --cone-height H     height of the friction cones, as the "Height" of the display (default: 0.2)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <OgreMatrix4.h>
+#include <OgreQuaternion.h>
+#include <OgreVector3.h>
+
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rosbag2_cpp/reader.hpp"
+#include "tf2/buffer_core.h"
+#include "tf2/exceptions.h"
+#include "tf2_msgs/msg/tf_message.hpp"
+
+#include "rviz_legged_msgs/msg/friction_cones.hpp"
+#include "rviz_legged_msgs/msg/friction_cones_packed.hpp"
+#include "rviz_legged_msgs/msg/paths.hpp"
+#include "rviz_legged_msgs/msg/wrenches_packed.hpp"
+#include "rviz_legged_msgs/msg/wrenches_stamped.hpp"
+
+#include "rviz_legged_plugins/common/contact_geometry.hpp"
+#include "rviz_legged_plugins/common/message_stages.hpp"
+
+namespace rviz_legged_plugins::tools
+{
+
+struct ReplayOptions
+{
+    std::string bag_uri;
+    double rate = 0.0;
+    double fps = 60.0;
+    std::string fixed_frame;
+    float cone_height = 0.2f;
+};
+
+class BagReplayHarness
+{
+public:
+    explicit BagReplayHarness(const ReplayOptions & options)
+    : options_(options),
+      fixed_frame_(options.fixed_frame)
+    {}
+
+    void run()
+    {
+        rosbag2_cpp::Reader reader;
+        reader.open(options_.bag_uri);
+
+        for (const auto & topic : reader.get_all_topics_and_types()) {
+            topic_types_[topic.name] = topic.type;
+        }
+
+        const int64_t frame_period_ns = static_cast<int64_t>(1e9 / options_.fps);
+        int64_t bag_start_ns = -1;
+        int64_t frame_end_ns = 0;
+        auto wall_start = Clock::now();
+
+        while (reader.has_next()) {
+            auto bag_message = reader.read_next();
+            const int64_t stamp_ns = bag_message->time_stamp;
+
+            if (bag_start_ns < 0) {
+                bag_start_ns = stamp_ns;
+                frame_end_ns = stamp_ns + frame_period_ns;
+                wall_start = Clock::now();
+            }
+
+            // Close all the frames that ended before this message.
+            while (stamp_ns >= frame_end_ns) {
+                closeFrame();
+                frame_end_ns += frame_period_ns;
+            }
+
+            if (options_.rate > 0.0) {
+                auto target = wall_start + std::chrono::nanoseconds(
+                    static_cast<int64_t>(static_cast<double>(stamp_ns - bag_start_ns) / options_.rate));
+                std::this_thread::sleep_until(target);
+            }
+
+            // The copy into a SerializedMessage only serves the Serialization API: RViz receives
+            // the message already in one, hence it is not timed.
+            rclcpp::SerializedMessage serialized(*bag_message->serialized_data);
+            auto start = Clock::now();
+            handleMessage(bag_message->topic_name, serialized);
+            current_frame_ += Clock::now() - start;
+        }
+        closeFrame();
+
+        wall_duration_ = Clock::now() - wall_start;
+    }
+
+    void report() const
+    {
+        const double busy_s = std::chrono::duration<double>(busy_duration_).count();
+        const double wall_s = std::chrono::duration<double>(wall_duration_).count();
+        const size_t processed = wrenches_messages_ + cones_messages_ + paths_messages_;
+
+        std::printf("Replayed %s\n", options_.bag_uri.c_str());
+        std::printf(
+            "  Fixed frame:     %s\n", fixed_frame_.empty() ? "none (no transform)" : fixed_frame_.c_str());
+        std::printf("  Wrenches:        %zu messages\n", wrenches_messages_);
+        std::printf("  Friction cones:  %zu messages\n", cones_messages_);
+        std::printf("  Paths:           %zu messages\n", paths_messages_);
+        std::printf("  Dropped:         %zu invalid, %zu missing transform\n", invalid_, missing_transform_);
+        std::printf("  Wall time:       %.3f s\n", wall_s);
+        std::printf("  Processing time: %.3f s\n", busy_s);
+        if (busy_s > 0.0) {
+            std::printf("  Sustained rate:  %.0f messages/s\n", static_cast<double>(processed) / busy_s);
+        }
+        // Printed so that the geometry computations cannot be optimized away.
+        std::printf("  Checksum:        %g\n", sink_);
+
+        if (frame_times_ms_.empty()) {
+            return;
+        }
+
+        auto sorted = frame_times_ms_;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))];
+        };
+        const double budget_ms = 1e3 / options_.fps;
+        const auto over_budget = static_cast<size_t>(
+            sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), budget_ms));
+
+        std::printf("  Frames:          %zu at %.0f fps\n", sorted.size(), options_.fps);
+        std::printf(
+            "  Frame time [ms]: p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+            percentile(0.5), percentile(0.9), percentile(0.99), sorted.back());
+        std::printf("  Over budget:     %zu frames (> %.2f ms)\n", over_budget, budget_ms);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void closeFrame()
+    {
+        // Frames without messages do not cost anything to the displays.
+        if (current_frame_ == Clock::duration::zero()) {
+            return;
+        }
+
+        frame_times_ms_.push_back(std::chrono::duration<double, std::milli>(current_frame_).count());
+        busy_duration_ += current_frame_;
+        current_frame_ = Clock::duration::zero();
+    }
+
+    void handleMessage(const std::string & topic, const rclcpp::SerializedMessage & serialized)
+    {
+        auto it = topic_types_.find(topic);
+        if (it == topic_types_.end()) {
+            return;
+        }
+        const auto & type = it->second;
+
+        if (type == "tf2_msgs/msg/TFMessage") {
+            tf2_msgs::msg::TFMessage msg;
+            tf_serialization_.deserialize_message(&serialized, &msg);
+            for (const auto & transform : msg.transforms) {
+                tf_buffer_.setTransform(transform, "bag", topic == "/tf_static");
+                parents_[transform.child_frame_id] = transform.header.frame_id;
+            }
+        } else if (type == "rviz_legged_msgs/msg/WrenchesStamped") {
+            rviz_legged_msgs::msg::WrenchesStamped msg;
+            wrenches_serialization_.deserialize_message(&serialized, &msg);
+            processWrenches(msg);
+        } else if (type == "rviz_legged_msgs/msg/WrenchesPacked") {
+            rviz_legged_msgs::msg::WrenchesPacked msg;
+            packed_wrenches_serialization_.deserialize_message(&serialized, &msg);
+            processPackedWrenches(msg);
+        } else if (type == "rviz_legged_msgs/msg/FrictionCones") {
+            rviz_legged_msgs::msg::FrictionCones msg;
+            cones_serialization_.deserialize_message(&serialized, &msg);
+            processCones(msg);
+        } else if (type == "rviz_legged_msgs/msg/FrictionConesPacked") {
+            rviz_legged_msgs::msg::FrictionConesPacked msg;
+            packed_cones_serialization_.deserialize_message(&serialized, &msg);
+            processPackedCones(msg);
+        } else if (type == "rviz_legged_msgs/msg/Paths") {
+            rviz_legged_msgs::msg::Paths msg;
+            paths_serialization_.deserialize_message(&serialized, &msg);
+            processPaths(msg);
+        }
+    }
+
+    void processWrenches(const rviz_legged_msgs::msg::WrenchesStamped & msg)
+    {
+        wrenches_messages_++;
+
+        if (common::readWrenches(msg, false, wrench_samples_) != common::MessageError::NONE) {
+            invalid_++;
+            return;
+        }
+
+        for (size_t i = 0; i < wrench_samples_.size(); i++) {
+            Ogre::Matrix4 transform;
+            if (!lookupTransform(msg.wrenches_stamped[i].header, transform)) {
+                missing_transform_++;
+                return;
+            }
+            sink_ += (transform * wrench_samples_[i].force).squaredLength();
+        }
+    }
+
+    void processPackedWrenches(const rviz_legged_msgs::msg::WrenchesPacked & msg)
+    {
+        wrenches_messages_++;
+
+        if (common::readPackedWrenches(msg, false, wrench_samples_) != common::MessageError::NONE) {
+            invalid_++;
+            return;
+        }
+        if (!lookupFrameTable(msg.header.stamp, msg.frame_ids)) {
+            missing_transform_++;
+            return;
+        }
+
+        for (size_t i = 0; i < wrench_samples_.size(); i++) {
+            sink_ += (frame_transforms_[msg.frame_indices[i]] * wrench_samples_[i].force).squaredLength();
+        }
+    }
+
+    void processCones(const rviz_legged_msgs::msg::FrictionCones & msg)
+    {
+        cones_messages_++;
+
+        if (common::validateCones(msg) != common::MessageError::NONE) {
+            invalid_++;
+            return;
+        }
+
+        cone_positions_.clear();
+        for (const auto & cone : msg.friction_cones) {
+            Ogre::Matrix4 transform;
+            if (!lookupTransform(cone.header, transform)) {
+                missing_transform_++;
+                return;
+            }
+            cone_positions_.push_back(transform.getTrans());
+        }
+
+        common::readCones(msg, cone_normals_, cone_friction_coefficients_);
+        computeCones();
+    }
+
+    void processPackedCones(const rviz_legged_msgs::msg::FrictionConesPacked & msg)
+    {
+        cones_messages_++;
+
+        if (common::validatePackedCones(msg) != common::MessageError::NONE) {
+            invalid_++;
+            return;
+        }
+        if (!lookupFrameTable(msg.header.stamp, msg.frame_ids)) {
+            missing_transform_++;
+            return;
+        }
+
+        cone_positions_.clear();
+        for (auto frame_index : msg.frame_indices) {
+            cone_positions_.push_back(frame_transforms_[frame_index].getTrans());
+        }
+
+        common::readPackedCones(msg, cone_normals_, cone_friction_coefficients_);
+        computeCones();
+    }
+
+    /** Compute the placement of the cones read in the scratch buffers, as the display does. */
+    void computeCones()
+    {
+        for (size_t i = 0; i < cone_positions_.size(); i++) {
+            auto geometry = common::computeConeGeometry(
+                cone_normals_[i], cone_friction_coefficients_[i], options_.cone_height);
+            sink_ += (cone_positions_[i] + geometry.offset).squaredLength();
+        }
+    }
+
+    void processPaths(const rviz_legged_msgs::msg::Paths & msg)
+    {
+        paths_messages_++;
+
+        if (common::validatePaths(msg) != common::MessageError::NONE) {
+            invalid_++;
+            return;
+        }
+
+        Ogre::Matrix4 transform;
+        if (!lookupTransform(msg.header, transform)) {
+            missing_transform_++;
+            return;
+        }
+
+        for (const auto & path : msg.paths) {
+            common::transformPathPositions(path, transform, path_positions_);
+            sink_ += static_cast<double>(path_positions_.size());
+        }
+    }
+
+    /**
+     * Fixed frame of the lookups: the one of the options or, by default, the root of the recorded
+     * TF tree, found from the first frame of a message with a recorded parent.
+     */
+    const std::string & fixedFrame(const std::string & frame_id)
+    {
+        if (fixed_frame_.empty()) {
+            std::string frame = frame_id;
+            // The latest parents, whatever the stamp of the message. A cycle stops after visiting
+            // every recorded frame.
+            for (size_t i = 0; i < parents_.size(); i++) {
+                auto parent = parents_.find(frame);
+                if (parent == parents_.end() || parent->second == frame) {
+                    break;
+                }
+                frame = parent->second;
+            }
+            if (frame != frame_id) {
+                fixed_frame_ = frame;
+            } else {
+                return frame_id;
+            }
+        }
+        return fixed_frame_;
+    }
+
+    /** Look up every frame of the table of a packed message once, at the stamp of the message. */
+    bool lookupFrameTable(
+        const builtin_interfaces::msg::Time & stamp, const std::vector<std::string> & frame_ids)
+    {
+        frame_transforms_.resize(frame_ids.size());
+        std_msgs::msg::Header header;
+        header.stamp = stamp;
+        for (size_t j = 0; j < frame_ids.size(); j++) {
+            header.frame_id = frame_ids[j];
+            if (!lookupTransform(header, frame_transforms_[j])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool lookupTransform(const std_msgs::msg::Header & header, Ogre::Matrix4 & transform)
+    {
+        const auto & fixed_frame = fixedFrame(header.frame_id);
+        if (fixed_frame == header.frame_id) {
+            transform = Ogre::Matrix4::IDENTITY;
+            return true;
+        }
+
+        tf2::TimePoint time(
+            std::chrono::seconds(header.stamp.sec) + std::chrono::nanoseconds(header.stamp.nanosec));
+
+        try {
+            auto transform_msg = tf_buffer_.lookupTransform(fixed_frame, header.frame_id, time);
+            const auto & t = transform_msg.transform.translation;
+            const auto & q = transform_msg.transform.rotation;
+            transform = Ogre::Matrix4(Ogre::Quaternion(
+                static_cast<float>(q.w), static_cast<float>(q.x),
+                static_cast<float>(q.y), static_cast<float>(q.z)));
+            transform.setTrans(Ogre::Vector3(
+                static_cast<float>(t.x), static_cast<float>(t.y), static_cast<float>(t.z)));
+        } catch (const tf2::TransformException &) {
+            return false;
+        }
+        return true;
+    }
+
+    ReplayOptions options_;
+    // Frame the geometry is expressed in, empty until the TF tree is known.
+    std::string fixed_frame_;
+
+    std::unordered_map<std::string, std::string> topic_types_;
+
+    rclcpp::Serialization<tf2_msgs::msg::TFMessage> tf_serialization_;
+    rclcpp::Serialization<rviz_legged_msgs::msg::WrenchesStamped> wrenches_serialization_;
+    rclcpp::Serialization<rviz_legged_msgs::msg::WrenchesPacked> packed_wrenches_serialization_;
+    rclcpp::Serialization<rviz_legged_msgs::msg::FrictionCones> cones_serialization_;
+    rclcpp::Serialization<rviz_legged_msgs::msg::FrictionConesPacked> packed_cones_serialization_;
+    rclcpp::Serialization<rviz_legged_msgs::msg::Paths> paths_serialization_;
+
+    tf2::BufferCore tf_buffer_;
+    // Latest recorded parent of every frame, from which the default fixed frame is found.
+    std::unordered_map<std::string, std::string> parents_;
+
+    // Scratch buffers of the stages, reused across messages as in the displays.
+    std::vector<common::WrenchSample> wrench_samples_;
+    std::vector<Ogre::Vector3> cone_positions_;
+    std::vector<Ogre::Vector3> cone_normals_;
+    std::vector<float> cone_friction_coefficients_;
+    std::vector<Ogre::Vector3> path_positions_;
+    std::vector<Ogre::Matrix4> frame_transforms_;
+
+    size_t wrenches_messages_ = 0;
+    size_t cones_messages_ = 0;
+    size_t paths_messages_ = 0;
+    size_t invalid_ = 0;
+    size_t missing_transform_ = 0;
+
+    // Accumulates the results, reported, so that the computations cannot be optimized away.
+    double sink_ = 0.0;
+
+    Clock::duration current_frame_ = Clock::duration::zero();
+    Clock::duration busy_duration_ = Clock::duration::zero();
+    Clock::duration wall_duration_ = Clock::duration::zero();
+    std::vector<double> frame_times_ms_;
+};
+
+}  // namespace rviz_legged_plugins::tools
+
+int main(int argc, char ** argv)
+{
+    rviz_legged_plugins::tools::ReplayOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rate" && i + 1 < argc) {
+            options.rate = std::atof(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            options.fps = std::atof(argv[++i]);
+        } else if (arg == "--fixed-frame" && i + 1 < argc) {
+            options.fixed_frame = argv[++i];
+        } else if (arg == "--cone-height" && i + 1 < argc) {
+            options.cone_height = static_cast<float>(std::atof(argv[++i]));
+        } else if (options.bag_uri.empty() && arg.rfind("--", 0) != 0) {
+            options.bag_uri = arg;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (options.bag_uri.empty() || options.fps <= 0.0 || options.rate < 0.0) {
+        std::fprintf(
+            stderr,
+            "Usage: %s <bag> [--rate N] [--fps F] [--fixed-frame FRAME] [--cone-height H]\n",
+            argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    rviz_legged_plugins::tools::BagReplayHarness harness(options);
+    harness.run();
+    harness.report();
+
+    return EXIT_SUCCESS;
+}
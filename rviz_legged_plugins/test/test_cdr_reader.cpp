@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rviz_legged_plugins/common/cdr_reader.hpp"
+
+using rviz_legged_plugins::common::CdrReader;
+
+namespace
+{
+
+/** Serializes values after an encapsulation header, aligned as the CdrReader expects. */
+class CdrWriter
+{
+public:
+    CdrWriter(uint8_t identifier, bool big_endian, size_t max_alignment)
+    : big_endian_(big_endian),
+      max_alignment_(max_alignment),
+      buffer_{0, identifier, 0, 0} {}
+
+    template<typename T>
+    CdrWriter & write(T value)
+    {
+        size_t alignment = std::min(sizeof(T), max_alignment_);
+        while ((buffer_.size() - 4) % alignment != 0) {
+            buffer_.push_back(0);
+        }
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        uint16_t probe = 1;
+        bool host_big_endian = *reinterpret_cast<uint8_t *>(&probe) == 0;
+        if (host_big_endian != big_endian_) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+        return *this;
+    }
+
+    CdrWriter & writeString(const std::string & value)
+    {
+        write(static_cast<uint32_t>(value.size() + 1));
+        buffer_.insert(buffer_.end(), value.begin(), value.end());
+        buffer_.push_back(0);
+        return *this;
+    }
+
+    const std::vector<uint8_t> & buffer() const {return buffer_;}
+
+private:
+    bool big_endian_;
+    size_t max_alignment_;
+    std::vector<uint8_t> buffer_;
+};
+
+std::vector<uint8_t> serializeSample(uint8_t identifier, bool big_endian, size_t max_alignment)
+{
+    return CdrWriter(identifier, big_endian, max_alignment)
+           .write<int32_t>(-7).write<double>(1.5).writeString("odom").write<uint32_t>(42)
+           .buffer();
+}
+
+void expectSample(const std::vector<uint8_t> & buffer)
+{
+    CdrReader reader(buffer.data(), buffer.size());
+    int32_t integer;
+    double real;
+    std::string_view text;
+    uint32_t natural;
+    ASSERT_TRUE(reader.read(integer));
+    ASSERT_TRUE(reader.read(real));
+    ASSERT_TRUE(reader.read(text));
+    ASSERT_TRUE(reader.read(natural));
+    EXPECT_EQ(integer, -7);
+    EXPECT_EQ(real, 1.5);
+    EXPECT_EQ(text, "odom");
+    EXPECT_EQ(natural, 42u);
+    EXPECT_TRUE(reader.ok());
+}
+
+}  // namespace
+
+TEST(CdrReader, readsLittleEndianCdr)
+{
+    expectSample(serializeSample(0x01, false, 8));
+}
+
+TEST(CdrReader, readsBigEndianCdr)
+{
+    expectSample(serializeSample(0x00, true, 8));
+}
+
+TEST(CdrReader, readsXcdr2WithFourByteAlignment)
+{
+    auto buffer = serializeSample(0x07, false, 4);
+    // The double follows the int32 without padding.
+    EXPECT_EQ(buffer.size(), serializeSample(0x01, false, 8).size() - 4);
+    expectSample(buffer);
+    expectSample(serializeSample(0x06, true, 4));
+}
+
+TEST(CdrReader, rejectsOtherEncapsulations)
+{
+    // PL_CDR, D_CDR2 and PL_CDR2, in both byte orders.
+    for (uint8_t identifier : {0x02, 0x03, 0x08, 0x09, 0x0a, 0x0b}) {
+        auto buffer = serializeSample(identifier, (identifier & 1) == 0, 8);
+        CdrReader reader(buffer.data(), buffer.size());
+        int32_t value;
+        EXPECT_FALSE(reader.ok()) << "identifier " << int(identifier);
+        EXPECT_FALSE(reader.read(value));
+    }
+    // An identifier outside the standard ones.
+    auto buffer = serializeSample(0x01, false, 8);
+    buffer[0] = 0x01;
+    EXPECT_FALSE(CdrReader(buffer.data(), buffer.size()).ok());
+}
+
+TEST(CdrReader, rejectsTruncatedBuffers)
+{
+    EXPECT_FALSE(CdrReader(nullptr, 0).ok());
+    auto buffer = serializeSample(0x01, false, 8);
+    EXPECT_FALSE(CdrReader(buffer.data(), 3).ok());
+
+    // Cut inside the double, after its padding.
+    CdrReader reader(buffer.data(), 12);
+    int32_t integer;
+    double real;
+    EXPECT_TRUE(reader.read(integer));
+    EXPECT_FALSE(reader.read(real));
+    // A failed reader fails every later read, even one that would fit.
+    uint32_t natural;
+    EXPECT_FALSE(reader.read(natural));
+    EXPECT_FALSE(reader.ok());
+
+    // Cut inside the characters of the string.
+    std::string_view text;
+    CdrReader string_reader(buffer.data(), buffer.size() - 8);
+    EXPECT_TRUE(string_reader.read(integer));
+    EXPECT_TRUE(string_reader.read(real));
+    EXPECT_FALSE(string_reader.read(text));
+}
+
+TEST(CdrReader, rejectsOversizedLengths)
+{
+    auto buffer = CdrWriter(0x01, false, 8).write<uint32_t>(0xffffffff).write<double>(0.0).buffer();
+    uint32_t length;
+    CdrReader reader(buffer.data(), buffer.size());
+    EXPECT_FALSE(reader.readSequenceLength(length, 24));
+    EXPECT_FALSE(reader.ok());
+
+    // A sequence of one 8-byte element fits, one of two does not.
+    auto one = CdrWriter(0x01, false, 8).write<uint32_t>(1).write<double>(0.0).buffer();
+    CdrReader one_reader(one.data(), one.size());
+    EXPECT_TRUE(one_reader.readSequenceLength(length, 8));
+    auto two = CdrWriter(0x01, false, 8).write<uint32_t>(2).write<double>(0.0).buffer();
+    CdrReader two_reader(two.data(), two.size());
+    EXPECT_FALSE(two_reader.readSequenceLength(length, 8));
+
+    auto string = CdrWriter(0x01, false, 8).write<uint32_t>(1000).buffer();
+    std::string_view text;
+    CdrReader string_reader(string.data(), string.size());
+    EXPECT_FALSE(string_reader.read(text));
+}
@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <OgreVector3.h>
+
+#include "rviz_legged_plugins/common/contact_hull.hpp"
+
+using rviz_legged_plugins::common::ContactHull;
+
+namespace
+{
+
+/** Contacts of a ContactHull update, identified by their id. */
+struct Contacts
+{
+    std::vector<std::string> ids;
+    std::vector<Ogre::Vector3> positions;
+
+    void set(const std::string & id, const Ogre::Vector3 & position)
+    {
+        auto it = std::find(ids.begin(), ids.end(), id);
+        if (it == ids.end()) {
+            ids.push_back(id);
+            positions.push_back(position);
+        } else {
+            positions[static_cast<size_t>(it - ids.begin())] = position;
+        }
+    }
+
+    void remove(const std::string & id)
+    {
+        auto it = std::find(ids.begin(), ids.end(), id);
+        ASSERT_NE(it, ids.end());
+        positions.erase(positions.begin() + (it - ids.begin()));
+        ids.erase(it);
+    }
+};
+
+/** Vertices of a hull, starting from the one of lowest x, then lowest y, to compare cycles. */
+std::vector<Ogre::Vector3> normalizedCycle(std::vector<Ogre::Vector3> vertices)
+{
+    auto first = std::min_element(
+        vertices.begin(), vertices.end(),
+        [](const Ogre::Vector3 & a, const Ogre::Vector3 & b) {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        });
+    std::rotate(vertices.begin(), first, vertices.end());
+    return vertices;
+}
+
+/** Expect the incremental hull to have the vertices of a hull built from scratch. */
+void expectSameAsRebuild(const ContactHull & hull, const Contacts & contacts)
+{
+    // A new hull builds its vertices from all the contacts at once.
+    ContactHull reference;
+    reference.setContacts(contacts.ids, contacts.positions);
+
+    auto actual = normalizedCycle(hull.vertices());
+    auto expected = normalizedCycle(reference.vertices());
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+        EXPECT_EQ(actual[i], expected[i]) << "vertex " << i;
+    }
+}
+
+bool contains(const std::vector<Ogre::Vector3> & vertices, const Ogre::Vector3 & point)
+{
+    return std::find(vertices.begin(), vertices.end(), point) != vertices.end();
+}
+
+Contacts square()
+{
+    Contacts contacts;
+    contacts.set("lf", Ogre::Vector3(1.0f, 1.0f, 0.0f));
+    contacts.set("rf", Ogre::Vector3(1.0f, -1.0f, 0.0f));
+    contacts.set("rh", Ogre::Vector3(-1.0f, -1.0f, 0.0f));
+    contacts.set("lh", Ogre::Vector3(-1.0f, 1.0f, 0.0f));
+    return contacts;
+}
+
+}  // namespace
+
+TEST(ContactHull, BuildsCounterclockwiseHull)
+{
+    ContactHull hull;
+    auto contacts = square();
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+
+    const auto & vertices = hull.vertices();
+    ASSERT_EQ(vertices.size(), 4u);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto & o = vertices[i];
+        const auto & a = vertices[(i + 1) % vertices.size()];
+        const auto & b = vertices[(i + 2) % vertices.size()];
+        EXPECT_GT((a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x), 0.0f);
+    }
+}
+
+TEST(ContactHull, TouchdownInsideLeavesHull)
+{
+    ContactHull hull;
+    auto contacts = square();
+    hull.setContacts(contacts.ids, contacts.positions);
+    auto before = hull.vertices();
+
+    contacts.set("arm", Ogre::Vector3(0.2f, 0.3f, 0.5f));
+    EXPECT_FALSE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices(), before);
+    expectSameAsRebuild(hull, contacts);
+}
+
+TEST(ContactHull, TouchdownOutsideExtendsHull)
+{
+    ContactHull hull;
+    auto contacts = square();
+    hull.setContacts(contacts.ids, contacts.positions);
+
+    // Visible from two edges, the new contact replaces the vertex between them.
+    Ogre::Vector3 outside(3.0f, 3.0f, 0.0f);
+    contacts.set("arm", outside);
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_TRUE(contains(hull.vertices(), outside));
+    EXPECT_FALSE(contains(hull.vertices(), Ogre::Vector3(1.0f, 1.0f, 0.0f)));
+    expectSameAsRebuild(hull, contacts);
+}
+
+TEST(ContactHull, InnerContactMovingOutsideExtendsHull)
+{
+    ContactHull hull;
+    auto contacts = square();
+    contacts.set("arm", Ogre::Vector3::ZERO);
+    hull.setContacts(contacts.ids, contacts.positions);
+
+    contacts.set("arm", Ogre::Vector3(0.0f, -2.0f, 0.0f));
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    ASSERT_EQ(hull.vertices().size(), 5u);
+    expectSameAsRebuild(hull, contacts);
+}
+
+TEST(ContactHull, LiftOffOfHullVertexRebuildsHull)
+{
+    ContactHull hull;
+    auto contacts = square();
+    contacts.set("arm", Ogre::Vector3(0.5f, 0.0f, 0.0f));
+    hull.setContacts(contacts.ids, contacts.positions);
+
+    // The inner contact the lifted vertex hid becomes a vertex.
+    contacts.remove("lf");
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices().size(), 4u);
+    EXPECT_FALSE(contains(hull.vertices(), Ogre::Vector3(1.0f, 1.0f, 0.0f)));
+    EXPECT_TRUE(contains(hull.vertices(), Ogre::Vector3(0.5f, 0.0f, 0.0f)));
+    expectSameAsRebuild(hull, contacts);
+}
+
+TEST(ContactHull, LiftOffOfInnerContactLeavesHull)
+{
+    ContactHull hull;
+    auto contacts = square();
+    contacts.set("arm", Ogre::Vector3(0.5f, 0.0f, 0.0f));
+    hull.setContacts(contacts.ids, contacts.positions);
+    auto before = hull.vertices();
+
+    contacts.remove("arm");
+    EXPECT_FALSE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices(), before);
+}
+
+TEST(ContactHull, MotionBelowToleranceIsIgnored)
+{
+    ContactHull hull;
+    hull.setTolerance(0.01f);
+    auto contacts = square();
+    hull.setContacts(contacts.ids, contacts.positions);
+    auto before = hull.vertices();
+
+    contacts.set("lf", Ogre::Vector3(1.005f, 1.0f, 0.0f));
+    EXPECT_FALSE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices(), before);
+}
+
+TEST(ContactHull, CollinearContactsKeepEndpoints)
+{
+    ContactHull hull;
+    Contacts contacts;
+    contacts.set("lf", Ogre::Vector3(0.0f, 0.0f, 0.0f));
+    contacts.set("rf", Ogre::Vector3(1.0f, 0.0f, 0.0f));
+    contacts.set("lh", Ogre::Vector3(2.0f, 0.0f, 0.0f));
+    hull.setContacts(contacts.ids, contacts.positions);
+
+    ASSERT_EQ(hull.vertices().size(), 2u);
+    EXPECT_TRUE(contains(hull.vertices(), Ogre::Vector3(0.0f, 0.0f, 0.0f)));
+    EXPECT_TRUE(contains(hull.vertices(), Ogre::Vector3(2.0f, 0.0f, 0.0f)));
+
+    // A contact off the line turns the segment into a triangle.
+    contacts.set("rh", Ogre::Vector3(1.0f, 1.0f, 0.0f));
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices().size(), 3u);
+    expectSameAsRebuild(hull, contacts);
+}
+
+TEST(ContactHull, DegenerateContactSets)
+{
+    ContactHull hull;
+    Contacts contacts;
+    EXPECT_FALSE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_TRUE(hull.vertices().empty());
+
+    contacts.set("lf", Ogre::Vector3(1.0f, 2.0f, 0.0f));
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices().size(), 1u);
+
+    contacts.set("rf", Ogre::Vector3(1.0f, 2.0f, 0.0f));
+    contacts.set("lh", Ogre::Vector3(3.0f, 2.0f, 0.0f));
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_EQ(hull.vertices().size(), 2u);
+    expectSameAsRebuild(hull, contacts);
+
+    contacts.remove("lf");
+    contacts.remove("rf");
+    contacts.remove("lh");
+    EXPECT_TRUE(hull.setContacts(contacts.ids, contacts.positions));
+    EXPECT_TRUE(hull.vertices().empty());
+
+    contacts = square();
+    hull.setContacts(contacts.ids, contacts.positions);
+    hull.clear();
+    EXPECT_TRUE(hull.vertices().empty());
+}
+
+TEST(ContactHull, IncrementalUpdatesMatchRebuild)
+{
+    // Random gaits: each update touches down, lifts off or moves a few of the contacts.
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> action(0, 2);
+    const std::vector<std::string> ids = {"lf", "rf", "lh", "rh", "la", "ra", "lk", "rk"};
+
+    ContactHull hull;
+    Contacts contacts;
+    for (int update = 0; update < 500; update++) {
+        for (int change = 0; change < 2; change++) {
+            const auto & id = ids[static_cast<size_t>(generator() % ids.size())];
+            bool active = std::find(contacts.ids.begin(), contacts.ids.end(), id) != contacts.ids.end();
+            if (active && action(generator) == 0) {
+                contacts.remove(id);
+            } else {
+                contacts.set(id, Ogre::Vector3(coordinate(generator), coordinate(generator), 0.0f));
+            }
+        }
+        hull.setContacts(contacts.ids, contacts.positions);
+        SCOPED_TRACE("update " + std::to_string(update));
+        expectSameAsRebuild(hull, contacts);
+        if (HasFailure()) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "rviz_legged_plugins/common/timeline_store.hpp"
+
+using rviz_legged_plugins::common::TimelineStore;
+
+namespace
+{
+
+constexpr int64_t kMillisecond = 1000000;
+constexpr size_t kColumns = 2;
+
+/** Append a record of rows rows whose values are all value. */
+bool appendRecord(TimelineStore & store, int64_t stamp_ns, size_t rows, float value)
+{
+    float * values = store.append(stamp_ns, rows);
+    if (!values) {
+        return false;
+    }
+    for (size_t i = 0; i < rows * kColumns; i++) {
+        values[i] = value;
+    }
+    return true;
+}
+
+/** Expect the records of the store in stamp order, each holding the values it was appended with. */
+void expectConsistent(const TimelineStore & store)
+{
+    for (size_t index = 0; index < store.size(); index++) {
+        auto record = store.record(index);
+        ASSERT_NE(record.values, nullptr);
+        if (index > 0) {
+            EXPECT_GT(record.stamp_ns, store.record(index - 1).stamp_ns);
+        }
+        // The values of the records of the tests are their stamp in ms.
+        for (size_t i = 0; i < record.rows * kColumns; i++) {
+            ASSERT_EQ(record.values[i], static_cast<float>(record.stamp_ns / kMillisecond));
+        }
+    }
+}
+
+}  // namespace
+
+TEST(TimelineStore, seeksTheNewestRecordAtOrBeforeAStamp)
+{
+    TimelineStore store(kColumns);
+    store.setMemoryLimit(1 << 20);
+    for (int64_t ms = 10; ms <= 50; ms += 10) {
+        ASSERT_TRUE(appendRecord(store, ms * kMillisecond, 3, static_cast<float>(ms)));
+    }
+
+    EXPECT_FALSE(store.seek(5 * kMillisecond).has_value());
+    EXPECT_EQ(store.seek(10 * kMillisecond), 0u);
+    EXPECT_EQ(store.seek(35 * kMillisecond), 2u);
+    EXPECT_EQ(store.seek(90 * kMillisecond), 4u);
+    expectConsistent(store);
+}
+
+TEST(TimelineStore, dropsLateRecordsAndKeepsTheHistory)
+{
+    TimelineStore store(kColumns);
+    store.setMemoryLimit(1 << 20);
+    ASSERT_TRUE(appendRecord(store, 100 * kMillisecond, 2, 100.0f));
+    ASSERT_TRUE(appendRecord(store, 200 * kMillisecond, 2, 200.0f));
+
+    // A message of another topic, older than the newest record by less than a second.
+    EXPECT_EQ(store.append(150 * kMillisecond, 2), nullptr);
+    EXPECT_EQ(store.size(), 2u);
+    EXPECT_EQ(store.newestStamp(), 200 * kMillisecond);
+
+    // A record stamped as the newest is still in order.
+    EXPECT_TRUE(appendRecord(store, 300 * kMillisecond, 2, 300.0f));
+    EXPECT_EQ(store.size(), 3u);
+    expectConsistent(store);
+}
+
+TEST(TimelineStore, restartsAfterALargeBackwardJump)
+{
+    TimelineStore store(kColumns);
+    store.setMemoryLimit(1 << 20);
+    ASSERT_TRUE(appendRecord(store, 5000 * kMillisecond, 2, 5000.0f));
+    ASSERT_TRUE(appendRecord(store, 6000 * kMillisecond, 2, 6000.0f));
+
+    // The bag looped.
+    ASSERT_TRUE(appendRecord(store, 1000 * kMillisecond, 2, 1000.0f));
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.oldestStamp(), 1000 * kMillisecond);
+}
+
+TEST(TimelineStore, wrapsAroundTheRingDroppingTheOldestRecords)
+{
+    TimelineStore store(kColumns);
+    // A ring of 100 floats, holding a few records of up to 4 rows and their entries.
+    store.setMemoryLimit(100 * 2 * sizeof(float));
+
+    for (int64_t ms = 1; ms <= 200; ms++) {
+        size_t rows = 1 + static_cast<size_t>(ms % 4);
+        ASSERT_TRUE(appendRecord(store, ms * kMillisecond, rows, static_cast<float>(ms)));
+        ASSERT_GT(store.size(), 0u);
+        ASSERT_LT(store.size(), 10u);
+        EXPECT_EQ(store.newestStamp(), ms * kMillisecond);
+        expectConsistent(store);
+    }
+    EXPECT_LE(store.memoryUsage(), store.memoryLimit());
+
+    // A record larger than the ring is not recorded.
+    EXPECT_EQ(store.append(201 * kMillisecond, 100), nullptr);
+    EXPECT_EQ(store.newestStamp(), 200 * kMillisecond);
+}
+
+TEST(TimelineStore, spillsTheRecordsDroppedFromTheRing)
+{
+    char directory[] = "/tmp/test_timeline_store_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+
+    TimelineStore store(kColumns);
+    store.setMemoryLimit(100 * 2 * sizeof(float));
+    std::string error;
+    ASSERT_TRUE(store.openSpill(directory, error)) << error;
+
+    for (int64_t ms = 1; ms <= 200; ms++) {
+        ASSERT_TRUE(appendRecord(store, ms * kMillisecond, 2, static_cast<float>(ms)));
+    }
+    EXPECT_EQ(store.size(), 200u);
+    EXPECT_GT(store.spilledBytes(), 0u);
+    EXPECT_EQ(store.oldestStamp(), kMillisecond);
+    EXPECT_EQ(store.seek(50 * kMillisecond), 49u);
+    expectConsistent(store);
+
+    store.closeSpill();
+    rmdir(directory);
+}